@@ -28,6 +28,9 @@
 #define CONSOLEINFO
 #define CONSOLEINFO_LIBC
 
+// background writer thread (pthreads) for "async" logflushmode
+#define SYDEBUG_ASYNC_OUTPUT
+
 // Eval limit options
 // ==================
 
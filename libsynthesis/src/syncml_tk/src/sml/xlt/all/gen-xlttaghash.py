@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+#
+# Generates xlttaghash.h from the tag tables in xlttags.c:
+# - for each code page a 256 entry array which maps a WBXML tag byte
+#   to the position of the tag in the table (plus one, 0 = unknown)
+# - for each code page a perfect hash table for the XML tag names,
+#   again containing position plus one
+#
+# Must be run again after changing the tag tables. xlttags.c refuses
+# to compile when the number of tags differs; other changes do not
+# break decoding (lookups are verified against the tag table and fall
+# back to scanning it), they only make it slower.
+#
+# Usage: gen-xlttaghash.py [xlttags.c [xlttaghash.h]]
+
+import re
+import sys
+import os
+
+srcdir = os.path.dirname(os.path.abspath(sys.argv[0]))
+infile = len(sys.argv) > 1 and sys.argv[1] or os.path.join(srcdir, 'xlttags.c')
+outfile = len(sys.argv) > 2 and sys.argv[2] or os.path.join(srcdir, 'xlttaghash.h')
+
+# code page name in xlttags.c -> prefix of generated arrays, #ifdef
+codepages = [('syncml', 'SyncML', None),
+             ('metinf', 'MetInf', '__USE_METINF__'),
+             ('devinf', 'DevInf', '__USE_DEVINF__')]
+
+source = open(infile).read()
+tables = {}
+for name, prefix, ifdef in codepages:
+    match = re.search(r'static const Tag_t %s\[\]\s*=\s*\{(.*?)\n\s*\};' % name,
+                      source, re.S)
+    if not match:
+        sys.exit('%s: table %s not found' % (infile, name))
+    entries = re.findall(r'_TOKEN\((TN_\w+),\s*(0x[0-9A-Fa-f]+),\s*"([^"]*)"\)',
+                         match.group(1))
+    tables[name] = [(tag, int(byte, 16), xml) for tag, byte, xml in entries]
+
+def taghash(tag, mult, size):
+    '''must match XLT_TAG_HASH() in xlttags.c'''
+    length = len(tag)
+    h = length
+    for c in (tag[0], tag[length // 2], tag[length - 1]):
+        h = (h * mult + ord(c)) & 0xFFFFFFFF
+    return h % size
+
+def perfecthash(names):
+    '''find smallest table size and a multiplier without collisions'''
+    size = len(names) * 2
+    while True:
+        for mult in range(1, 1000):
+            slots = set([taghash(name, mult, size) for name in names])
+            if len(slots) == len(names):
+                return (size, mult)
+        size += 1
+
+out = open(outfile, 'w')
+out.write('''/*
+ * Generated by gen-xlttaghash.py from xlttags.c, do not edit.
+ *
+ * WBXML byte and XML name lookup tables for the tag tables in
+ * getTagTable(). Entries are the position of the tag in the table
+ * plus one, zero means "unknown tag".
+ */
+
+''')
+for name, prefix, ifdef in codepages:
+    table = tables[name]
+    if ifdef:
+        out.write('#ifdef %s\n' % ifdef)
+    out.write('#define XLT_%s_TAG_COUNT %d\n' % (prefix.upper(), len(table)))
+    # WBXML: first entry wins, like the linear search
+    bytes = [0] * 256
+    for index, (tag, byte, xml) in enumerate(table):
+        if not bytes[byte]:
+            bytes[byte] = index + 1
+    out.write('static const unsigned char xlt%sByteIndex[256] = {\n' % prefix)
+    for row in range(0, 256, 16):
+        out.write('  ' + ','.join(['%3d' % i for i in bytes[row:row + 16]]) + ',\n')
+    out.write('};\n')
+    # XML names
+    names = [xml for tag, byte, xml in table]
+    size, mult = perfecthash(names)
+    slots = [0] * size
+    for index, xml in enumerate(names):
+        slots[taghash(xml, mult, size)] = index + 1
+    out.write('#define XLT_%s_HASH_SIZE %d\n' % (prefix.upper(), size))
+    out.write('#define XLT_%s_HASH_MULT %d\n' % (prefix.upper(), mult))
+    out.write('static const unsigned char xlt%sNameHash[%d] = {\n' % (prefix, size))
+    for row in range(0, size, 16):
+        out.write('  ' + ','.join(['%3d' % i for i in slots[row:row + 16]]) + ',\n')
+    out.write('};\n')
+    if ifdef:
+        out.write('#endif\n')
+    out.write('\n')
+out.close()
@@ -148,6 +148,7 @@ static Ret_t xmlSkipComment(xmlScannerPrivPtr_t pScanner);
 static Ret_t xmlSkipAttributes(xmlScannerPrivPtr_t pScanner);
 static Ret_t xmlSkipPI(xmlScannerPrivPtr_t pScanner);
 static Ret_t xmlCDATA(xmlScannerPrivPtr_t pScanner);
+static Ret_t xmlText(xmlScannerPrivPtr_t pScanner, String_t endtag, SmlPcdataPtr_t pPCData);
 Boolean_t isPcdata(XltTagID_t tagid);
 
 /*************************************************************************/
@@ -691,6 +692,77 @@ xmlHTMLEntity(xmlScannerPrivPtr_t pScanner, char *entityptr)
 }
 
 
+/**
+ * Find the end of character data, decode HTML entities in it and
+ * store the result in pPCData. Text runs are located with memchr(),
+ * which the C library implements with word or vector instructions,
+ * instead of checking byte by byte, and a run with any number of
+ * entities is copied exactly once instead of being split into
+ * one token per entity which the decoder would have to concatenate.
+ *
+ * @param endtag (IN)
+ *        NULL: the text ends at the next '<';
+ *        otherwise: the text ends at this end tag or at a CDATA section,
+ *        all other '<' are part of the text
+ */
+static Ret_t
+xmlText(xmlScannerPrivPtr_t pScanner, String_t endtag, SmlPcdataPtr_t pPCData)
+{
+    MemPtr_t end = pScanner->pos;
+    MemPtr_t amp;
+    MemPtr_t out;
+    int endlen = endtag ? smlLibStrlen(endtag) : 0;
+    char entity = 0;
+    Ret_t ret;
+
+    // find the end of the text
+    for (;;) {
+        end = (MemPtr_t)memchr(end, '<', pScanner->bufend - end);
+        if (end == NULL) {
+            pScanner->pos = pScanner->bufend;
+            return SML_DECODEERROR(SML_ERR_XLT_INVAL_SYNCML_DOC,pScanner,"xmlText");
+        }
+        if (!endtag ||
+            smlLibStrncmp((String_t)end, endtag, endlen) == 0 ||
+            smlLibStrncmp((String_t)end, "<![CDATA[", 9) == 0)
+            break;
+        end++;
+    }
+
+    // decoded text is never longer than the original one
+    pPCData->content = smlLibMalloc(end - pScanner->pos + 1);
+    if (pPCData->content == NULL)
+        return SML_ERR_NOT_ENOUGH_SPACE;
+    out = (MemPtr_t)pPCData->content;
+    while (pScanner->pos < end) {
+        amp = (MemPtr_t)memchr(pScanner->pos, '&', end - pScanner->pos);
+        if (amp == NULL)
+            amp = end;
+        smlLibMemcpy(out, pScanner->pos, amp - pScanner->pos);
+        out += amp - pScanner->pos;
+        pScanner->pos = amp;
+        if (amp < end) {
+            ret = xmlHTMLEntity(pScanner, &entity);
+            if (ret == SML_ERR_OK && pScanner->pos > end)
+                ret = SML_DECODEERROR(SML_ERR_XLT_INVAL_SYNCML_DOC,pScanner,"xmlText");
+            if (ret) {
+                smlLibFree(pPCData->content);
+                pPCData->content = NULL;
+                return ret;
+            }
+            *out++ = entity;
+        }
+    }
+    *out = 0; // set terminator
+    pPCData->contentType = SML_PCDATA_STRING;
+    pPCData->length = out - (MemPtr_t)pPCData->content;
+
+    pScanner->curtok->type = TOK_CONT;
+    pScanner->curtok->pcdata = pPCData;
+
+    return SML_ERR_OK;
+}
+
 /**
  * FUNCTION: xmlCharData
  *
@@ -700,9 +772,7 @@ static Ret_t
 xmlCharData(xmlScannerPrivPtr_t pScanner)
 {
     SmlPcdataPtr_t pPCData;
-    MemPtr_t begin;
-    int len;
-    char entity;
+    Ret_t ret;
 
     pPCData = (SmlPcdataPtr_t)smlLibMalloc(sizeof(SmlPcdata_t));
     if (pPCData == NULL)
@@ -711,8 +781,6 @@ xmlCharData(xmlScannerPrivPtr_t pScanner)
     pPCData->length = 0;
     pPCData->content = NULL;
 
-    begin = pScanner->pos;
-
     if (*pScanner->pos >= *pScanner->bufend) {
         pPCData->content     = NULL;
         pPCData->contentType = SML_PCDATA_UNDEFINED;
@@ -724,45 +792,10 @@ xmlCharData(xmlScannerPrivPtr_t pScanner)
         return SML_DECODEERROR(SML_ERR_XLT_END_OF_BUFFER,pScanner,"xmlCharData");
     }
 
-    if (*pScanner->pos == '&') {
-        Ret_t ret = xmlHTMLEntity(pScanner, &entity);
-        if (ret) {
-            smlLibFree(pPCData);
-            return ret;
-        }
-        begin = (MemPtr_t)&entity;
-        len = 1;
-    } else {
-        while (*pScanner->pos != '<' && (*pScanner->pos != '&'))
-        {
-          if (pScanner->pos >= pScanner->bufend)
-          {
-            smlLibFree(pPCData);
-            return SML_DECODEERROR(SML_ERR_XLT_INVAL_SYNCML_DOC,pScanner,"xmlCharData");
-          }
-          if (!readBytes(pScanner, 1)) {
-              smlLibFree(pPCData);
-            return SML_DECODEERROR(SML_ERR_XLT_END_OF_BUFFER,pScanner,"xmlCharData");
-          }
-        }
-        len = pScanner->pos - begin;
-    }
-
-    pPCData->content = smlLibMalloc(len + 1);
-    if (pPCData->content == NULL){
-      smlLibFree(pPCData);
-      return SML_ERR_NOT_ENOUGH_SPACE;
-    }
-    //%%%waste of CPU: smlLibMemset(pPCData->content, 0, len + 1);
-    ((MemPtr_t)pPCData->content)[len]=0; // set terminator
-    smlLibMemcpy(pPCData->content, begin, len);
-    pPCData->contentType = SML_PCDATA_STRING;
-    pPCData->length = len;
-
-    pScanner->curtok->type = TOK_CONT;
-    pScanner->curtok->pcdata = pPCData;
-
-    return SML_ERR_OK;
+    ret = xmlText(pScanner, NULL, pPCData);
+    if (ret)
+        smlLibFree(pPCData);
+    return ret;
 }
 
 /**
@@ -1083,9 +1116,19 @@ xmlCDATA(xmlScannerPrivPtr_t pScanner)
     pPCData->content = NULL;
 
     begin = pScanner->pos;
-    while (!((pScanner->pos[0] == ']') && (pScanner->pos[1] == ']') && (pScanner->pos[2] == '>')))
-      if (!readBytes(pScanner, 1))
+    // look only at the ']' characters
+    while (!((pScanner->pos[0] == ']') && (pScanner->pos[1] == ']') && (pScanner->pos[2] == '>'))) {
+      MemPtr_t next = pScanner->pos < pScanner->bufend ?
+        (MemPtr_t)memchr(pScanner->pos + 1, ']', pScanner->bufend - pScanner->pos - 1) :
+        NULL;
+      if (next == NULL) {
+        pScanner->pos = pScanner->bufend;
+        pScanner->finished = 1;
+        smlLibFree(pPCData);
         return SML_DECODEERROR(SML_ERR_XLT_END_OF_BUFFER,pScanner,"xmlCDATA");
+      }
+      pScanner->pos = next;
+    }
 
     len = pScanner->pos - begin;
     pPCData->content = smlLibMalloc(len + 1);
@@ -1115,12 +1158,9 @@ static Ret_t
 xmlSkipPCDATA(xmlScannerPrivPtr_t pScanner)
 {
     SmlPcdataPtr_t pPCData;
-    MemPtr_t begin;
-    int len;
     Ret_t rc;
     String_t _tagString = NULL;
     String_t _tagString2 = NULL;
-    char entity;
 
     /* Check wether this PCData might contain a subdtd.
     ** We assume a Sub DTD starts with '<' as first char.
@@ -1175,60 +1215,14 @@ xmlSkipPCDATA(xmlScannerPrivPtr_t pScanner)
     pPCData->length = 0;
     pPCData->content = NULL;
 
-    begin = pScanner->pos;
-
-    if (*pScanner->pos == '&') {
-        Ret_t ret = xmlHTMLEntity(pScanner, &entity);
-        if (ret) {
-            smlLibFree(_tagString2);
-            return ret;
-        }
-        begin = (MemPtr_t)&entity;
-        len = 1;
-    } else {
-        // Read Pcdata content until end tag appears or we run into something which
-        // requires special decoding: CDATA or HTML entity
-        while (smlLibStrncmp((String_t)pScanner->pos, _tagString2, smlLibStrlen(_tagString2)) != 0)
-        {
-          // check if end of buffer
-          if (pScanner->pos >= pScanner->bufend) {
-            smlLibFree(_tagString2);
-            return SML_DECODEERROR(SML_ERR_XLT_INVAL_SYNCML_DOC,pScanner,"xmlSkipPCDATA");
-          }
-          // %%% luz 2006-09-07
-          // check if another <![CDATA[ opens here or an HTML entity
-          if (smlLibStrncmp((String_t)pScanner->pos,"<![CDATA[",9)==0 ||
-              *pScanner->pos == '&') {
-            // stop PCDATA scanning here
-            break;
-          }
-          if (!readBytes(pScanner, 1))
-            return SML_DECODEERROR(SML_ERR_XLT_END_OF_BUFFER,pScanner,"xmlSkipPCDATA");
-
-        }
-        len = pScanner->pos - begin;
-    }
-
+    // Read Pcdata content until end tag appears or we run into a CDATA
+    // section (luz 2006-09-07); HTML entities get decoded on the way
+    rc = xmlText(pScanner, _tagString2, pPCData);
     smlLibFree(_tagString2);
-
-    pPCData->content = smlLibMalloc(len + 1);
-    if (pPCData->content == NULL)
-    {
+    if (rc)
         smlLibFree(pPCData);
-        return SML_ERR_NOT_ENOUGH_SPACE;
-    }
-
-    //%%%waste of CPU: smlLibMemset(pPCData->content, 0, len + 1);
-    ((MemPtr_t)pPCData->content)[len]=0; // set terminator
-    smlLibMemcpy(pPCData->content, begin, len);
-    pPCData->contentType = SML_PCDATA_STRING;
-    pPCData->length = len;
-
-    pScanner->curtok->type = TOK_CONT;
-    pScanner->curtok->pcdata = pPCData;
-
 
-    return SML_ERR_OK;
+    return rc;
 }
 
 /**
@@ -0,0 +1,108 @@
+/*
+ * Generated by gen-xlttaghash.py from xlttags.c, do not edit.
+ *
+ * WBXML byte and XML name lookup tables for the tag tables in
+ * getTagTable(). Entries are the position of the tag in the table
+ * plus one, zero means "unknown tag".
+ */
+
+#define XLT_SYNCML_TAG_COUNT 55
+static const unsigned char xltSyncMLByteIndex[256] = {
+    0,  0,  0,  0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11,
+   12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27,
+   28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43,
+    0, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+#define XLT_SYNCML_HASH_SIZE 168
+#define XLT_SYNCML_HASH_MULT 786
+static const unsigned char xltSyncMLNameHash[168] = {
+    0,  0,  2,  0, 53, 54, 24,  0, 43,  4,  0,  0,  0,  0,  0,  0,
+    0,  0,  0, 16,  0,  0, 20,  0,  0,  0,  0,  0,  0, 28,  0,  0,
+    0,  0, 33,  0,  0,  0,  0,  0,  0,  0,  5, 17,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0, 37, 36,  0, 25,  0,  0, 30, 23,  0,
+    0,  3,  0,  0,  0,  0,  0,  0,  0, 11,  0, 45,  0,  0,  8,  0,
+    0, 26, 50, 32, 40,  9, 55,  0,  0,  0,  0, 19, 44,  0, 41,  0,
+    0, 51,  0,  0,  0,  0,  0,  0,  0, 13,  6,  0,  0, 22,  0,  0,
+   52, 18, 49, 21,  0,  0, 48, 12, 34, 29, 15, 38,  0,  0,  0,  0,
+    7,  0,  0,  0,  0,  0, 27,  0,  1,  0,  0,  0,  0,  0,  0,  0,
+   14, 39, 42,  0,  0, 35,  0,  0, 31,  0, 10,  0,  0, 47,  0, 46,
+    0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+#ifdef __USE_METINF__
+#define XLT_METINF_TAG_COUNT 18
+static const unsigned char xltMetInfByteIndex[256] = {
+    0,  0,  0,  0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11,
+   12, 13, 14, 15, 16, 17, 18,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+#define XLT_METINF_HASH_SIZE 37
+#define XLT_METINF_HASH_MULT 33
+static const unsigned char xltMetInfNameHash[37] = {
+    0, 15,  0,  0,  0,  9,  0,  5,  0,  3, 17,  2,  0, 13,  0,  0,
+    0, 12,  0, 14,  0,  1,  8, 16,  6, 18,  0,  0,  0, 10,  4,  0,
+    0,  0,  0,  7, 11,
+};
+#endif
+
+#ifdef __USE_DEVINF__
+#define XLT_DEVINF_TAG_COUNT 48
+static const unsigned char xltDevInfByteIndex[256] = {
+    0,  0,  0,  0,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11,
+   12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27,
+   28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42,  0,
+   43, 44, 45, 46, 47,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+#define XLT_DEVINF_HASH_SIZE 147
+#define XLT_DEVINF_HASH_MULT 811
+static const unsigned char xltDevInfNameHash[147] = {
+   18,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 26, 42,  0,  0,
+    0, 13,  0,  0,  0,  0,  0,  1, 33, 37,  0, 15, 31,  0,  0,  0,
+   46, 47,  2,  0, 30,  0,  4,  0,  0, 11, 17,  0,  0, 21, 38,  0,
+    0,  0, 45,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0, 36,  0,  0, 16,  7,  0,  0,  0,  0,  0,  0,  5,  0,  0,  0,
+    0, 35, 34,  0,  0,  0,  0,  0,  9,  0,  0,  0,  0,  0, 25, 28,
+    0, 22, 20,  8,  0,  0, 39,  0, 10,  6, 23,  0, 41, 48,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0, 32,  0,  0, 27,  0,  0, 12,
+    0,  0,  0, 29, 14,  0,  0,  0, 19,  0, 44,  0,  0,  0, 24,  3,
+    0, 40, 43,
+};
+#endif
+
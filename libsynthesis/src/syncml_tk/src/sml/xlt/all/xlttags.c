@@ -55,6 +55,7 @@
 #include "xltmetinf.h"
 #include "xltdevinf.h"
 #include "xlttagtbl.h"
+#include "xlttaghash.h"
 
 
 // %%% luz:2003-07-31: added SyncML namespace tables
@@ -65,6 +66,10 @@ const char * const SyncMLNamespaces[SML_NUM_VERS] = {
   "SYNCML:SYNCML1.2"
 };
 
+/* compile time check that the generated lookup tables match the tag table */
+#define XLT_TAG_COUNT_CHECK(table, count) \
+  switch (0) { case 0: case sizeof(table) / sizeof(Tag_t) == (count) + 1: ; } /* duplicate case if stale */
+
 /* local prototypes */
 #ifdef NOWSM
 //%%% removed const to prevent gcc "type qualifiers ignored on function return type" warning
@@ -396,6 +401,16 @@ TagPtr_t getTagTable(SmlPcdataExtension_t ext)
   };
   #endif
 
+  /* xlttaghash.h must be regenerated with gen-xlttaghash.py
+   * whenever the tables above change */
+  XLT_TAG_COUNT_CHECK(syncml, XLT_SYNCML_TAG_COUNT);
+  #ifdef __USE_METINF__
+  XLT_TAG_COUNT_CHECK(metinf, XLT_METINF_TAG_COUNT);
+  #endif
+  #ifdef __USE_DEVINF__
+  XLT_TAG_COUNT_CHECK(devinf, XLT_DEVINF_TAG_COUNT);
+  #endif
+
   #ifndef NOWSM
   _tmpTagPtr = NULL;
   pGA = mgrGetSyncMLAnchor();
@@ -593,6 +608,82 @@ Ret_t getExtById(XltTagID_t tagID,  SmlPcdataExtension_t *pExt)
   return SML_ERR_XLT_INVAL_PROTO_ELEM;
 }
 
+/* lookup tables generated by gen-xlttaghash.py for one code page */
+typedef struct {
+  const unsigned char *byteIndex; /* WBXML tag byte -> table position + 1 */
+  const unsigned char *nameHash;  /* XLT_TAG_HASH() -> table position + 1 */
+  uInt32 hashSize;
+  uInt32 hashMult;
+} XltTagIndex_t, *XltTagIndexPtr_t;
+
+/* must match taghash() in gen-xlttaghash.py */
+#define XLT_TAG_HASH(tag, len, mult, size) \
+  ((((((uInt32)(len) * (mult) + (unsigned char)(tag)[0]) * (mult) + \
+      (unsigned char)(tag)[(len) / 2]) * (mult) + \
+     (unsigned char)(tag)[(len) - 1])) % (size))
+
+/**
+ * Returns the lookup tables for the tag table of a code page.
+ * Like the tag tables themselves they are read-only and thus
+ * shared by all instances of the toolkit.
+ *
+ * @return NULL for unknown code pages
+ */
+static const XltTagIndex_t *getTagIndex(SmlPcdataExtension_t ext)
+{
+  static const XltTagIndex_t indices[] = {
+    { xltSyncMLByteIndex, xltSyncMLNameHash, XLT_SYNCML_HASH_SIZE, XLT_SYNCML_HASH_MULT },
+    #ifdef __USE_METINF__
+    { xltMetInfByteIndex, xltMetInfNameHash, XLT_METINF_HASH_SIZE, XLT_METINF_HASH_MULT },
+    #endif
+    #ifdef __USE_DEVINF__
+    { xltDevInfByteIndex, xltDevInfNameHash, XLT_DEVINF_HASH_SIZE, XLT_DEVINF_HASH_MULT },
+    #endif
+  };
+  int i = 0;
+
+  if (ext == SML_EXT_UNDEFINED) return &indices[i];
+  #ifdef __USE_METINF__
+  i++;
+  if (ext == SML_EXT_METINF) return &indices[i];
+  #endif
+  #ifdef __USE_DEVINF__
+  i++;
+  if (ext == SML_EXT_DEVINF) return &indices[i];
+  #endif
+  return NULL;
+}
+
+/**
+ * Finds a tag string in the tag table of a code page via the
+ * perfect hash of the tag names, with a linear search as fallback
+ * for code pages without lookup tables and for strings not found
+ * via the hash.
+ *
+ * @return position in the table, -1 if not found
+ */
+static int findTagString(TagPtr_t pTags, SmlPcdataExtension_t ext, String_t tag)
+{
+  const XltTagIndex_t *pIndex = getTagIndex(ext);
+  int i;
+
+  if (pIndex) {
+    uInt32 len = smlLibStrlen(tag);
+    if (len > 0) {
+      i = pIndex->nameHash[XLT_TAG_HASH(tag, len, pIndex->hashMult, pIndex->hashSize)] - 1;
+      // the hash only selects a candidate, unknown tags may hit any slot
+      if (i >= 0 && smlLibStrcmp((pTags+i)->xml, tag) == 0) return i;
+      // not found: unknown tag (an error, so speed does not matter)
+      // or outdated xlttaghash.h, the search below handles both
+    }
+  }
+  for (i=0;((pTags+i)->id) != TN_UNDEF; i++) {
+    if (*(pTags+i)->xml != *tag) continue; // if the first char doesn't match we skip the strcmp to speed things up
+    if (smlLibStrcmp(((pTags+i)->xml), tag) == 0) return i;
+  }
+  return -1;
+}
+
 /**
  * Returns the tag ID which belongs to a tag string in a certain codepage
  *
@@ -613,12 +704,10 @@ Ret_t getTagIDByStringAndExt(String_t tag, SmlPcdataExtension_t ext, XltTagID_t
     if (pTags == NULL) {
       return SML_ERR_NOT_ENOUGH_SPACE;
     }
-    for (i=0;((pTags+i)->id) != TN_UNDEF; i++) {
-      if (*(pTags+i)->xml != *tag) continue; // if the first char doesn't match we skip the strcmp to speed things up
-        if (smlLibStrcmp(((pTags+i)->xml), tag) == 0) {
-            *pTagID = (pTags+i)->id;
-            return SML_ERR_OK;
-        }
+    i = findTagString(pTags, ext, tag);
+    if (i >= 0) {
+        *pTagID = (pTags+i)->id;
+        return SML_ERR_OK;
     }
     *pTagID = TN_UNDEF;
     return SML_ERR_XLT_INVAL_PROTO_ELEM;
@@ -641,11 +730,24 @@ Ret_t getTagIDByByteAndExt(Byte_t tag, SmlPcdataExtension_t ext, XltTagID_t *pTa
 {
 
     int i = 0;
+    const XltTagIndex_t *pIndex;
     TagPtr_t pTags = getTagTable(ext);
     if (pTags == NULL)
     {
       return SML_ERR_NOT_ENOUGH_SPACE;
     }
+    pIndex = getTagIndex(ext);
+    if (pIndex)
+    {
+      // direct lookup, keeps the first of several tags with the same byte
+      i = pIndex->byteIndex[tag] - 1;
+      if (i >= 0 && ((pTags+i)->wbxml) == tag)
+      {
+        *pTagID = (pTags+i)->id;
+        return SML_ERR_OK;
+      }
+      i = 0; // same as for strings: search the table
+    }
     while (((pTags+i)->id) != TN_UNDEF)
     {
       if (((pTags+i)->wbxml) == tag)
@@ -676,19 +778,17 @@ Ret_t getTagIDByByteAndExt(Byte_t tag, SmlPcdataExtension_t ext, XltTagID_t *pTa
 Ret_t getTagIDByStringAndNamespace(String_t tag, String_t ns, XltTagID_t *pTagID)
 {
     int i = 0;
-    TagPtr_t pTags = getTagTable(getExtByName(ns));
+    SmlPcdataExtension_t ext = getExtByName(ns);
+    TagPtr_t pTags = getTagTable(ext);
     if (pTags == NULL)
     {
       return SML_ERR_NOT_ENOUGH_SPACE;
     }
-    while (((pTags+i)->id) != TN_UNDEF)
+    i = findTagString(pTags, ext, tag);
+    if (i >= 0)
     {
-      if ((smlLibStrcmp(((pTags+i)->xml), tag) == 0))
-      {
-        *pTagID = (pTags+i)->id;
-        return SML_ERR_OK;
-      }
-      i++;
+      *pTagID = (pTags+i)->id;
+      return SML_ERR_OK;
     }
     *pTagID = TN_UNDEF;
     return SML_ERR_XLT_INVAL_PROTO_ELEM;
@@ -22,6 +22,15 @@
 #ifdef MULTI_THREAD_SUPPORT
 #include "platform_thread.h"
 #endif
+#ifdef SYDEBUG_ASYNC_OUTPUT
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+#if defined(ZIPPED_BINDATA_SUPPORT) && !defined(NO_C_FILES)
+#include "zlib.h"
+#include <unistd.h>
+#endif
 
 namespace sysync {
 
@@ -56,7 +65,8 @@ cAppCharP const DbgSourceModeNames[numDbgSourceModes] = {
 cAppCharP const DbgFlushModeNames[numDbgFlushModes] = {
   "buffered",   // no flush, keep open as long as possible, output buffered (fast, needed for network drives)
   "flush",      // flush every debug message
-  "openclose"   // open and close debug channel separately for every message (as in 2.x engine)
+  "openclose",  // open and close debug channel separately for every message (as in 2.x engine)
+  "async"       // buffer in memory, write and flush in a background thread
 };
 
 // debug subthread isolation modes
@@ -242,6 +252,9 @@ void TDbgOptions::clear(void)
   fAppend = false; // default to overwrite existing logfiles
   fSubThreadMode = dbgsubthread_suppress; // simply suppress subthread info
   fSubThreadBufferMax = 1024*1024; // don't buffer more than one meg.
+  fAsyncBufferSize = 1024*1024; // same limit for async output
+  fAsyncDropLines = false; // block rather than lose output
+  fCompression = 0; // plain text files
 } // TDbgOptions::clear
 
 
@@ -282,22 +295,107 @@ void TDbgOut::doDestruct(void)
 
 #ifndef NO_C_FILES
 
+// interval between two writes of the background writer in async mode
+#define ASYNC_WRITE_INTERVAL 50 // in lineartime_t units (milliseconds)
+
+// all outputs currently in async mode, for flushAllAsync(). Only
+// changed while holding asyncOutputsMutex(), read without lock by
+// flushAllAsync().
+static TStdFileDbgOut * volatile gAsyncOutputsP = NULL;
+
+// created on first use, outputs may be opened during static initialization
+static MutexPtr_t asyncOutputsMutex(void)
+{
+  static MutexPtr_t mutex = newMutex();
+  return mutex;
+} // asyncOutputsMutex
+
+#ifdef SYDEBUG_ASYNC_OUTPUT
+// thread function for the background writer
+extern "C" void *AsyncDbgWriterFunc(void *aParam);
+void *AsyncDbgWriterFunc(void *aParam)
+{
+  static_cast<TStdFileDbgOut *>(aParam)->asyncWriterLoop();
+  return NULL;
+} // AsyncDbgWriterFunc
+#endif
+
+
 TStdFileDbgOut::TStdFileDbgOut()
 {
   // init
   fFileName.erase();
   fFile=NULL;
+  fGzFile=NULL;
+  fCompression=0;
   mutex=newMutex();
+  fAsyncBufferSize=1024*1024;
+  fAsyncDropLines=false;
+  fRingMutex=newMutex();
+  fRing=NULL;
+  fRingSize=0;
+  fRingStart=0;
+  fRingUsed=0;
+  fDroppedLines=0;
+  fWriterThreadP=NULL;
+  fStopWriter=false;
+  fNextAsyncP=NULL;
+  fAsyncFd=-1;
 } // TStdFileDbgOut::TStdFileDbgOut
 
 
 TStdFileDbgOut::~TStdFileDbgOut()
 {
   destruct();
+  freeMutex(fRingMutex);
   freeMutex(mutex);
 } // TStdFileDbgOut::~TStdFileDbgOut
 
 
+// set size of buffer for async mode
+void TStdFileDbgOut::setAsyncBuffer(uInt32 aBufferSize, bool aDropLines)
+{
+  fAsyncBufferSize=aBufferSize;
+  fAsyncDropLines=aDropLines;
+} // TStdFileDbgOut::setAsyncBuffer
+
+
+// set gzip compression level
+void TStdFileDbgOut::setCompression(uInt16 aLevel)
+{
+  fCompression=aLevel;
+} // TStdFileDbgOut::setCompression
+
+
+// write to file, compressed if enabled
+void TStdFileDbgOut::writeData(cAppPointer aData, memSize aSize)
+{
+  #ifdef ZIPPED_BINDATA_SUPPORT
+  if (fGzFile) {
+    gzwrite((gzFile)fGzFile,aData,aSize);
+    return;
+  }
+  #endif
+  if (fwrite(aData, 1, aSize, fFile) != aSize) {
+    // error ignored
+  }
+} // TStdFileDbgOut::writeData
+
+
+// flush file, including the compressor
+void TStdFileDbgOut::flushData(void)
+{
+  #ifdef ZIPPED_BINDATA_SUPPORT
+  if (fGzFile) {
+    // complete the deflate block, so that everything written so far can be decompressed
+    gzflush((gzFile)fGzFile,Z_SYNC_FLUSH);
+    return;
+  }
+  #endif
+  fflush(fFile);
+} // TStdFileDbgOut::flushData
+
+
 // open standard C file based debug output channel
 bool TStdFileDbgOut::openDbg(cAppCharP aDbgOutputName, cAppCharP aSuggestedExtension, TDbgFlushModes aFlushMode, bool aOverWrite, bool aRawMode)
 {
@@ -311,15 +409,43 @@ bool TStdFileDbgOut::openDbg(cAppCharP aDbgOutputName, cAppCharP aSuggestedExten
   fFileName=aDbgOutputName;
   // for C files, use the extension provided
   fFileName+=aSuggestedExtension;
+  // compression is not possible when other processes or threads write into the same file
+  bool compress=false;
+  #ifdef ZIPPED_BINDATA_SUPPORT
+  compress=fCompression>0 && fFlushMode!=dbgflush_openclose;
+  if (compress)
+    fFileName+=".gz";
+  #endif
   // open
-  fFile=fopen(fFileName.c_str(),aRawMode ? (aOverWrite ? "wb" : "ab") : (aOverWrite ? "w" : "a"));
+  fFile=fopen(fFileName.c_str(),aRawMode || compress ? (aOverWrite ? "wb" : "ab") : (aOverWrite ? "w" : "a"));
   // in case this fails, we'll have a NULL fFile. We can't do anything more here
   fIsOpen=fFile!=NULL;
+  #ifdef ZIPPED_BINDATA_SUPPORT
+  if (fIsOpen && compress) {
+    // All output goes through the compressor, which writes into its own
+    // descriptor for the same file; appending adds another gzip member.
+    // fFile is kept for determining the file size.
+    char mode[4];
+    sprintf(mode,"ab%d",fCompression>9 ? 9 : fCompression);
+    int fd=dup(fileno(fFile));
+    fGzFile=fd<0 ? NULL : gzdopen(fd,mode);
+    if (!fGzFile) {
+      if (fd>=0) close(fd);
+      fclose(fFile);
+      fFile=NULL;
+      fIsOpen=false;
+    }
+  }
+  #endif
   // For openclose mode, we have opened here only to check for logfile writability - close again
   if (fIsOpen && fFlushMode==dbgflush_openclose) {
     fclose(fFile);
     fFile=NULL;
   }
+  // For async mode, start the writer
+  if (fIsOpen && fFlushMode==dbgflush_async) {
+    startAsync();
+  }
   // return false if we haven't been successful opening the channel
   return fIsOpen;
 } // TStdFileDbgOut::openDbg
@@ -339,8 +465,14 @@ uInt32 TStdFileDbgOut::dbgFileSize(void)
     fFile=NULL;
   }
   else {
+    lockMutex(mutex);
+    if (fRing) {
+      // buffered data counts, too
+      asyncWrite(false);
+    }
     fseek(fFile,0,SEEK_END); // move to end (needed, otherwise ftell may return 0 despite "a" fopen mode)
     sz=ftell(fFile); // return size
+    unlockMutex(mutex);
   }
   return sz;
 } // TStdFileDbgOut::dbgFileSize
@@ -350,6 +482,14 @@ uInt32 TStdFileDbgOut::dbgFileSize(void)
 void TStdFileDbgOut::closeDbg(void)
 {
   if (fIsOpen) {
+    // writes remaining buffered data
+    stopAsync();
+    #ifdef ZIPPED_BINDATA_SUPPORT
+    if (fGzFile) {
+      gzclose((gzFile)fGzFile);
+      fGzFile=NULL;
+    }
+    #endif
     if (fFile) {
       fclose(fFile);
       fFile=NULL;
@@ -364,6 +504,16 @@ void TStdFileDbgOut::putLine(cAppCharP aLine, bool aForceFlush)
 {
   // if not open, just NOP
   if (fIsOpen) {
+    if (fRing) {
+      // async mode: just buffer, writer thread does the rest
+      asyncPut(aLine,strlen(aLine),true);
+      if (aForceFlush) {
+        lockMutex(mutex);
+        asyncWrite(true);
+        unlockMutex(mutex);
+      }
+      return;
+    }
     if (fFlushMode==dbgflush_openclose) {
       // we need to open the file for append first
       lockMutex(mutex);
@@ -373,8 +523,8 @@ void TStdFileDbgOut::putLine(cAppCharP aLine, bool aForceFlush)
     }
     if (fFile) {
       // now output
-      fputs(aLine,fFile);
-      fputs("\n",fFile);
+      writeData(aLine,strlen(aLine));
+      writeData("\n",1);
 
       // do required flushing
       if (fFlushMode==dbgflush_openclose) {
@@ -385,7 +535,7 @@ void TStdFileDbgOut::putLine(cAppCharP aLine, bool aForceFlush)
       }
       else if (aForceFlush || fFlushMode==dbgflush_flush) {
         // simply flush
-        fflush(fFile);
+        flushData();
       }
     }
   }
@@ -396,15 +546,18 @@ void TStdFileDbgOut::putLine(cAppCharP aLine, bool aForceFlush)
 void TStdFileDbgOut::putRawData(cAppPointer aData, memSize aSize)
 {
   if (fIsOpen) {
+    if (fRing) {
+      // async mode
+      asyncPut((cAppCharP)aData,aSize,false);
+      return;
+    }
     if (fFlushMode==dbgflush_openclose) {
       // we need to open the file for append first
       lockMutex(mutex);
       fFile=fopen(fFileName.c_str(),"a");
     }
     if (fFile) {
-      if (fwrite(aData, 1, aSize, fFile) != 1) {
-        // error ignored
-      }
+      writeData(aData,aSize);
     }
     // do required flushing
     if (fFlushMode==dbgflush_openclose) {
@@ -415,12 +568,215 @@ void TStdFileDbgOut::putRawData(cAppPointer aData, memSize aSize)
     }
     else if (fFlushMode==dbgflush_flush) {
       // simply flush
-      fflush(fFile);
+      flushData();
     }
   }
 } // TStdFileDbgOut::putRawData
 
 
+// allocate buffer and start background writer
+void TStdFileDbgOut::startAsync(void)
+{
+  if (fRing || fAsyncBufferSize==0) return; // already running or no buffer: stay synchronous
+  fRing=new char[fAsyncBufferSize];
+  fRingSize=fAsyncBufferSize;
+  fRingStart=0;
+  fRingUsed=0;
+  fDroppedLines=0;
+  fStopWriter=false;
+  // Without a thread, we stay in async mode nevertheless: callers
+  // write when the buffer is full, and at the latest when closing
+  #ifdef SYDEBUG_ASYNC_OUTPUT
+  pthread_t *threadP = new pthread_t;
+  if (pthread_create(threadP,NULL,AsyncDbgWriterFunc,this)==0)
+    fWriterThreadP=threadP;
+  else
+    delete threadP;
+  // compressed data cannot be written around the compressor
+  fAsyncFd=fGzFile ? -1 : fileno(fFile);
+  #endif
+  // register for flushAllAsync(), fully set up before it becomes visible
+  lockMutex(asyncOutputsMutex());
+  fNextAsyncP=gAsyncOutputsP;
+  gAsyncOutputsP=this;
+  unlockMutex(asyncOutputsMutex());
+} // TStdFileDbgOut::startAsync
+
+
+// stop background writer, write remaining data and free buffer
+void TStdFileDbgOut::stopAsync(void)
+{
+  if (!fRing) return;
+  #ifdef SYDEBUG_ASYNC_OUTPUT
+  if (fWriterThreadP) {
+    pthread_t *threadP = static_cast<pthread_t *>(fWriterThreadP);
+    lockMutex(mutex);
+    fStopWriter=true;
+    unlockMutex(mutex);
+    pthread_join(*threadP,NULL);
+    delete threadP;
+    fWriterThreadP=NULL;
+  }
+  #endif
+  // unregister
+  lockMutex(asyncOutputsMutex());
+  TStdFileDbgOut * volatile *outPP=&gAsyncOutputsP;
+  while (*outPP) {
+    if (*outPP==this) {
+      *outPP=fNextAsyncP;
+      break;
+    }
+    outPP=&((*outPP)->fNextAsyncP);
+  }
+  fNextAsyncP=NULL;
+  fAsyncFd=-1;
+  unlockMutex(asyncOutputsMutex());
+  // write what's left
+  lockMutex(mutex);
+  asyncWrite(true);
+  lockMutex(fRingMutex);
+  delete [] fRing;
+  fRing=NULL;
+  fRingSize=0;
+  unlockMutex(fRingMutex);
+  unlockMutex(mutex);
+} // TStdFileDbgOut::stopAsync
+
+
+// copy data into ring buffer (async mode)
+void TStdFileDbgOut::asyncPut(cAppCharP aData, memSize aSize, bool aAddNewline)
+{
+  memSize needed=aSize+(aAddNewline ? 1 : 0);
+  lockMutex(fRingMutex);
+  while (fRingSize-fRingUsed<needed) {
+    // does not fit
+    if (fAsyncDropLines) {
+      // count it, writer reports it later
+      fDroppedLines++;
+      unlockMutex(fRingMutex);
+      return;
+    }
+    // make room by writing in the calling thread
+    unlockMutex(fRingMutex);
+    lockMutex(mutex);
+    asyncWrite(false);
+    if (needed>fRingSize) {
+      // would never fit, write directly (buffer is empty now)
+      writeData(aData,aSize);
+      if (aAddNewline) writeData("\n",1);
+      unlockMutex(mutex);
+      return;
+    }
+    unlockMutex(mutex);
+    lockMutex(fRingMutex);
+  }
+  // append, wrapping around at the end of the buffer
+  memSize pos=(fRingStart+fRingUsed) % fRingSize;
+  memSize n=fRingSize-pos;
+  if (n>aSize) n=aSize;
+  memcpy(fRing+pos,aData,n);
+  memcpy(fRing,aData+n,aSize-n);
+  fRingUsed+=aSize;
+  if (aAddNewline) {
+    fRing[(fRingStart+fRingUsed) % fRingSize]='\n';
+    fRingUsed++;
+  }
+  unlockMutex(fRingMutex);
+} // TStdFileDbgOut::asyncPut
+
+
+// write aSize bytes starting at aStart of the ring buffer to the file
+void TStdFileDbgOut::asyncWriteRing(memSize aStart, memSize aSize)
+{
+  memSize n=fRingSize-aStart;
+  if (n>aSize) n=aSize;
+  writeData(fRing+aStart,n);
+  if (aSize>n)
+    writeData(fRing,aSize-n);
+} // TStdFileDbgOut::asyncWriteRing
+
+
+// write all buffered data to file, caller must hold mutex
+// returns true if something was written
+bool TStdFileDbgOut::asyncWrite(bool aForceFlush)
+{
+  if (!fRing || !fFile) return false;
+  // take what is there now. Producers only append, so the
+  // data can be written without holding fRingMutex
+  lockMutex(fRingMutex);
+  memSize start=fRingStart;
+  memSize used=fRingUsed;
+  uInt32 dropped=fDroppedLines;
+  fDroppedLines=0;
+  unlockMutex(fRingMutex);
+  if (used>0) {
+    asyncWriteRing(start,used);
+    // flush before releasing the space, so that flushAllAsync() still
+    // finds data which only made it into the stdio buffer
+    flushData();
+    lockMutex(fRingMutex);
+    fRingStart=(fRingStart+used) % fRingSize;
+    fRingUsed-=used;
+    unlockMutex(fRingMutex);
+  }
+  if (dropped>0) {
+    string msg;
+    StringObjPrintf(msg,"*** %ld debug output lines dropped, log buffer full ***\n",(long)dropped);
+    writeData(msg.c_str(),msg.size());
+  }
+  if (dropped>0 || (aForceFlush && used==0))
+    flushData();
+  return used>0 || dropped>0 || aForceFlush;
+} // TStdFileDbgOut::asyncWrite
+
+
+// background writer thread, writes in batches
+void TStdFileDbgOut::asyncWriterLoop(void)
+{
+  bool stop=false;
+  while (!stop) {
+    sleepLineartime(ASYNC_WRITE_INTERVAL);
+    lockMutex(mutex);
+    asyncWrite(false);
+    stop=fStopWriter;
+    unlockMutex(mutex);
+  }
+} // TStdFileDbgOut::asyncWriterLoop
+
+
+// write data of the ring buffer which is not in the file yet directly
+// to the file descriptor. Async-signal-safe: no locks, no stdio, and
+// the buffer state is left alone (the process is going down anyway).
+void TStdFileDbgOut::emergencyWrite(void)
+{
+  #ifdef SYDEBUG_ASYNC_OUTPUT
+  int fd=fAsyncFd;
+  if (fd<0 || !fRing) return;
+  memSize start=fRingStart;
+  memSize used=fRingUsed;
+  while (used>0) {
+    memSize n=fRingSize-start;
+    if (n>used) n=used;
+    ssize_t res=write(fd,fRing+start,n);
+    if (res<0) {
+      if (errno==EINTR) continue;
+      return;
+    }
+    start=(start+res) % fRingSize;
+    used-=res;
+  }
+  #endif
+} // TStdFileDbgOut::emergencyWrite
+
+
+// write out buffers of all async outputs (from signal handlers)
+void TStdFileDbgOut::flushAllAsync(void)
+{
+  for (TStdFileDbgOut *outP=gAsyncOutputsP; outP; outP=outP->fNextAsyncP)
+    outP->emergencyWrite();
+} // TStdFileDbgOut::flushAllAsync
+
+
 #endif
 
 
@@ -1339,6 +1695,8 @@ bool TDebugLoggerBase::DebugStartOutput(void)
       }
     }
     else if (fDbgOptionsP && fDbgOutP && !fDbgPath.empty()) {
+      fDbgOutP->setAsyncBuffer(fDbgOptionsP->fAsyncBufferSize,fDbgOptionsP->fAsyncDropLines);
+      fDbgOutP->setCompression(fDbgOptionsP->fCompression);
       // try to open the debug channel (force to openclose if we have multiple threads mixed in one file)
       if (fDbgOutP->openDbg(
         fDbgPath.c_str(),
@@ -45,6 +45,7 @@ typedef enum {
   dbgflush_none,      ///< no flush, keep open as long as possible
   dbgflush_flush,     ///< flush every debug message
   dbgflush_openclose, ///< open and close debug channel separately for every message (as in 2.x engine)
+  dbgflush_async,     ///< buffer messages in memory, written and flushed by a background thread
   numDbgFlushModes
 } TDbgFlushModes;
 
@@ -102,6 +103,9 @@ public:
   bool fAppend; ///< if set, existing debug files will not be overwritten, but appended to
   TDbgSubthreadModes fSubThreadMode; ///< how to handle debug messages from subthreads
   uInt32 fSubThreadBufferMax; ///< how much to buffer for subthread maximally
+  uInt32 fAsyncBufferSize; ///< size of the in-memory buffer in dbgflush_async mode
+  bool fAsyncDropLines; ///< if set, lines which do not fit into the async buffer are dropped instead of blocking the caller
+  uInt16 fCompression; ///< gzip compression level for log files (0 = uncompressed)
 }; // TDbgOptions
 
 
@@ -142,6 +146,14 @@ public:
   /// @param aData[in]                pointer to data to be written
   /// @param aSize[in]                size in bytes of data block at aData to be written
   virtual void putRawData(cAppPointer aData, memSize aSize) { /* nop */};
+  /// @brief configure buffering for dbgflush_async mode, must be called before openDbg()
+  /// @param aBufferSize[in]          maximum number of bytes kept in memory
+  /// @param aDropLines[in]           if true, output which does not fit into the buffer is dropped (and counted)
+  ///                                 instead of being written synchronously by the caller
+  virtual void setAsyncBuffer(uInt32 aBufferSize, bool aDropLines) { /* nop */ };
+  /// @brief enable gzip compression, must be called before openDbg()
+  /// @param aLevel[in]               zlib compression level (1..9), 0 for uncompressed output
+  virtual void setCompression(uInt16 aLevel) { /* nop */ };
 protected:
   bool fIsOpen;
 }; // TDbgOut
@@ -164,11 +176,45 @@ public:
   virtual void closeDbg(void);
   virtual void putLine(cAppCharP aLine, bool aForceFlush);
   virtual void putRawData(cAppPointer aData, memSize aSize);
+  virtual void setAsyncBuffer(uInt32 aBufferSize, bool aDropLines);
+  virtual void setCompression(uInt16 aLevel);
+  /// @brief write out everything buffered by outputs in dbgflush_async mode
+  /// Notes:
+  /// - meant to be called from abort/crash signal handlers, so it takes no
+  ///   locks and only write()s the ring buffers as they are. Data which is
+  ///   written concurrently by another thread might be lost or duplicated.
+  /// - does nothing without SYDEBUG_ASYNC_OUTPUT and for compressed outputs
+  static void flushAllAsync(void);
+  /// @brief body of the background writer thread
+  void asyncWriterLoop(void);
 private:
   TDbgFlushModes fFlushMode;
   string fFileName;
   FILE * fFile;
-  MutexPtr_t mutex;
+  void * fGzFile; // gzFile all output goes to when compressing, NULL otherwise
+  uInt16 fCompression; // compression level to use when opening
+  MutexPtr_t mutex; // protects fFile
+  // dbgflush_async mode
+  uInt32 fAsyncBufferSize; // size of fRing to allocate when opening
+  bool fAsyncDropLines; // drop instead of blocking when fRing is full
+  MutexPtr_t fRingMutex; // protects fRing* and fDroppedLines, never held while doing file IO
+  char *fRing; // ring buffer, NULL if not in async mode
+  memSize fRingSize; // allocated size of fRing
+  memSize fRingStart; // offset of first byte not written to the file yet
+  memSize fRingUsed; // number of bytes not written to the file yet
+  uInt32 fDroppedLines; // lines dropped since last write
+  void *fWriterThreadP; // background writer (platform specific), NULL if not running
+  bool fStopWriter; // set to ask writer to terminate, protected by mutex
+  TStdFileDbgOut * volatile fNextAsyncP; // next output in list of async outputs, read by flushAllAsync()
+  int fAsyncFd; // file descriptor of fFile for flushAllAsync(), -1 if not usable
+  void writeData(cAppPointer aData, memSize aSize);
+  void flushData(void);
+  void startAsync(void);
+  void stopAsync(void);
+  void asyncPut(cAppCharP aData, memSize aSize, bool aAddNewline);
+  bool asyncWrite(bool aForceFlush);
+  void asyncWriteRing(memSize aStart, memSize aSize);
+  void emergencyWrite(void);
 }; // TStdFileDbgOut
 
 #endif
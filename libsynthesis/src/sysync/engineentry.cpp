@@ -18,6 +18,7 @@
 #include "SDK_util.h"
 #include "engineentry.h"
 #include "enginemodulebase.h"
+#include "debuglogger.h"
 
 
 namespace sysync {
@@ -338,6 +339,13 @@ void SySyncDebugPuts(void* aCB,
                          aDbgLevel, aLinePrefix, aText);
 }
 
+void SySyncDebugFlush()
+{
+  #if defined(SYDEBUG) && !defined(NO_C_FILES)
+  TStdFileDbgOut::flushAllAsync();
+  #endif
+}
+
 } // namespace sysync
 
 // eof
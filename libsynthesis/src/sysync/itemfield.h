@@ -22,6 +22,7 @@
 #include "sysync_utils.h"
 
 #include "engineinterface.h"
+#include "objectpool.h"
 
 #include <string>
 
@@ -54,6 +55,8 @@ class TItemField
 public:
   TItemField();
   virtual ~TItemField();
+  // field objects are created and deleted for every item, keep them in a pool
+  OBJECTPOOL_ALLOCATORS
   #ifdef ARRAYFIELD_SUPPORT
   // check array
   virtual bool isArray(void) const { return false; }
@@ -889,6 +889,7 @@ void TLocalDSConfig::clear(void)
   fAlwaysSendLocalID=false; // off as it used to be not SCTS conformant (but would give clients chances to remap IDs)
   #endif
   fMaxItemsPerMessage=0; // no limit
+  fMaxItemsPerCommand=1; // one item per command
   #ifdef OBJECT_FILTERING
   // - filters
   fRemoteAcceptFilter.erase();
@@ -967,6 +968,8 @@ bool TLocalDSConfig::localStartElement(const char *aElementName, const char **aA
   #endif
   else if (strucmp(aElementName,"maxitemspermessage")==0)
     expectUInt32(fMaxItemsPerMessage);
+  else if (strucmp(aElementName,"maxitemspercommand")==0)
+    expectUInt32(fMaxItemsPerCommand);
   #ifdef OBJECT_FILTERING
   // filtering
   else if (strucmp(aElementName,"acceptfilter")==0)
@@ -3136,16 +3139,15 @@ void TLocalEngineDS::dsConfirmItemOp(TSyncOperation aSyncOp, cAppCharP aLocalID,
 
 
 
-// handle status of sync operation
+// handle status of sync operation for one of the items of the command
+// (aLocalID/aRemoteID are the source and target of the item as sent)
 // Note: in case of superdatastore, status is always directed to the originating subdatastore, as
 //       the fDataStoreP of the SyncOpCommand is set to subdatastore when generating the SyncOps.
-bool TLocalEngineDS::engHandleSyncOpStatus(TStatusCommand *aStatusCmdP,TSyncOpCommand *aSyncOpCmdP)
+bool TLocalEngineDS::engHandleSyncOpStatus(TStatusCommand *aStatusCmdP,TSyncOpCommand *aSyncOpCmdP,cAppCharP aLocalID,cAppCharP aRemoteID)
 {
   TSyError statuscode = aStatusCmdP->getStatusCode();
-  // we can make it simple here because we KNOW that we do not send multiple items per SyncOp, so we
-  // just need to look at the first item's target and source
-  const char *localID = aSyncOpCmdP->getSourceLocalID();
-  const char *remoteID = aSyncOpCmdP->getTargetRemoteID();
+  const char *localID = aLocalID;
+  const char *remoteID = aRemoteID;
   #ifdef SYSYNC_SERVER
   string realLocID;
   #endif
@@ -3218,14 +3220,9 @@ bool TLocalEngineDS::engHandleSyncOpStatus(TStatusCommand *aStatusCmdP,TSyncOpCo
         // Instead of aborting the session we'll just remove the map item for that
         // server item, such that it will be re-added in the next sync session
         PDEBUGPRINTFX(DBG_DATA,("Status %hd: Replace target not found on client -> silently ignore but remove map in server (item will be added in next session), ",statuscode));
-        // remove map for remote item(s), targetRef contain remoteIDs
-        SmlTargetRefListPtr_t targetrefP = aStatusCmdP->getStatusElement()->targetRefList;
-        while (targetrefP) {
-          // target ref available
-          engProcessMap(smlPCDataToCharP(targetrefP->targetRef),NULL);
-          // next
-          targetrefP=targetrefP->next;
-        }
+        // remove map for remote item (a status for multiple items is handled once per item)
+        if (remoteID && *remoteID)
+          engProcessMap(remoteID,NULL);
         statuscode=410; // always use "gone" status (even if we might have received a 404)
         dsConfirmItemOp(sop_replace,localID,remoteID,false,statuscode);
         break;
@@ -4690,8 +4687,9 @@ void TLocalEngineDS::showStatistics(void)
 
 
 
-// create a new syncop command for sending to remote
-TSyncOpCommand *TLocalEngineDS::newSyncOpCommand(
+// create SmlItem for sending aSyncItemP in a sync op command
+// (returns NULL in case item cannot be sent now, e.g. for MaxObjSize limitations)
+SmlItemPtr_t TLocalEngineDS::newSyncOpItem(
   TSyncItem *aSyncItemP, // the sync item
   TSyncItemType *aSyncItemTypeP,  // the sync item type
   cAppCharP aLocalIDPrefix
@@ -4699,10 +4697,6 @@ TSyncOpCommand *TLocalEngineDS::newSyncOpCommand(
 {
   // get operation
   TSyncOperation syncop=aSyncItemP->getSyncOp();
-  // obtain meta
-  SmlPcdataPtr_t metaP = newMetaType(aSyncItemTypeP->getTypeName());
-  // create command
-  TSyncOpCommand *syncopcmdP = new TSyncOpCommand(fSessionP,this,syncop,metaP);
   // make sure item does not have stuff it is not allowed to have
   // %%% SCTS does not like SourceURI in Replace and Delete commands sent to Client
   // there are the only ones allowed to carry a GUID
@@ -4781,20 +4775,59 @@ TSyncOpCommand *TLocalEngineDS::newSyncOpCommand(
       }
     }
   }
-  if (itemP) {
-    // add it to the command
-    syncopcmdP->addItem(itemP);
-  }
-  else {
-    // no item - command is invalid, delete it
-    delete syncopcmdP;
-    syncopcmdP=NULL;
+  return itemP;
+} // TLocalEngineDS::newSyncOpItem
+
+
+// create a new syncop command for sending to remote
+TSyncOpCommand *TLocalEngineDS::newSyncOpCommand(
+  TSyncItem *aSyncItemP, // the sync item
+  TSyncItemType *aSyncItemTypeP,  // the sync item type
+  cAppCharP aLocalIDPrefix
+)
+{
+  // create item first
+  SmlItemPtr_t itemP = newSyncOpItem(aSyncItemP,aSyncItemTypeP,aLocalIDPrefix);
+  if (!itemP) {
+    // no item - no command
+    return NULL;
   }
+  // obtain meta
+  SmlPcdataPtr_t metaP = newMetaType(aSyncItemTypeP->getTypeName());
+  // create command
+  TSyncOpCommand *syncopcmdP = new TSyncOpCommand(fSessionP,this,aSyncItemP->getSyncOp(),metaP);
+  // add the item to the command
+  syncopcmdP->addItem(itemP);
   // return command
   return syncopcmdP;
 } // TLocalEngineDS::newSyncOpCommand
 
 
+// add another item to a syncop command created by newSyncOpCommand()
+// Returns false if the item must be sent in a new command instead.
+bool TLocalEngineDS::addSyncOpItem(
+  TSyncOpCommand *aSyncOpCmdP, // the command
+  TSyncItem *aSyncItemP, // the sync item
+  TSyncItemType *aSyncItemTypeP,  // the sync item type
+  cAppCharP aLocalIDPrefix
+)
+{
+  if (
+    aSyncOpCmdP->getSyncOp()!=aSyncItemP->getSyncOp() || // only same operation (and thus same flags)
+    aSyncOpCmdP->getItemCount()>=fDSConfigP->fMaxItemsPerCommand || // limit reached (or not enabled)
+    fSessionP->getSyncMLVersion()<syncml_vers_1_1 || // only SyncML 1.1 and later can split commands between messages
+    sInt32(aSyncOpCmdP->getItemSizes()) >= fSessionP->getSmlWorkspaceFreeBytes()-fSessionP->getNotUsableBufferBytes() // command already fills the message
+  ) {
+    return false; // needs a new command
+  }
+  // add item (if it can be sent at all)
+  SmlItemPtr_t itemP = newSyncOpItem(aSyncItemP,aSyncItemTypeP,aLocalIDPrefix);
+  if (itemP)
+    aSyncOpCmdP->addItem(itemP);
+  return true;
+} // TLocalEngineDS::addSyncOpItem
+
+
 // create SyncItem suitable for being sent from local to remote
 TSyncItem *TLocalEngineDS::newItemForRemote(
   uInt16 aExpectedTypeID    // typeid of expected type
@@ -153,6 +153,7 @@ public:
   TStringList fAliasNames; // list of aliases for this datastore
   #endif // SYSYNC_SERVER
   uInt32 fMaxItemsPerMessage; // if >0, limits the number of items sent per SyncML message (useful in case of slow datastores where collecting data might exceed client timeout)
+  uInt32 fMaxItemsPerCommand; // if >1, consecutive items with the same sync op are sent together in one Add/Replace/Delete command, and statuses for received multi-item commands are combined
   #ifdef OBJECT_FILTERING
   // filtering
   // - filter applied to items coming from remote party, non-matching
@@ -808,8 +809,8 @@ public:
     TSyncItem *syncitemP,
     TStatusCommand &aStatusCommand
   );
-  /// handle status of sync operation
-  bool engHandleSyncOpStatus(TStatusCommand *aStatusCmdP,TSyncOpCommand *aSyncOpCmdP);
+  /// handle status of sync operation for one of the items of the command
+  bool engHandleSyncOpStatus(TStatusCommand *aStatusCmdP,TSyncOpCommand *aSyncOpCmdP,cAppCharP aLocalID,cAppCharP aRemoteID);
   /// called to mark maps confirmed, that is, we have received ok status for them
   #ifdef SYSYNC_CLIENT
   SUPERDS_VIRTUAL void engMarkMapConfirmed(cAppCharP aLocalID, cAppCharP aRemoteID);
@@ -1131,6 +1132,8 @@ protected:
   /// (aka "force a conflict")
   TSyncItem *SendDBVersionOfItemAsServer(TSyncItem *aSyncItemP);
   #endif // SYSYNC_SERVER
+  /// create SmlItem for sending aSyncItemP in a sync op command, NULL if it cannot be sent now
+  SmlItemPtr_t newSyncOpItem(TSyncItem *aSyncItemP, TSyncItemType *aSyncItemTypeP, cAppCharP aLocalIDPrefix);
   /// helper to save resume state either at end of request or explicitly at reception of a "suspend"
   SUPERDS_VIRTUAL localstatus engSaveSuspendState(bool aAnyway);
   /// Returns true if type information is sufficient to create items to be sent to remote party
@@ -1145,6 +1148,14 @@ protected:
     TSyncItemType *aSyncItemTypeP, // the sync item type
     cAppCharP aLocalIDPrefix // prefix for localID (can be NULL for none)
   );
+  /// helper for derived classes to add further items to a sync op command created by newSyncOpCommand()
+  /// @return false if item cannot be added and must be sent in a new command
+  bool addSyncOpItem(
+    TSyncOpCommand *aSyncOpCmdP, // the command
+    TSyncItem *aSyncItemP, // the sync item
+    TSyncItemType *aSyncItemTypeP, // the sync item type
+    cAppCharP aLocalIDPrefix // prefix for localID (can be NULL for none)
+  );
   /// return pure relative (item) URI (removes absolute part or ./ prefix)
   /// @note this one is virtual because it is defined in TSyncDataStore
   virtual cAppCharP DatastoreRelativeURI(cAppCharP aURI);
@@ -782,6 +782,8 @@ void TMIMEProfileConfig::localResolve(bool aLastPass)
     // check for required settings
     if (!fRootProfileP)
       SYSYNC_THROW(TConfigParseException("empty 'mimeprofile' not allowed"));
+    // build property name lookup index for parsing
+    fRootProfileP->buildPropertyIndex();
     #ifndef NO_REMOTE_RULES
     // recursively resolve remote rule dependencies in all properties
     resolveRemoteRuleDeps(
@@ -1005,6 +1007,7 @@ TPropertyDefinition::TPropertyDefinition(const char* aName, sInt16 aNumVals, boo
   allowFoldAtSep = aAllowFoldAtSep; // allow folding at value separators even if it inserts a space at the end of the previous value
   groupFieldID = aGroupFieldID; // fid for field that contains the group tag (prefix to the property name, like "a" in "a.TEL:079122327")
   propGroup = aPropertyGroupID; // property group ID
+  propIndex = -1; // not indexed yet
   // check if this is an unprocessed wildcard property
   unprocessed = strchr(aName, '*')!=NULL;
   // check value list
@@ -1132,6 +1135,7 @@ TProfileDefinition::TProfileDefinition(
   subLevels=NULL;
   ownsProps=true;
   nextRepID=0;
+  propIndexBuilt=false;
 } // TProfileDefinition::TProfileDefinition
 
 
@@ -1206,6 +1210,82 @@ TProfileDefinition *TProfileDefinition::findProfile(const char *aNam)
   return NULL;
 } // TProfileDefinition::findProfile
 
+
+// find position of name in sorted property name index (first entry not less than name)
+static size_t findPropNameIndexPos(const TPropNameIndex &aIndex, cAppCharP aName, size_t aLen)
+{
+  size_t lo=0, hi=aIndex.size();
+  while (lo<hi) {
+    size_t mid=(lo+hi)/2;
+    if (strucmp(aIndex[mid].name,aName,0,aLen)<0)
+      lo=mid+1;
+    else
+      hi=mid;
+  }
+  return lo;
+} // findPropNameIndexPos
+
+
+static bool isWildcardPropName(cAppCharP aName)
+{
+  return aName && strpbrk(aName,"*?")!=NULL;
+} // isWildcardPropName
+
+
+// build property name index for this profile and all sublevels
+// Note: must be called once after all properties are defined, as the index
+//       is used read-only (and possibly by multiple sessions) afterwards
+void TProfileDefinition::buildPropertyIndex(void)
+{
+  TPropertyDefinition *propP;
+  propNameIndex.clear();
+  wildcardProps.clear();
+  // number properties in definition order, collect wildcard properties
+  sInt32 idx=0;
+  for (propP=propertyDefs; propP; propP=propP->next) {
+    propP->propIndex=idx++;
+    if (isWildcardPropName(TCFG_CSTR(propP->propname)))
+      wildcardProps.push_back(propP);
+  }
+  // create one entry per distinct (case insensitive) property name
+  for (propP=propertyDefs; propP; propP=propP->next) {
+    cAppCharP nam = TCFG_CSTR(propP->propname);
+    if (isWildcardPropName(nam)) continue;
+    size_t pos=findPropNameIndexPos(propNameIndex,nam,0);
+    if (pos<propNameIndex.size() && strucmp(propNameIndex[pos].name,nam)==0)
+      continue; // already indexed
+    TPropNameIndexEntry entry;
+    entry.name=nam;
+    // candidates are all definitions with the same name plus all wildcard definitions, in definition order
+    for (TPropertyDefinition *candP=propertyDefs; candP; candP=candP->next) {
+      cAppCharP cnam = TCFG_CSTR(candP->propname);
+      if (isWildcardPropName(cnam) || strucmp(cnam,nam)==0)
+        entry.candidates.push_back(candP);
+    }
+    propNameIndex.insert(propNameIndex.begin()+pos,entry);
+  }
+  propIndexBuilt=true;
+  // index sublevels
+  TProfileDefinition *lvlP = subLevels;
+  while(lvlP) {
+    lvlP->buildPropertyIndex();
+    lvlP=lvlP->next;
+  }
+} // TProfileDefinition::buildPropertyIndex
+
+
+// get list of property definitions that can match given name, in definition order.
+// Returns NULL if no index is available (caller must scan all properties then)
+const TPropDefList *TProfileDefinition::getPropertyCandidates(cAppCharP aName, size_t aLen) const
+{
+  if (!propIndexBuilt || aLen==0) return NULL;
+  size_t pos=findPropNameIndexPos(propNameIndex,aName,aLen);
+  if (pos<propNameIndex.size() && strucmp(propNameIndex[pos].name,aName,0,aLen)==0)
+    return &(propNameIndex[pos].candidates);
+  // unknown name, only wildcard properties can match
+  return &wildcardProps;
+} // TProfileDefinition::getPropertyCandidates
+
 #pragma exceptions reset
 #undef EXCEPTIONS_HERE
 #define EXCEPTIONS_HERE TARGET_HAS_EXCEPTIONS
@@ -1304,6 +1384,7 @@ TMimeDirProfileHandler::TMimeDirProfileHandler(
   fTreatRemoteTimeAsLocal = false; // only for broken implementations
   fTreatRemoteTimeAsUTC = false; // only for broken implementations
   fActiveRemoteRules.clear(); // no dependency on certain remote rules
+  fGenMaxItemSize = 3000; // not too small
 } // TMimeDirProfileHandler::TMimeDirProfileHandler
 
 
@@ -2099,11 +2180,15 @@ static void finalizeProperty(
   string &aString,
   TMimeDirMode aMimeMode, // MIME mode (older or newer vXXX format compatibility)
   bool aDoNotFold, // set to prevent folding
-  bool aDoSoftBreak // set to insert QP-softbreaks when \r is encountered, otherwise do a full hard break (which essentially inserts a space for mimo_old)
+  bool aDoSoftBreak, // set to insert QP-softbreaks when \r is encountered, otherwise do a full hard break (which essentially inserts a space for mimo_old)
+  size_t aPropTextLen=0 // length of proptext, if already known
 )
 {
-  // make sure that allocation does not increase char by char
-  aString.reserve(aString.size()+strlen(proptext)+100);
+  // make sure that allocation does not increase char by char, but grow
+  // geometrically to avoid re-allocating the entire output for every property
+  size_t needed = aString.size()+(aPropTextLen ? aPropTextLen : (proptext ? strlen(proptext) : 0))+100;
+  if (needed>aString.capacity())
+    aString.reserve(needed>2*aString.capacity() ? needed : 2*aString.capacity());
   char c;
   ssize_t n = 0, llen = 0;
   ssize_t foldLoc = -1; // possible break location - linear white space or explicit break indicator
@@ -2249,11 +2334,15 @@ sInt16 TMimeDirProfileHandler::generateValue(
   bool aEscapeOnlyLF          // if true, only linefeeds are escaped as \n, but nothing else (not even \ itself)
 )
 {
-  string vallist;             // as received from fieldToMIMEString()
-  string val;                 // single value
-  string outval;              // entire value (list) escaped
+  string &vallist = fGenValList; // as received from fieldToMIMEString()
+  string &val = fGenVal;          // single value
+  string &outval = fGenOutVal;    // entire value (list) escaped
   char c;
 
+  // work buffers are reused, start empty
+  vallist.erase();
+  outval.erase();
+
   // determine field ID
   bool isarray = false; // no array by default
   sInt16 fid=aConvDefP->fieldid;
@@ -2785,9 +2874,9 @@ sInt16 TMimeDirProfileHandler::generateProperty(
   TPropNameExtension *aPropNameExt // propname extension for generating musthave param values and maxrep/repinc for valuelists
 )
 {
-  string proptext; // unfolded property text
+  string &proptext = fGenPropText; // unfolded property text
   proptext.reserve(300); // not too small
-  string elemtext; // single element (value or param) text
+  string &elemtext = fGenElemText; // single element (value or param) text
   TEncodingTypes encoding;
   bool nonasc=false;
 
@@ -2795,6 +2884,7 @@ sInt16 TMimeDirProfileHandler::generateProperty(
   fPropTZIDtctx = TCTX_UNKNOWN;
   // - start with empty text
   proptext.erase();
+  elemtext.erase();
   // - init flags
   bool anyvaluessupported = false; // at least one of the main values must be supported by the remote in order to generate property at all
   bool arrayexhausted = false; // flag will be set if a main value was not generated because array exhausted
@@ -3045,7 +3135,7 @@ sInt16 TMimeDirProfileHandler::generateProperty(
     // - append (probably encoded) values now, always in UTF-8
     encodeValues(encoding,fDefaultOutCharset,elemtext,proptext,fDoNotFoldContent);
     // - fold, copy and terminate (CRLF) property into aString output
-    finalizeProperty(proptext.c_str(),aString,aMimeMode,fDoNotFoldContent,encoding==enc_quoted_printable);
+    finalizeProperty(proptext.c_str(),aString,aMimeMode,fDoNotFoldContent,encoding==enc_quoted_printable,proptext.size());
     // - special case: base64 (but not B) encoded value must have an extra CRLF even if folding is
     //   disabled, so we need to insert it here (because non-folding mode eliminates it from being
     //   generated automatically in encodeValues/finalizeProperty)
@@ -3069,9 +3159,9 @@ sInt16 TMimeDirProfileHandler::generateProperty(
 // generate MIME-DIR from item into string object
 void TMimeDirProfileHandler::generateMimeDir(TMultiFieldItem &aItem, string &aString)
 {
-  // clear string
-  aString.reserve(3000); // not too small
+  // clear string, presize to largest item seen so far to avoid growing it property by property
   aString.erase();
+  aString.reserve(fGenMaxItemSize);
   // reset item time zone before generating
   fHasExplicitTZ = false; // none set explicitly
   fItemTimeContext = fReceiverTimeContext; // default to receiver context
@@ -3146,6 +3236,9 @@ void TMimeDirProfileHandler::generateMimeDir(TMultiFieldItem &aItem, string &aSt
     // done
     fVTimeZonePendingProfileP = NULL;
   } // if pending VTIMEZONE
+  // remember size for presizing next item
+  if (aString.size()>fGenMaxItemSize)
+    fGenMaxItemSize = aString.size();
 } // TMimeDirProfileHandler::generateMimeDir
 
 
@@ -4521,7 +4614,12 @@ bool TMimeDirProfileHandler::parseLevels(
         return false;
       }
       // not disabled level
-      const TPropertyDefinition *propP = aProfileP->propertyDefs;
+      // - get the property definitions that can match this name from the index. If no index
+      //   is available, all properties are scanned in definition order.
+      const TPropDefList *candidatesP = aProfileP->getPropertyCandidates(propname,n);
+      size_t candIdx = 0;
+      const TPropertyDefinition *propP =
+        candidatesP ? (candidatesP->empty() ? NULL : candidatesP->front()) : aProfileP->propertyDefs;
       #ifndef NO_REMOTE_RULES
       const TPropertyDefinition *otherRulePropP = NULL; // default property which is used if none of the rule-dependent in the group was used
       bool ruleSpecificParsed = false;
@@ -4639,6 +4737,12 @@ bool TMimeDirProfileHandler::parseLevels(
           // - next property
           propP=propP->next;
         }
+        if (candidatesP && propP) {
+          // skip to next candidate at or after propP
+          while (candIdx<candidatesP->size() && (*candidatesP)[candIdx]->propIndex<propP->propIndex)
+            candIdx++;
+          propP = candIdx<candidatesP->size() ? (*candidatesP)[candIdx] : NULL;
+        }
       } // while all properties
     } // else: neither BEGIN nor END
     if (!propparsed) {
@@ -21,6 +21,7 @@
 #include "engine_defs.h"
 
 #include <set>
+#include <vector>
 
 namespace sysync {
 
@@ -299,6 +300,8 @@ public:
   sInt16 nextNameExt;
   // property group ID
   uInt16 propGroup; // starting at 1, groups subsequent props that have the same name
+  // position within the property list (set when building the property name index)
+  sInt32 propIndex;
   #ifndef NO_REMOTE_RULES
   // set if property enabled only if ruleDependency matches session's applied rule (even if NULL = no rule must be applied)
   bool dependsOnRemoterule;
@@ -313,6 +316,18 @@ public:
 }; // TPropertyDefinition
 
 
+// list of property definitions (in definition order)
+typedef std::vector<const TPropertyDefinition *> TPropDefList;
+
+// property name index entry
+typedef struct {
+  cAppCharP name; // property name (points to propname of first definition with this name)
+  TPropDefList candidates; // all definitions that can match that name (including wildcard ones), in definition order
+} TPropNameIndexEntry;
+// property name index, sorted case insensitively by name
+typedef std::vector<TPropNameIndexEntry> TPropNameIndex;
+
+
 // enumeration modes
 typedef enum {
   profm_custom,       // custom defined profile/subprofile
@@ -363,6 +378,9 @@ public:
   TPropertyDefinition *getPropertyDef(const char *aPropName);
   sInt16 getPropertyMainFid(const char *aPropName, uInt16 aIndex);
   TProfileDefinition *findProfile(const char *aNam);
+  // property name index for parsing
+  void buildPropertyIndex(void);
+  const TPropDefList *getPropertyCandidates(cAppCharP aName, size_t aLen) const;
   // next in chain
   TProfileDefinition *next;
   // parent profile
@@ -392,6 +410,10 @@ public:
   TMimeDirMode modeDependency;
 private:
   bool ownsProps;
+  // property name index (built once at config resolve, read-only afterwards)
+  bool propIndexBuilt;
+  TPropNameIndex propNameIndex;
+  TPropDefList wildcardProps; // candidates for names not in the index
 }; // TProfileDefinition
 
 
@@ -548,6 +570,14 @@ private:
   size_t fVTimeZoneInsertPos; // where to insert VTIMEZONE
   // delayed processing
   TDelayedParsingPropsList fDelayedProps; // list of properties to parse out-of-order
+  // generator work buffers, reused for every property and item to keep their
+  // capacity (generateProperty() and generateValue() are not reentrant)
+  string fGenPropText; // unfolded property text (name, params and values)
+  string fGenElemText; // value(s) of property
+  string fGenValList; // value list as returned by fieldToMIMEString()
+  string fGenVal; // single value from list
+  string fGenOutVal; // escaped value (list)
+  size_t fGenMaxItemSize; // size of largest item generated so far, used to presize output
   // helper
   void getOptionsFromDatastore(void);
 protected:
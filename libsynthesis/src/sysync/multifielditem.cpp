@@ -136,6 +136,8 @@ void TFieldListConfig::localResolve(bool aLastPass)
     // check for required settings
     if (fFields.size()==0)
       SYSYNC_THROW(TSyncException("fieldlist must contain at least one field"));
+    // allow recycling the field objects of an item and the one it is compared with
+    TObjectPool::reserve(2*fFields.size());
   }
   // resolve inherited
   inherited::localResolve(aLastPass);
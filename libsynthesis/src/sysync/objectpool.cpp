@@ -0,0 +1,126 @@
+/*
+ *  File:         objectpool.cpp
+ *
+ *  TObjectPool
+ *    Free lists for the small objects which are created and deleted
+ *    for every item processed (TSyncItem and TItemField objects)
+ *
+ *  Copyright (c) 2012 by Synthesis AG + plan44.ch
+ *
+ */
+
+#include "prefix_file.h"
+#include "sysync.h"
+#include "objectpool.h"
+
+#ifdef MULTI_THREAD_SUPPORT
+#include "platform_mutex.h"
+#endif
+
+#include <new>
+
+namespace sysync {
+
+// sizes are rounded up to multiples of this, which is also the alignment
+// guaranteed by the heap for all objects using the pool
+#define OBJECTPOOL_GRANULARITY 16
+// larger objects are not pooled
+#define OBJECTPOOL_MAXSIZE 512
+#define OBJECTPOOL_NUMSIZES (OBJECTPOOL_MAXSIZE/OBJECTPOOL_GRANULARITY)
+// number of objects per size kept when nobody called reserve()
+#define OBJECTPOOL_DEFAULTKEEP 32
+
+// a released block, linked into the free list for its size
+typedef struct FreeBlock {
+  struct FreeBlock *next;
+} TFreeBlock;
+
+// Plain data only, so the pool is usable during static construction and
+// destruction of other objects. Blocks still cached at exit are not freed.
+static TFreeBlock *gFreeLists[OBJECTPOOL_NUMSIZES];
+static uInt32 gFreeCounts[OBJECTPOOL_NUMSIZES];
+static uInt32 gMaxKeep = OBJECTPOOL_DEFAULTKEEP;
+static TObjectPoolStats gStats;
+
+#ifdef MULTI_THREAD_SUPPORT
+// created on first use, objects may be allocated during static initialization
+static MutexPtr_t poolMutex(void)
+{
+  static MutexPtr_t mutex = newMutex();
+  return mutex;
+} // poolMutex
+#define POOL_LOCK if (poolMutex()) lockMutex(poolMutex())
+#define POOL_UNLOCK if (poolMutex()) unlockMutex(poolMutex())
+#else
+#define POOL_LOCK
+#define POOL_UNLOCK
+#endif
+
+
+void *TObjectPool::alloc(size_t aSize)
+{
+  if (aSize==0 || aSize>OBJECTPOOL_MAXSIZE)
+    return ::operator new(aSize);
+  size_t idx = (aSize-1)/OBJECTPOOL_GRANULARITY;
+  TFreeBlock *blockP;
+  POOL_LOCK;
+  gStats.allocs++;
+  blockP = gFreeLists[idx];
+  if (blockP) {
+    gFreeLists[idx] = blockP->next;
+    gFreeCounts[idx]--;
+    gStats.reused++;
+    gStats.cached--;
+  }
+  POOL_UNLOCK;
+  if (blockP)
+    return blockP;
+  // allocate full size of the class, so the block can serve any object of that size
+  return ::operator new((idx+1)*OBJECTPOOL_GRANULARITY);
+} // TObjectPool::alloc
+
+
+void TObjectPool::release(void *aPtr, size_t aSize)
+{
+  if (!aPtr) return;
+  if (aSize==0 || aSize>OBJECTPOOL_MAXSIZE) {
+    ::operator delete(aPtr);
+    return;
+  }
+  size_t idx = (aSize-1)/OBJECTPOOL_GRANULARITY;
+  bool kept = false;
+  POOL_LOCK;
+  gStats.frees++;
+  if (gFreeCounts[idx]<gMaxKeep) {
+    TFreeBlock *blockP = static_cast<TFreeBlock *>(aPtr);
+    blockP->next = gFreeLists[idx];
+    gFreeLists[idx] = blockP;
+    gFreeCounts[idx]++;
+    gStats.cached++;
+    kept = true;
+  }
+  POOL_UNLOCK;
+  if (!kept)
+    ::operator delete(aPtr);
+} // TObjectPool::release
+
+
+void TObjectPool::reserve(uInt32 aNumObjects)
+{
+  POOL_LOCK;
+  if (aNumObjects>gMaxKeep)
+    gMaxKeep = aNumObjects;
+  POOL_UNLOCK;
+} // TObjectPool::reserve
+
+
+void TObjectPool::getStats(TObjectPoolStats &aStats)
+{
+  POOL_LOCK;
+  aStats = gStats;
+  POOL_UNLOCK;
+} // TObjectPool::getStats
+
+} // namespace sysync
+
+// eof
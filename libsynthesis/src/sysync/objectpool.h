@@ -0,0 +1,61 @@
+/*
+ *  File:         objectpool.h
+ *
+ *  TObjectPool
+ *    Free lists for the small objects which are created and deleted
+ *    for every item processed (TSyncItem and TItemField objects)
+ *
+ *  Copyright (c) 2012 by Synthesis AG + plan44.ch
+ *
+ */
+
+#ifndef ObjectPool_H
+#define ObjectPool_H
+
+#include "generic_types.h"
+
+#include <cstddef>
+
+namespace sysync {
+
+/// @brief allocation counters of TObjectPool
+typedef struct {
+  uInt32 allocs; ///< objects allocated
+  uInt32 reused; ///< ...of which came from a free list (no heap allocation)
+  uInt32 frees; ///< objects released
+  uInt32 cached; ///< objects currently kept in free lists
+} TObjectPoolStats;
+
+
+/// @brief process-wide cache of released objects, sorted by size
+/// Blocks are allocated from and returned to the heap individually, the
+/// pool merely keeps released blocks for reuse instead of freeing them.
+/// The number of blocks kept per size is limited, see reserve().
+/// Objects larger than OBJECTPOOL_MAXSIZE bypass the pool.
+class TObjectPool
+{
+public:
+  /// @brief get memory for an object
+  static void *alloc(size_t aSize);
+  /// @brief release memory obtained from alloc() with the same size
+  static void release(void *aPtr, size_t aSize);
+  /// @brief make sure that at least aNumObjects objects per size can be kept for reuse
+  /// (usually the number of fields of an item)
+  static void reserve(uInt32 aNumObjects);
+  /// @brief get current counters
+  static void getStats(TObjectPoolStats &aStats);
+}; // TObjectPool
+
+
+/// @brief class-specific operator new/delete which use TObjectPool
+/// Note: the size passed to operator delete is the size of the dynamic type
+///   only because the classes using this have virtual destructors.
+#define OBJECTPOOL_ALLOCATORS \
+  static void *operator new(size_t aSize) { return TObjectPool::alloc(aSize); } \
+  static void operator delete(void *aPtr, size_t aSize) { TObjectPool::release(aPtr,aSize); }
+
+} // namespace sysync
+
+#endif // ObjectPool_H
+
+// eof
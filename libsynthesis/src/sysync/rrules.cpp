@@ -833,70 +833,76 @@ incompat:
 } // RRULE1toInternal
 
 
-/// @brief calculate end date of RRULE when count is specified
-/// @return true if repeating, false if not repeating at all
-/// @note returns until=noLinearTime for endless repeat (count=0)
-bool endDateFromCount(
-  lineartime_t &until,
+// state of the expansion done by endDateFromCount() and countFromEndDate()
+typedef struct {
+  // recurrence parameters
+  char freq, freqmod;
+  sInt16 interval;
+  fieldinteger_t firstmask, lastmask;
+  bool countsoccurrences;
+  // - set if occurrences must be counted one by one, otherwise until is calculated from count directly
+  bool stepwise;
+  // elements of start point
+  lineartime_t dtstart;
+  sInt16 startyear,startmonth;
+  lineartime_t starttime;
+  // current point of expansion (startday, startwday and lastday are advanced along with it)
+  lineartime_t until;
+  sInt16 startday, startwday, lastday;
+  sInt16 newYearsPassed;
+  // - set if until is at an occurrence
+  bool found;
+} TCountExpandStatus;
+
+
+// prepare expansion for endDateFromCount() and countFromEndDate()
+// @return false if parameters do not describe a recurrence
+static bool initCountExpansion(
+  TCountExpandStatus &ce,
   lineartime_t dtstart,
   char freq, char freqmod,
   sInt16 interval,
   fieldinteger_t firstmask,fieldinteger_t lastmask,
-  sInt16 cnt, bool countsoccurrences,
+  bool countsoccurrences,
   TDebugLogger *aLogP
 )
 {
-  // count<=0 means endless
-  if (cnt<=0) {
-    until= noLinearTime; // forever, we don't need a start date for this
-    return true; // ok
-  }
-  // check no-rep cases
-  if (cnt<0) return false; // negative count, no repeat
   if (dtstart==noLinearTime) return false; // no start date, cannot calc end date -> no rep (but no error)
   if (interval<=0) return false; // interval=0 means no recurrence (but no error)
+  ce.freq = freq;
+  ce.freqmod = freqmod;
+  ce.interval = interval;
+  ce.firstmask = firstmask;
+  ce.lastmask = lastmask;
+  ce.countsoccurrences = countsoccurrences;
+  ce.stepwise = false;
+  ce.found = false;
+  ce.newYearsPassed = 0;
   // default to dtstart
-  until = dtstart;
+  ce.dtstart = dtstart;
+  ce.until = dtstart;
   // calculate elements of start point
-  sInt16 startwday;
-  sInt16 startyear,startmonth,startday;
-  lineartime_t starttime;
-  starttime = lineartime2timeonly(dtstart); // start time of day
-  startwday = lineartime2weekday(dtstart); // get starting weekday
-  lineartime2date(dtstart,&startyear,&startmonth,&startday); // year, month, day-in-month
-  // calculate interval repetitions (which is what is needed for daily and RRULE v1 calculation)
-  sInt16 ivrep = (cnt-1)*interval;
+  ce.starttime = lineartime2timeonly(dtstart); // start time of day
+  ce.startwday = lineartime2weekday(dtstart); // get starting weekday
+  lineartime2date(dtstart,&ce.startyear,&ce.startmonth,&ce.startday); // year, month, day-in-month
   // check if daily
   if (freq == 'D') {
     // Daily recurrence is same for occurrence and interval counts
     LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: daily calc - same in all cases"));
-    until = dtstart+(ivrep*linearDateToTimeFactor);
     return true;
   }
   else if (!countsoccurrences) {
     // RRULE v1 interpretation of count (=number of repetitions of interval, not number of occurrences)
-    // - determine end of recurrence interval (which is usually NOT a occurrence precisely)
     switch (freq)
     {
       case 'W':
         LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: simple weekly calc"));
-        // v1 end date calc, we need to take into account possible masks, so result must be end of interval, not just start date+interval
-        // weekly: end date is last day of target week
-        until=dtstart+((ivrep*DaysOfWeek-startwday+6)*linearDateToTimeFactor);
         return true;
       case 'M':
         LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: simple monthly calc"));
-        startmonth--; // make 0 based
-        startmonth += ivrep+1; // add number of months plus one (as we want next month, and then go one day back to last day of month)
-        startyear += startmonth / 12; // update years
-        startmonth = startmonth % 12 + 1; // update month and make 1 based again
-        // - calculate last day in month of occurrence
-        until = (date2lineardate(startyear,startmonth,1)-1)*linearDateToTimeFactor+starttime;
         return true;
       case 'Y':
         LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: simple yearly calc"));
-        // yearly: end date is end of end year
-        until = (date2lineardate(startyear+ivrep,12,31))*linearDateToTimeFactor+starttime;
         return true;
     }
   }
@@ -905,158 +911,234 @@ bool endDateFromCount(
     // requires more elaborate expansion
     // NOTE: this does not work without masks set, so we need to calculate the default masks if none are explicitly set
     // - we need the number of days in the month in most cases
-    sInt16 lastday = getMonthDays(lineartime2dateonly(dtstart)); // number of days in this month
-    sInt16 newYearsPassed;
+    ce.lastday = getMonthDays(lineartime2dateonly(dtstart)); // number of days in this month
     switch (freq)
     {
       case 'W':
         LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: full expansion weekly calc"));
         // - make sure we have a mask
-        if (firstmask==0 && lastmask==0)
-          firstmask = 1<<startwday; // set start day in mask
-        // now calculate
-        while (firstmask) {
-          if (firstmask & ((uInt64)1<<startwday)) {
-            // found an occurrence
-            cnt--; // count it
-            if (cnt<=0) break; // found all
-          }
-          // increment day
-          until+=linearDateToTimeFactor;
-          startwday++;
-          if (startwday>6) {
-            // new week starts
-            startwday=0;
-            // skip part of interval which has no occurrence
-            until+=(interval-1)*7*linearDateToTimeFactor;
-          }
-        }
+        if (ce.firstmask==0 && ce.lastmask==0)
+          ce.firstmask = 1<<ce.startwday; // set start day in mask
+        ce.stepwise = true;
         return true;
       case 'M':
         if (freqmod=='W') {
           // monthly by weekday
           LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: full expansion of monthly by weekday"));
           // - make sure we have a mask
-          if (firstmask==0 && lastmask==0)
-            firstmask = (uInt64)1<<(startwday+7*((startday-1)/7)); // set start day in mask
-          // - now calculate
-          while (firstmask || lastmask) {
-            // calculate which weeks we are in
-            sInt16 fwk=(startday-1) / 7; // start is nth week of the month
-            sInt16 lwk=(lastday-startday) / 7; // start is nth-last week of the month
-            if (
-              (firstmask & ((uInt64)1<<(startwday+7*fwk))) || // nth occurrence of weekday in month
-              (lastmask & ((uInt64)1<<(startwday+7*lwk))) // nth-last occurrence of weekday in month
-            ) {
-              // found an occurrence
-              cnt--; // count it
-              if (cnt<=0) break; // found all
-            }
-            // increment day
-            until+=linearDateToTimeFactor;
-            startday++; // next day in month
-            startwday++; if (startwday>6) startwday=0; // next day in the week
-            // check for new month
-            if (startday>lastday) {
-              // new month starts
-              sInt16 i=interval;
-              while (true) {
-                lastday = getMonthDays(lineartime2dateonly(until)); // number of days in next month
-                startday = 1; // start at 1st of month again
-                if (--i == 0) break; // done
-                // skip entire next month
-                until+=lastday*linearDateToTimeFactor; // advance by number of days in this month
-              }
-              // now recalculate weekday
-              startwday=lineartime2weekday(until); // calculation continues here
-            }
-          }
+          if (ce.firstmask==0 && ce.lastmask==0)
+            ce.firstmask = (uInt64)1<<(ce.startwday+7*((ce.startday-1)/7)); // set start day in mask
         }
         else {
           // everything else, including no modifier, is treated as monthly by monthday
           LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: full expansion of monthly by monthday"));
           // - make sure we have a mask
-          if (firstmask==0 && lastmask==0)
-            firstmask = (uInt64)1<<(startday-1); // set start day in mask
-          // - now calculate
-          while (firstmask || lastmask) {
-            if (
-              (firstmask & ((uInt64)1<<(startday-1))) || // nth day in month
-              (lastmask & ((uInt64)1<<(lastday-startday))) // nth-last day in month
-            ) {
-              // found an occurrence
-              cnt--; // count it
-              if (cnt<=0) break; // found all
-            }
-            // increment day
-            until+=linearDateToTimeFactor;
-            startday++; // next day in month
-            if (startday>lastday) {
-              // new month starts
-              sInt16 i=interval;
-              while (true) {
-                lastday = getMonthDays(lineartime2dateonly(until)); // number of days in next month
-                startday = 1; // start at 1st of month again
-                if (--i == 0) break; // done
-                // skip entire next month
-                until+=lastday*linearDateToTimeFactor; // advance by number of days in this month
-              }
-            }
-          }
+          if (ce.firstmask==0 && ce.lastmask==0)
+            ce.firstmask = (uInt64)1<<(ce.startday-1); // set start day in mask
         }
+        ce.stepwise = true;
         return true;
       case 'Y':
         if (freqmod=='M') {
           // Yearly by month
           LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: full expansion of yearly by month"));
           // - make sure we have a mask
-          if (firstmask==0 && lastmask==0)
-            firstmask = (uInt64)1<<(startmonth-1); // set start month in mask
+          if (ce.firstmask==0 && ce.lastmask==0)
+            ce.firstmask = (uInt64)1<<(ce.startmonth-1); // set start month in mask
           // - do entire calculation on 1st of month such that we can be sure that day exists (unlike a Feb 30th or April 31th)
-          until -= (startday-1)*linearDateToTimeFactor;
-          // - now calculate
-          newYearsPassed=0;
-          // occurrence interval can be at most 4 years in the future (safety abort)
-          while (newYearsPassed<=4) {
-            if (firstmask & ((uInt64)1<<(startmonth-1))) {
-              // possibly found an occurrence
-              // - is an occurrence only if that day exists in the month
-              if (startday<=lastday) {
-                cnt--; // count it
-                newYearsPassed = 0;
-                if (cnt<=0) break; // found all
-              }
-            }
-            // go to same day in next month (and skip months that don't have that day, like an 31st April or 30Feb
-            until+=lastday*linearDateToTimeFactor;
-            startmonth++;
-            if (startmonth>12) {
-              // new year starts
-              startmonth=1;
-              newYearsPassed++;
-              // skip additional years (in month steps)
-              for (sInt16 i=(interval-1)*12; i>0; i--) {
-                lastday = getMonthDays(lineartime2dateonly(until)); // number of days in next month
-                // skip month
-                until+=lastday*linearDateToTimeFactor; // advance by number of days in this month
-              }
-            }
-            // get size of next month to check
-            lastday = getMonthDays(lineartime2dateonly(until)); // number of days in next month
-          }
-          // move back to start day
-          until += (startday-1)*linearDateToTimeFactor;
+          ce.until -= (ce.startday-1)*linearDateToTimeFactor;
+          ce.stepwise = true;
         }
         else {
           // everything else, including no modifier, is treated as yearly on the same date (multiple occurrences per year not supported)
           LOGDEBUGPRINTFX(aLogP,DBG_PARSE+DBG_EXOTIC,("endDateFromCount: full expansion of yearly by yearday - NOT SUPPORTED with more than one day"));
-          until = (date2lineardate(startyear+ivrep,startmonth,startday))*linearDateToTimeFactor+starttime;
         }
         return true;
     } // switch
   }
   // no recurrence
   return false;
+} // initCountExpansion
+
+
+// calculate end date for cnt>0 repetitions for expansions which do not need to be stepped
+static lineartime_t directEndDate(TCountExpandStatus &ce, sInt16 cnt)
+{
+  // calculate interval repetitions (which is what is needed for daily and RRULE v1 calculation)
+  sInt16 ivrep = (cnt-1)*ce.interval;
+  sInt16 year = ce.startyear;
+  sInt16 month = ce.startmonth;
+  switch (ce.freq) {
+    case 'D':
+      return ce.dtstart+(ivrep*linearDateToTimeFactor);
+    case 'W':
+      // v1 end date calc, we need to take into account possible masks, so result must be end of interval, not just start date+interval
+      // weekly: end date is last day of target week
+      return ce.dtstart+((ivrep*DaysOfWeek-ce.startwday+6)*linearDateToTimeFactor);
+    case 'M':
+      month--; // make 0 based
+      month += ivrep+1; // add number of months plus one (as we want next month, and then go one day back to last day of month)
+      year += month / 12; // update years
+      month = month % 12 + 1; // update month and make 1 based again
+      // - calculate last day in month of occurrence
+      return (date2lineardate(year,month,1)-1)*linearDateToTimeFactor+ce.starttime;
+    case 'Y':
+      // yearly: v1 end date is end of end year, v2 the same date
+      if (!ce.countsoccurrences)
+        return (date2lineardate(year+ivrep,12,31))*linearDateToTimeFactor+ce.starttime;
+      else
+        return (date2lineardate(year+ivrep,month,ce.startday))*linearDateToTimeFactor+ce.starttime;
+  }
+  return ce.dtstart;
+} // directEndDate
+
+
+// advance stepwise expansion to the next occurrence
+// @note if there is none, the expansion stays at the point where counting gave up
+static void nextCountOccurrence(TCountExpandStatus &ce)
+{
+  switch (ce.freq) {
+    case 'W':
+      while (ce.firstmask) {
+        if (ce.found)
+          ce.found = false; // continue behind previous occurrence
+        else if (ce.firstmask & ((uInt64)1<<ce.startwday)) {
+          ce.found = true; // found an occurrence
+          break;
+        }
+        // increment day
+        ce.until+=linearDateToTimeFactor;
+        ce.startwday++;
+        if (ce.startwday>6) {
+          // new week starts
+          ce.startwday=0;
+          // skip part of interval which has no occurrence
+          ce.until+=(ce.interval-1)*7*linearDateToTimeFactor;
+        }
+      }
+      break;
+    case 'M':
+      while (ce.firstmask || ce.lastmask) {
+        if (ce.found)
+          ce.found = false; // continue behind previous occurrence
+        else if (ce.freqmod=='W') {
+          // calculate which weeks we are in
+          sInt16 fwk=(ce.startday-1) / 7; // start is nth week of the month
+          sInt16 lwk=(ce.lastday-ce.startday) / 7; // start is nth-last week of the month
+          if (
+            (ce.firstmask & ((uInt64)1<<(ce.startwday+7*fwk))) || // nth occurrence of weekday in month
+            (ce.lastmask & ((uInt64)1<<(ce.startwday+7*lwk))) // nth-last occurrence of weekday in month
+          ) {
+            ce.found = true; // found an occurrence
+            break;
+          }
+        }
+        else {
+          if (
+            (ce.firstmask & ((uInt64)1<<(ce.startday-1))) || // nth day in month
+            (ce.lastmask & ((uInt64)1<<(ce.lastday-ce.startday))) // nth-last day in month
+          ) {
+            ce.found = true; // found an occurrence
+            break;
+          }
+        }
+        // increment day
+        ce.until+=linearDateToTimeFactor;
+        ce.startday++; // next day in month
+        ce.startwday++; if (ce.startwday>6) ce.startwday=0; // next day in the week
+        // check for new month
+        if (ce.startday>ce.lastday) {
+          // new month starts
+          sInt16 i=ce.interval;
+          while (true) {
+            ce.lastday = getMonthDays(lineartime2dateonly(ce.until)); // number of days in next month
+            ce.startday = 1; // start at 1st of month again
+            if (--i == 0) break; // done
+            // skip entire next month
+            ce.until+=ce.lastday*linearDateToTimeFactor; // advance by number of days in this month
+          }
+          // now recalculate weekday
+          ce.startwday=lineartime2weekday(ce.until); // calculation continues here
+        }
+      }
+      break;
+    case 'Y':
+      // occurrence interval can be at most 4 years in the future (safety abort)
+      while (ce.newYearsPassed<=4) {
+        if (ce.found)
+          ce.found = false; // continue behind previous occurrence
+        else if (ce.firstmask & ((uInt64)1<<(ce.startmonth-1))) {
+          // possibly found an occurrence
+          // - is an occurrence only if that day exists in the month
+          if (ce.startday<=ce.lastday) {
+            ce.newYearsPassed = 0;
+            ce.found = true;
+            break;
+          }
+        }
+        // go to same day in next month (and skip months that don't have that day, like an 31st April or 30Feb
+        ce.until+=ce.lastday*linearDateToTimeFactor;
+        ce.startmonth++;
+        if (ce.startmonth>12) {
+          // new year starts
+          ce.startmonth=1;
+          ce.newYearsPassed++;
+          // skip additional years (in month steps)
+          for (sInt16 i=(ce.interval-1)*12; i>0; i--) {
+            ce.lastday = getMonthDays(lineartime2dateonly(ce.until)); // number of days in next month
+            // skip month
+            ce.until+=ce.lastday*linearDateToTimeFactor; // advance by number of days in this month
+          }
+        }
+        // get size of next month to check
+        ce.lastday = getMonthDays(lineartime2dateonly(ce.until)); // number of days in next month
+      }
+      break;
+  }
+} // nextCountOccurrence
+
+
+// current end date of stepwise expansion
+static lineartime_t steppedEndDate(TCountExpandStatus &ce)
+{
+  if (ce.freq=='Y') {
+    // move back to start day
+    return ce.until + (ce.startday-1)*linearDateToTimeFactor;
+  }
+  return ce.until;
+} // steppedEndDate
+
+
+/// @brief calculate end date of RRULE when count is specified
+/// @return true if repeating, false if not repeating at all
+/// @note returns until=noLinearTime for endless repeat (count=0)
+bool endDateFromCount(
+  lineartime_t &until,
+  lineartime_t dtstart,
+  char freq, char freqmod,
+  sInt16 interval,
+  fieldinteger_t firstmask,fieldinteger_t lastmask,
+  sInt16 cnt, bool countsoccurrences,
+  TDebugLogger *aLogP
+)
+{
+  // count<=0 means endless
+  if (cnt<=0) {
+    until= noLinearTime; // forever, we don't need a start date for this
+    return true; // ok
+  }
+  TCountExpandStatus ce;
+  if (!initCountExpansion(ce,dtstart,freq,freqmod,interval,firstmask,lastmask,countsoccurrences,aLogP))
+    return false; // no recurrence
+  if (!ce.stepwise) {
+    until = directEndDate(ce,cnt);
+    return true;
+  }
+  // count occurrences
+  while (cnt-- > 0)
+    nextCountOccurrence(ce);
+  until = steppedEndDate(ce);
+  return true;
 } // endDateFromCount
 
 
@@ -1183,6 +1265,27 @@ bool test_expand_rrule(void)
     UNIT_TEST_CALL(lt = getNextOccurrence(es),("lt = %s",s(lt)),lt==t("2009-07-31"),ok);
     UNIT_TEST_CALL(lt = getNextOccurrence(es),("lt = %s",s(lt)),lt==t(""),ok);
 
+    sInt16 cnt;
+    UNIT_TEST_TITLE("count of daily series");
+    UNIT_TEST_CALL(countFromEndDate(cnt,true,t("2010-01-04T10:00:00"),'D',' ',1,0x0,0x0,t("2010-12-31T00:00:00"),NULL),("cnt = %hd",cnt),cnt==361,ok);
+
+    UNIT_TEST_TITLE("count and end of weekday series");
+    UNIT_TEST_CALL(countFromEndDate(cnt,true,t("2010-01-04T10:00:00"),'W',' ',1,0x3E,0x0,t("2011-05-01T00:00:00"),NULL),("cnt = %hd",cnt),cnt==345,ok);
+    UNIT_TEST_CALL(endDateFromCount(lt,t("2010-01-04T10:00:00"),'W',' ',1,0x3E,0x0,345,true,NULL),("lt = %s",s(lt)),lt==t("2011-04-29T10:00:00"),ok);
+
+    UNIT_TEST_TITLE("count and end of biweekly series");
+    UNIT_TEST_CALL(endDateFromCount(lt,t("2010-01-04T10:00:00"),'W',' ',2,0x22,0x0,100,true,NULL),("lt = %s",s(lt)),lt==t("2011-11-25T10:00:00"),ok);
+    UNIT_TEST_CALL(countFromEndDate(cnt,true,t("2010-01-04T10:00:00"),'W',' ',2,0x22,0x0,lt,NULL),("cnt = %hd",cnt),cnt==100,ok);
+
+    UNIT_TEST_TITLE("ten years of daily, weekly and weekday series");
+    // 500 and more occurrences count as endless
+    UNIT_TEST_CALL(countFromEndDate(cnt,true,t("2010-01-04T10:00:00"),'D',' ',1,0x0,0x0,t("2019-12-31T23:59:59"),NULL),("cnt = %hd",cnt),cnt==0,ok);
+    UNIT_TEST_CALL(countFromEndDate(cnt,true,t("2010-01-04T10:00:00"),'W',' ',1,0x2,0x0,t("2019-12-31T23:59:59"),NULL),("cnt = %hd",cnt),cnt==0,ok);
+    UNIT_TEST_CALL(endDateFromCount(lt,t("2010-01-04T10:00:00"),'D',' ',1,0x0,0x0,499,true,NULL),("lt = %s",s(lt)),lt==t("2011-05-17T10:00:00"),ok);
+    UNIT_TEST_CALL(endDateFromCount(lt,t("2010-01-04T10:00:00"),'W',' ',1,0x2,0x0,499,true,NULL),("lt = %s",s(lt)),lt==t("2019-07-22T10:00:00"),ok);
+    UNIT_TEST_CALL(endDateFromCount(lt,t("2010-01-04T10:00:00"),'W',' ',1,0x3E,0x0,499,true,NULL),("lt = %s",s(lt)),lt==t("2011-12-01T10:00:00"),ok);
+    UNIT_TEST_CALL(countFromEndDate(cnt,true,t("2010-01-04T10:00:00"),'W',' ',1,0x3E,0x0,t("2011-11-30T10:00:00"),NULL),("cnt = %hd",cnt),cnt==498,ok);
+
   }
   return ok;
 }
@@ -1627,30 +1730,26 @@ bool countFromEndDate(
     cnt=0;
     return true;
   }
-  // iterate until end date is reached
-  cnt=1;
+  // expand until end date is reached
+  TCountExpandStatus ce;
+  if (!initCountExpansion(ce,dtstart,freq,freqmod,interval,firstmask,lastmask,countsoccurrences,aLogP))
+    return false; // error, cannot calc end date
   lineartime_t occurrence=noLinearTime;
   // break after 500 recurrences
-  while (cnt<500) {
-    if (!endDateFromCount(
-      occurrence,
-      dtstart,
-      freq,freqmod,
-      interval,
-      firstmask,lastmask,
-      cnt,
-      countsoccurrences,
-      aLogP
-    ))
-      return false; // error, cannot calc end date
+  for (cnt=1; cnt<500; cnt++) {
+    if (ce.stepwise) {
+      // continue expansion where previous count ended
+      nextCountOccurrence(ce);
+      occurrence = steppedEndDate(ce);
+    }
+    else
+      occurrence = directEndDate(ce,cnt);
     if (occurrence>until) {
       // no more occurrences
       cnt--;
       if (cnt==0) return false; // if not endless, but no occurrence found in range -> not repeating
       return true; // return count
     }
-    // next occurrence
-    cnt++;
   }
   // 500 and more recurrences count as endless
   cnt=0;
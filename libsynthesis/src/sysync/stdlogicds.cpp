@@ -198,6 +198,24 @@ localstatus TStdLogicDS::endDataWrite(void)
 } // TStdLogicDS::endDataWrite
 
 
+// issue sync op command generated by logicGenerateSyncCommandsAsXXX (NULL is ok), count its items as sent
+// returns false if not issued (no room in message, queued for next)
+bool TStdLogicDS::issueSyncOpCommand(
+  TSyncOpCommand *aSyncOpCmdP,
+  TSmlCommandPContainer &aNextMessageCommands,
+  TSmlCommand * &aInterruptedCommandP
+)
+{
+  if (!aSyncOpCmdP) return true; // nothing to issue
+  uInt32 cmditems = aSyncOpCmdP->getItemCount();
+  if (!fSessionP->issuePtr(aSyncOpCmdP,aNextMessageCommands,aInterruptedCommandP))
+    return false;
+  // count items sent
+  fItemsSent+=cmditems; // overall counter for statistics
+  return true;
+} // TStdLogicDS::issueSyncOpCommand
+
+
 // - read specific item from database
 //   Data and missing ID information is filled in from local database
 bool TStdLogicDS::logicRetrieveItemByID(
@@ -777,6 +795,7 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsServer(
   bool alldone=false;
   bool ignoreitem;
   uInt32 itemcount=0;
+  TSyncOpCommand *syncopcmdP=NULL; // command collecting items, not yet issued
   // send as many as possible from list of local modifications
   // sop_want_replace can only be sent if state is already dss_syncfinish
   TSyncItemPContainer::iterator pos;
@@ -831,7 +850,7 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsServer(
       // check other reasons to prevent further adds
       if (syncop==sop_wants_add || syncop==sop_add) {
         // - check if max number of items has already been reached
-        if (fMaxItemCount!=0 && fItemsSent>=fMaxItemCount) {
+        if (fMaxItemCount!=0 && fItemsSent+(syncopcmdP ? syncopcmdP->getItemCount() : 0)>=fMaxItemCount) {
           PDEBUGPRINTFX(DBG_DATA,(
             "Suppressed add for item localID='%s' (max item count=%ld reached)",
             syncitemP->getLocalID(),
@@ -866,31 +885,52 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsServer(
       // test next
       continue;
     }
-    // create sync op command (may return NULL in case command cannot be created, e.g. for MaxObjSize limitations)
-    TSyncOpCommand *syncopcmdP = newSyncOpCommand(syncitemP,itemtypeP,aLocalIDPrefix);
-    // erase item from list
-    delete syncitemP;
-    pos = fItems.erase(pos);
+    // add item to the command collected so far (if enabled, same op and still room)
+    TSyncOpCommand *cmdP = NULL; // command to be issued now
+    if (syncopcmdP && !addSyncOpItem(syncopcmdP,syncitemP,itemtypeP,aLocalIDPrefix)) {
+      // item does not fit, issue collected command first and come back for this item
+      cmdP = syncopcmdP;
+      syncopcmdP = NULL;
+    }
+    else {
+      // create new sync op command (may return NULL in case command cannot be created, e.g. for MaxObjSize limitations)
+      if (!syncopcmdP)
+        syncopcmdP = newSyncOpCommand(syncitemP,itemtypeP,aLocalIDPrefix);
+      // erase item from list
+      delete syncitemP;
+      pos = fItems.erase(pos);
+      itemcount++; // per message counter
+      // issue command now if it cannot take any more items
+      if (syncopcmdP && syncopcmdP->getItemCount()>=getDSConfig()->fMaxItemsPerCommand) {
+        cmdP = syncopcmdP;
+        syncopcmdP = NULL;
+      }
+    }
     // issue command now
     // - Note that when command is split, issuePtr returns true, but we still may NOT generate new commands
     //   as the message is already full now. That's why the while contains a check for message full and aNextMessageCommands size
     //   (was not the case before 2.1.0.2, which could cause that the first chunk of a subsequent command
     //   would be sent before the third..nth chunk of the previous command).
-    TSmlCommand *cmdP = syncopcmdP;
-    syncopcmdP=NULL;
     // possibly, we have a NULL command here (e.g. in case it could not be generated due to MaxObjSize restrictions)
     if (cmdP) {
-      if (!fSessionP->issuePtr(cmdP,aNextMessageCommands,aInterruptedCommandP)) {
+      if (!issueSyncOpCommand(cmdP,aNextMessageCommands,aInterruptedCommandP)) {
         alldone=false; // issue failed (no room in message), not finished so far
         break;
       }
-      // count item sent
-      fItemsSent++; // overall counter for statistics
-      itemcount++; // per message counter
       // send event (but no check for abort)
       DB_PROGRESS_EVENT(this,pev_itemsent,fItemsSent,getNumberOfChanges(),0);
     }
   }; // while not aborted and not message full
+  // issue command with the last collected items (gets queued for the next message if there's no room)
+  if (syncopcmdP && isAborted()) {
+    delete syncopcmdP;
+  }
+  else if (syncopcmdP) {
+    if (issueSyncOpCommand(syncopcmdP,aNextMessageCommands,aInterruptedCommandP))
+      DB_PROGRESS_EVENT(this,pev_itemsent,fItemsSent,getNumberOfChanges(),0);
+    else
+      alldone=false;
+  }
   // we are not done until all aNextMessageCommands are also out
   // Note: this must be specially checked because we now have SyncML 1.1 chunked commands.
   //   Those issue() fine, but leave a next chunk in the aNextMessageCommands queue.
@@ -958,6 +998,7 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsClient(
 {
   localstatus sta = LOCERR_OK;
   bool alldone=true;
+  TSyncOpCommand *syncopcmdP=NULL; // command collecting items, not yet issued
   // send as many changed items as possible
   TSyncItemType *itemtypeP = getRemoteReceiveType();
   POINTERTEST(itemtypeP,("TStdLogicDS::logicGenerateSyncCommandsAsClient: fRemoteReceiveFromLocalTypeP undefined"));
@@ -972,6 +1013,7 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsClient(
     sta = implGetItem(fEoC,changed,syncitemP);
     if (sta!=LOCERR_OK) {
       // fatal error
+      delete syncopcmdP;
       implEndDataRead(); // terminate reading (error does not matter)
       engAbortDataStoreSync(sta, true); // local problem
       return false; // not complete
@@ -1021,8 +1063,13 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsClient(
     }
     // set final syncop now
     syncitemP->setSyncOp(syncop);
-    // create sync op command
-    TSyncOpCommand *syncopcmdP = newSyncOpCommand(syncitemP,itemtypeP,aLocalIDPrefix);
+    // add item to the command collected so far (if enabled, same op and still room),
+    // otherwise create new sync op command for it (may return NULL in case command cannot be created, e.g. for MaxObjSize limitations)
+    TSyncOpCommand *cmdP = NULL; // command to be issued now
+    if (!syncopcmdP || !addSyncOpItem(syncopcmdP,syncitemP,itemtypeP,aLocalIDPrefix)) {
+      cmdP = syncopcmdP; // item did not fit, issue collected command first
+      syncopcmdP = newSyncOpCommand(syncitemP,itemtypeP,aLocalIDPrefix);
+    }
     #ifdef CLIENT_USES_SERVER_DB
     // save item, we need it later for post-processing and Map simulation
     fItems.push_back(syncitemP);
@@ -1035,19 +1082,24 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsClient(
     //   as the message is already full now. That's why the while contains a check for message full and aNextMessageCommands size
     //   (was not the case before 2.1.0.2, which could cause that the first chunk of a subsequent command
     //   would be sent before the third..nth chunk of the previous command).
-    TSmlCommand *cmdP = syncopcmdP;
-    syncopcmdP=NULL;
-    // possibly, we have a NULL command here (e.g. in case it could not be generated due to MaxObjSize restrictions)
-    if (cmdP) {
-      if (!fSessionP->issuePtr(cmdP,aNextMessageCommands,aInterruptedCommandP)) {
-        alldone=false; // issue failed (no room in message), not finished so far
-        break;
-      }
-      // count item sent
-      fItemsSent++;
+    sInt32 sentbefore = fItemsSent;
+    bool issued = issueSyncOpCommand(cmdP,aNextMessageCommands,aInterruptedCommandP);
+    // - also issue command with this item if it cannot take any more items
+    //   (if the previous one could not be issued, it gets queued after the loop)
+    if (issued && syncopcmdP && syncopcmdP->getItemCount()>=getDSConfig()->fMaxItemsPerCommand) {
+      cmdP = syncopcmdP;
+      syncopcmdP = NULL;
+      issued = issueSyncOpCommand(cmdP,aNextMessageCommands,aInterruptedCommandP);
+    }
+    if (!issued) {
+      alldone=false; // issue failed (no room in message), not finished so far
+      break;
+    }
+    if (fItemsSent!=sentbefore) {
       // send event and check for abort
       #ifdef PROGRESS_EVENTS
       if (!DB_PROGRESS_EVENT(this,pev_itemsent,fItemsSent,getNumberOfChanges(),0)) {
+        delete syncopcmdP;
         implEndDataRead(); // terminate reading
         fSessionP->AbortSession(500,true,LOCERR_USERABORT);
         return false; // error
@@ -1059,6 +1111,16 @@ bool TStdLogicDS::logicGenerateSyncCommandsAsClient(
       #endif
     }
   }; // while not aborted
+  // issue command with the last collected items (gets queued for the next message if there's no room)
+  if (syncopcmdP && isAborted()) {
+    delete syncopcmdP;
+  }
+  else if (syncopcmdP) {
+    if (issueSyncOpCommand(syncopcmdP,aNextMessageCommands,aInterruptedCommandP))
+      DB_PROGRESS_EVENT(this,pev_itemsent,fItemsSent,getNumberOfChanges(),0);
+    else
+      alldone=false;
+  }
   // we are not done until all aNextMessageCommands are also out
   // Note: this must be specially checked because we now have SyncML 1.1 chunked commands.
   //   Those issue() fine, but leave a next chunk in the aNextMessageCommands queue.
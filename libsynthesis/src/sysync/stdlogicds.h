@@ -344,6 +344,8 @@ private:
   localstatus startDataWrite(void);
   /// internal stdlogic: end writing if not already ended
   localstatus endDataWrite(void);
+  /// internal stdlogic: issue generated sync op command (NULL is ok), count its items as sent
+  bool issueSyncOpCommand(TSyncOpCommand *aSyncOpCmdP, TSmlCommandPContainer &aNextMessageCommands, TSmlCommand * &aInterruptedCommandP);
 public:
   // - must be called before starting a thread. If returns false, starting a thread now
   //   is not allowed and must be postponed.
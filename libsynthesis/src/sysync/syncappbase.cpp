@@ -954,6 +954,12 @@ bool TDebugConfig::localStartElement(const char *aElementName, const char **aAtt
     expectEnum(sizeof(fSessionDbgLoggerOptions.fSubThreadMode),&fSessionDbgLoggerOptions.fSubThreadMode,DbgSubthreadModeNames,numDbgSubthreadModes);
   else if (strucmp(aElementName,"subthreadbuffersize")==0)
     expectUInt32(fSessionDbgLoggerOptions.fSubThreadBufferMax);
+  else if (strucmp(aElementName,"asyncbuffersize")==0)
+    expectUInt32(fSessionDbgLoggerOptions.fAsyncBufferSize);
+  else if (strucmp(aElementName,"asyncdroplines")==0)
+    expectBool(fSessionDbgLoggerOptions.fAsyncDropLines);
+  else if (strucmp(aElementName,"logcompression")==0)
+    expectUInt16(fSessionDbgLoggerOptions.fCompression);
   else if (strucmp(aElementName,"singlegloballog")==0)
     expectBool(fSingleGlobLog);
   else if (strucmp(aElementName,"singlesessionlog")==0)
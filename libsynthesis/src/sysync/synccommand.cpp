@@ -1479,6 +1479,9 @@ TSyncOpCommand::TSyncOpCommand(
   fSyncOp=aSyncOp;
   // save element
   fSyncOpElementP = aSyncOpElementP;
+  // no items added
+  fItemCount=0;
+  fItemSizes=0;
   // no remainder to be sent as next chunk
   fChunkedItemSize = 0;
   fIncompleteData = false;
@@ -1500,10 +1503,9 @@ TSyncOpCommand::TSyncOpCommand(
 {
   // save datastore
   fDataStoreP=aDataStoreP;
-  #ifndef USE_SML_EVALUATION
   // no items yet
+  fItemCount=0;
   fItemSizes=0;
-  #endif
   // no remainder to be sent as next chunk
   fChunkedItemSize = 0;
   fIncompleteData = false;
@@ -1575,12 +1577,78 @@ uInt32 TSyncOpCommand::messageSize(void)
 #endif
 
 
+// helper: check if status refers to given item (by the item's source or target as sent)
+static bool statusRefersToItem(SmlStatusPtr_t aStatusP, SmlItemPtr_t aItemP)
+{
+  cAppCharP source = smlSrcTargLocURIToCharP(aItemP->source);
+  cAppCharP target = smlSrcTargLocURIToCharP(aItemP->target);
+  if (*source) {
+    for (SmlSourceRefListPtr_t srefP = aStatusP->sourceRefList; srefP; srefP=srefP->next) {
+      if (strcmp(smlPCDataToCharP(srefP->sourceRef),source)==0) return true;
+    }
+  }
+  if (*target) {
+    for (SmlTargetRefListPtr_t trefP = aStatusP->targetRefList; trefP; trefP=trefP->next) {
+      if (strcmp(smlPCDataToCharP(trefP->targetRef),target)==0) return true;
+    }
+  }
+  return false;
+} // statusRefersToItem
+
+
 // handle status received for previously issued command
 // returns true if done, false if command must be kept in the status queue
 bool TSyncOpCommand::handleStatus(TStatusCommand *aStatusCmdP)
 {
-  // check if this is a split command
-  if (fIncompleteData) {
+  SmlItemListPtr_t *itemnodePP = fSyncOpElementP ? &(fSyncOpElementP->itemList) : NULL;
+  // normal case: single item, which is answered by this status whatever it refers to
+  if (!itemnodePP || !*itemnodePP || !(*itemnodePP)->next) {
+    return handleItemStatus(aStatusCmdP, itemnodePP && *itemnodePP ? (*itemnodePP)->item : NULL, true);
+  }
+  // multiple items: remote sends a status per item (or one status listing several
+  // items in its refs). A status without refs applies to all items, one with refs
+  // we cannot match to any item to the first one still waiting for its status.
+  SmlStatusPtr_t statusP = aStatusCmdP->getStatusElement();
+  bool forall = !statusP->sourceRefList && !statusP->targetRefList;
+  bool found = forall;
+  if (!found) {
+    for (SmlItemListPtr_t nodeP = *itemnodePP; nodeP; nodeP=nodeP->next) {
+      if (statusRefersToItem(statusP,nodeP->item)) {
+        found=true;
+        break;
+      }
+    }
+    if (!found) {
+      PDEBUGPRINTFX(DBG_ERROR,("Status refers to none of the items of the command -> applying it to first item"));
+    }
+  }
+  while (*itemnodePP) {
+    SmlItemListPtr_t nodeP = *itemnodePP;
+    if (!found || forall || statusRefersToItem(statusP,nodeP->item)) {
+      if (handleItemStatus(aStatusCmdP, nodeP->item, nodeP->next==NULL)) {
+        // final status for this item, remove it so only the ones without status
+        // remain (these are the ones marked for resume/resend)
+        *itemnodePP = nodeP->next;
+        nodeP->next = NULL;
+        smlFreeItemList(nodeP);
+        if (!found) break; // only first item
+        continue;
+      }
+      if (!found) break; // only first item
+    }
+    itemnodePP = &(nodeP->next);
+  }
+  // done when all items have their final status
+  return fSyncOpElementP->itemList==NULL;
+} // TSyncOpCommand::handleStatus
+
+
+// handle status for one item of the command (aItemP may be NULL for commands without items)
+// returns true if done, false if item still needs a final status
+bool TSyncOpCommand::handleItemStatus(TStatusCommand *aStatusCmdP, SmlItemPtr_t aItemP, bool aLastItem)
+{
+  // check if this is a split command (only the last item can be an incomplete chunk)
+  if (fIncompleteData && aLastItem) {
     // must be 213
     if (aStatusCmdP->getStatusCode()==213) return true;
     // something wrong, we did not get a 213
@@ -1617,14 +1685,18 @@ bool TSyncOpCommand::handleStatus(TStatusCommand *aStatusCmdP)
   //       superID prefixed localIDs back to subDS's localID
   bool handled=false;
   if (fDataStoreP) {
-    handled=fDataStoreP->engHandleSyncOpStatus(aStatusCmdP,this);
+    handled=fDataStoreP->engHandleSyncOpStatus(
+      aStatusCmdP,this,
+      aItemP ? smlSrcTargLocURIToCharP(aItemP->source) : NULL, // source for outgoing items is localID
+      aItemP ? smlSrcTargLocURIToCharP(aItemP->target) : NULL // target for outgoing items is remoteID
+    );
   }
   if (!handled) {
     // let base class handle it
     handled=TSmlCommand::handleStatus(aStatusCmdP);
   }
   return handled;
-} // TSyncOpCommand::handleStatus
+} // TSyncOpCommand::handleItemStatus
 
 
 // mark any syncitems (or other data) for resume. Called for pending commands
@@ -1758,7 +1830,7 @@ void TSyncOpCommand::addItem(
   // add item
   if (fSyncOpElementP) {
     addItemToList(aItemP,&(fSyncOpElementP->itemList));
-    #ifndef USE_SML_EVALUATION
+    fItemCount++;
     fItemSizes +=
       ITEMOVERHEADSIZE +
       strlen(smlSrcTargLocURIToCharP(aItemP->target)) +
@@ -1768,7 +1840,6 @@ void TSyncOpCommand::addItem(
     SmlMetInfMetInfPtr_t metaP = smlPCDataToMetInfP(aItemP->meta);
     if (metaP) fItemSizes+=strlen(smlPCDataToCharP(metaP->type));
     if (aItemP->data) fItemSizes+=aItemP->data->length;
-    #endif
   }
 } // TSyncOpCommand::addItem
 
@@ -1931,6 +2002,7 @@ TSmlCommand *TSyncOpCommand::splitCommand(sInt32 aReduceByBytes)
 {
   SmlItemListPtr_t *itemListPP;
   TSyncOpCommand *remainingDataCmdP=NULL;
+  bool chunked=false; // set if last item that remains in this command was split
 
   // nothing remaining so far
   SmlItemListPtr_t remainingItems=NULL;
@@ -1961,8 +2033,9 @@ TSmlCommand *TSyncOpCommand::splitCommand(sInt32 aReduceByBytes)
         itemP->meta = newMeta(); // create meta as we haven't got one yet
       SmlMetInfMetInfPtr_t metinfP = (SmlMetInfMetInfPtr_t)(itemP->meta->content);
       // - set size if this is the first chunk
+      //   (only the first item of a command can be the continuation of a chunked item)
       if (metinfP->size) smlFreePcdata(metinfP->size);
-      if (fChunkedItemSize==0) {
+      if (fChunkedItemSize==0 || itemListPP!=&(fSyncOpElementP->itemList)) {
         // first chunk
         // - set dataPos to 0
         addDataPos(metinfP,0);
@@ -2045,12 +2118,14 @@ TSmlCommand *TSyncOpCommand::splitCommand(sInt32 aReduceByBytes)
       remainingItems=ilP;
       // count reduction
       aReduceByBytes=0;
+      chunked=true;
       // done
       break;
     }
     else {
       // Split between items
-      fChunkedItemSize=0; // no chunking in progress now
+      if (itemListPP==&(fSyncOpElementP->itemList))
+        fChunkedItemSize=0; // no chunking in progress now
       // - get last itemlist element
       SmlItemListPtr_t ilP = *itemListPP;
       // - cut it out of original list
@@ -2059,7 +2134,7 @@ TSmlCommand *TSyncOpCommand::splitCommand(sInt32 aReduceByBytes)
       ilP->next=remainingItems;
       remainingItems=ilP;
       // - count reduction
-      aReduceByBytes -= dataP ? dataP->length : 0;
+      aReduceByBytes -= (dataP ? dataP->length : 0) + ITEMOVERHEADSIZE;
       // loop to check second-last item
     }
     // repeat as long as reduction goal is not met
@@ -2087,9 +2162,10 @@ TSmlCommand *TSyncOpCommand::splitCommand(sInt32 aReduceByBytes)
       // now pass remaining items to new command
       remainingDataCmdP->fSyncOpElementP->itemList = remainingItems;
       // next command must know that it part of a chunked transfer
-      remainingDataCmdP->fChunkedItemSize = fChunkedItemSize;
-      // original command must know that it must expect a 213 status
-      fIncompleteData = true;
+      // (when splitting between items only, remaining items are complete)
+      remainingDataCmdP->fChunkedItemSize = chunked ? fChunkedItemSize : 0;
+      // original command must know that it must expect a 213 status for its last item
+      fIncompleteData = chunked;
     }
     else {
       // remaining items not used, delete them
@@ -2261,11 +2337,25 @@ missingeoc:
 } // TSyncOpCommand::AddNextChunk
 
 
+// helper: check if status of an item can be combined with the statuses of other items
+// (only plain success statuses, which are all the remote needs to know about most items)
+static bool canCombineItemStatus(TStatusCommand *aStatusCmdP)
+{
+  TSyError statuscode = aStatusCmdP->getStatusCode();
+  return
+    (statuscode==200 || statuscode==201) &&
+    aStatusCmdP->getStatusElement() &&
+    aStatusCmdP->getStatusElement()->itemList==NULL;
+} // canCombineItemStatus
+
+
 // execute command (perform real actions, generate status)
 // returns true if command has executed and can be deleted
 bool TSyncOpCommand::execute(void)
 {
   TStatusCommand *statusCmdP=NULL;
+  TStatusCommand *combinedStatusCmdP=NULL; // status not yet issued, which further items can be added to
+  bool combinestatus;
   SmlItemListPtr_t *itemnodePP, thisitemnode;
   localstatus sta;
   TSyncOpCommand *incompleteCmdP;
@@ -2287,6 +2377,9 @@ bool TSyncOpCommand::execute(void)
     }
     // get command meta if any
     SmlMetInfMetInfPtr_t cmdmetaP=smlPCDataToMetInfP(fSyncOpElementP->meta);
+    // peers which are configured for sending multiple items per command also get
+    // one status for all consecutive items with the same success status
+    combinestatus = fDataStoreP->getDSConfig()->fMaxItemsPerCommand>1;
     // process items
     DEBUGPRINTFX(DBG_HOT,("command started processing"));
     itemnodePP=&(fSyncOpElementP->itemList);
@@ -2300,6 +2393,7 @@ bool TSyncOpCommand::execute(void)
       // check for NULL item
       if (!thisitemnode->item) {
         PDEBUGPRINTFX(DBG_ERROR,("command with NULL item"));
+        if (combinedStatusCmdP) ISSUE_COMMAND_ROOT(fSessionP,combinedStatusCmdP);
         statusCmdP=newStatusCommand(400); // protocol error
         ISSUE_COMMAND_ROOT(fSessionP,statusCmdP);
         return true; // command executed
@@ -2649,16 +2743,38 @@ bool TSyncOpCommand::execute(void)
         }
         // - issue status for it
         if (statusCmdP) {
-          // add source and target refs of item
-          statusCmdP->addTargetRef(smlSrcTargLocURIToCharP(thisitemnode->item->target)); // add target ref
-          statusCmdP->addSourceRef(smlSrcTargLocURIToCharP(thisitemnode->item->source)); // add source ref
-          // issue
-          ISSUE_COMMAND_ROOT(fSessionP,statusCmdP);
+          if (
+            combinedStatusCmdP &&
+            combinedStatusCmdP->getStatusCode()==statusCmdP->getStatusCode() &&
+            canCombineItemStatus(statusCmdP)
+          ) {
+            // same status as previous item(s), just add refs of this item there
+            combinedStatusCmdP->addTargetRef(smlSrcTargLocURIToCharP(thisitemnode->item->target)); // add target ref
+            combinedStatusCmdP->addSourceRef(smlSrcTargLocURIToCharP(thisitemnode->item->source)); // add source ref
+            delete statusCmdP;
+            statusCmdP=NULL;
+          }
+          else {
+            // add source and target refs of item
+            statusCmdP->addTargetRef(smlSrcTargLocURIToCharP(thisitemnode->item->target)); // add target ref
+            statusCmdP->addSourceRef(smlSrcTargLocURIToCharP(thisitemnode->item->source)); // add source ref
+            // issue status collected so far
+            if (combinedStatusCmdP) ISSUE_COMMAND_ROOT(fSessionP,combinedStatusCmdP);
+            // issue, or keep for adding more items
+            if (combinestatus && canCombineItemStatus(statusCmdP)) {
+              combinedStatusCmdP=statusCmdP;
+              statusCmdP=NULL;
+            }
+            else
+              ISSUE_COMMAND_ROOT(fSessionP,statusCmdP);
+          }
         }
         // advance to next item in list
         itemnodePP = &(thisitemnode->next);
       }
     } // item loop
+    // issue combined status, if any
+    if (combinedStatusCmdP) ISSUE_COMMAND_ROOT(fSessionP,combinedStatusCmdP);
     // free this one in advance (only if command is finished)
     if (finished() && !tobequeueditems) FreeSmlElement();
     // update item list in command for queuing if needed
@@ -2673,6 +2789,7 @@ bool TSyncOpCommand::execute(void)
   SYSYNC_CATCH (...)
     // make sure owned objects in local scope are deleted
     if (statusCmdP) delete statusCmdP;
+    if (combinedStatusCmdP) delete combinedStatusCmdP;
     // re-throw
     SYSYNC_RETHROW;
   SYSYNC_ENDCATCH
@@ -2761,7 +2878,7 @@ bool TSyncOpCommand::issue(
           smlSrcTargLocURIToCharP(itemP->item->source),
           (long)itemlen
         ));
-        if (fChunkedItemSize>0 && !fIncompleteData) {
+        if (fChunkedItemSize>0 && !fIncompleteData && itemP==fSyncOpElementP->itemList) {
           #ifdef SYDEBUG
           PDEBUGPRINTFX(DBG_PROTO+DBG_HOT,(
             "Last Chunk (%ld bytes) of large object (%ld total) sent now - retaining it in case of implicit suspend",
@@ -2776,17 +2893,13 @@ bool TSyncOpCommand::issue(
         itemP=itemP->next;
       }
       // we don't need the data any more, but we should keep the source and target IDs until we have the status
-      // - get rid of data
-      if (fSyncOpElementP->itemList) {
-        // - free possible extra items (shouldn't be any - we always send single item per command)
-        smlFreeItemList(fSyncOpElementP->itemList->next);
-        fSyncOpElementP->itemList->next=NULL;
-        // - free data and meta part of this item, but not target and source info
-        if (fSyncOpElementP->itemList->item) {
-          smlFreePcdata(fSyncOpElementP->itemList->item->meta);
-          fSyncOpElementP->itemList->item->meta=NULL;
-          smlFreePcdata(fSyncOpElementP->itemList->item->data);
-          fSyncOpElementP->itemList->item->data=NULL;
+      // - free data and meta part of the items, but not target and source info
+      for (itemP = fSyncOpElementP->itemList; itemP; itemP=itemP->next) {
+        if (itemP->item) {
+          smlFreePcdata(itemP->item->meta);
+          itemP->item->meta=NULL;
+          smlFreePcdata(itemP->item->data);
+          itemP->item->data=NULL;
         }
       }
     }
@@ -417,6 +417,9 @@ public:
   #endif
   // - add an Item to an existing Sync op command
   void addItem(SmlItemPtr_t aItemP); // existing item data structure, ownership is passed to SyncOpCmd
+  // - number and (approximated) total size of items added so far
+  uInt32 getItemCount(void) { return fItemCount; };
+  uInt32 getItemSizes(void) { return fItemSizes; };
   // returns true if command must be put to the waiting-for-status queue.
   // If false, command can be deleted
   bool issue(
@@ -464,11 +467,11 @@ public:
 protected:
   localstatus AddNextChunk(SmlItemPtr_t aNextChunkItem, TSyncOpCommand *aCmdP);
   void saveAsPartialItem(SmlItemPtr_t aItemP);
+  bool handleItemStatus(TStatusCommand *aStatusCmdP, SmlItemPtr_t aItemP, bool aLastItem);
   virtual void FreeSmlElement(void);
   SmlGenericCmdPtr_t fSyncOpElementP;
-  #ifndef USE_SML_EVALUATION
+  uInt32 fItemCount; // number of items added
   uInt32 fItemSizes; // accumulated item size
-  #endif
   TSyncOperation fSyncOp; // Sync operation (sop_xxx)
   TLocalEngineDS *fDataStoreP;
   // SyncML 1.1 data segmentation
@@ -699,6 +702,9 @@ public:
   // properties
   // - get status code
   TSyError getStatusCode(void) { return fStatusCode; };
+  // - get IDs of the command this status refers to
+  uInt32 getRefMsgID(void) { return fRefMsgID; };
+  uInt32 getRefCmdID(void) { return fRefCmdID; };
   // - get status Sml Element
   const SmlStatusPtr_t getStatusElement(void) { return fStatusElementP; }
 protected:
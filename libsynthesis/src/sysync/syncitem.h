@@ -20,6 +20,7 @@
 
 // includes
 #include "syncitemtype.h"
+#include "objectpool.h"
 
 
 namespace sysync {
@@ -66,6 +67,8 @@ class TSyncItem
 public:
   TSyncItem(TSyncItemType *aItemType=NULL);
   virtual ~TSyncItem();
+  // items are created and deleted all the time, keep them in a pool
+  OBJECTPOOL_ALLOCATORS
   // access to type
   virtual uInt16 getTypeID(void) const { return ity_syncitem; };
   virtual bool isBasedOn(uInt16 aItemTypeID) const { return aItemTypeID==ity_syncitem; };
@@ -1000,6 +1000,7 @@ TSyncSession::TSyncSession(
   MP_SHOWCURRENT(DBG_PROFILE,"TSyncSession::TSyncSession: TSyncSession created");
   TP_INIT(fTPInfo);
   TP_START(fTPInfo,TP_general);
+  TObjectPool::getStats(fObjectPoolStats);
   DEBUGPRINTFX(DBG_EXOTIC,("TSyncSession::TSyncSession: Profiling initialized"));
   // set fields
   fEncoding = SML_UNDEF;
@@ -1248,6 +1249,20 @@ void TSyncSession::TerminateSession(void)
     }
     fLocalItemTypes.clear(); // clear list
     #ifdef SYDEBUG
+    // show item/field allocations of this session (the pool is process-wide,
+    // so concurrent sessions are included)
+    TObjectPoolStats poolstats;
+    TObjectPool::getStats(poolstats);
+    uInt32 allocs = poolstats.allocs-fObjectPoolStats.allocs;
+    uInt32 reused = poolstats.reused-fObjectPoolStats.reused;
+    PDEBUGPRINTFX(DBG_HOT,(
+      "Item/field object statistics: %ld allocated, %ld of them reused (%ld heap allocations), %ld released, %ld kept for reuse",
+      (long)allocs,
+      (long)reused,
+      (long)(allocs-reused),
+      (long)(poolstats.frees-fObjectPoolStats.frees),
+      (long)poolstats.cached
+    ));
     // save half-begun XML translations
     XMLTranslationOutgoingEnd();
     XMLTranslationIncomingEnd();
@@ -2793,51 +2808,50 @@ Ret_t TSyncSession::handleStatus(TStatusCommand *aStatusCommandP)
       else {
         bool found=false;
         // status is ok, find matching command
-        TSmlCommandPContainer::iterator pos;
-        for (pos=fStatusWaitCommands.begin(); pos!=fStatusWaitCommands.end(); ++pos) {
-          if ((*pos)->matchStatus(aStatusCommandP)) {
-            PDEBUGPRINTFX(DBG_PROTO,("Found matching command '%s' for Status",(*pos)->getName()));
-            (*pos)->setWaitingForStatus(false); // has received status
-            found=true;
-            if (fIgnoreIncomingCommands) {
-              // ignore statuses, but remove waiting command from queue
-              if ((*pos)->finished()) delete (*pos); // unfinished are owned otherwise and must not be deleted
-              fStatusWaitCommands.erase(pos);
-              PDEBUGPRINTFX(DBG_SESSION,("Status ignored, command considered done -> deleted"));
+        TSmlCommandPContainer::iterator pos=fStatusWaitCommands.find(aStatusCommandP);
+        if (pos!=fStatusWaitCommands.end()) {
+          PDEBUGPRINTFX(DBG_PROTO,("Found matching command '%s' for Status",(*pos)->getName()));
+          (*pos)->setWaitingForStatus(false); // has received status
+          found=true;
+          if (fIgnoreIncomingCommands) {
+            // ignore statuses, but remove waiting command from queue
+            TSmlCommand *cmdP = *pos;
+            fStatusWaitCommands.erase(pos); // before deleting, queue needs the IDs
+            if (cmdP->finished()) delete cmdP; // unfinished are owned otherwise and must not be deleted
+            PDEBUGPRINTFX(DBG_SESSION,("Status ignored, command considered done -> deleted"));
+          }
+          else {
+            // let descendants know when we process a required status
+            if ((*pos)->statusEssential()) {
+              essentialStatusReceived();
             }
-            else {
-              // let descendants know when we process a required status
-              if ((*pos)->statusEssential()) {
-                essentialStatusReceived();
-              }
-              // normally process status
-              if ((*pos)->handleStatus(aStatusCommandP)) {
-                PDEBUGPRINTFX(DBG_SESSION,("Status: processed, removed command '%s' from status wait queue",(*pos)->getName()));
-                // done with command, remove from queue
-                if ((*pos)->finished()) {
-                  // - if this is an interrupted command, make sure to remove pointer
-                  if ((*pos)==fInterruptedCommandP) fInterruptedCommandP=NULL;
-                  // - delete command itself
-                  //   NOTE; if not finished, command is owned otherwise and must
-                  //   persist
-                  PDEBUGPRINTFX(DBG_SESSION,("Status: command '%s' has handled status and allows to be deleted",(*pos)->getName()));
-                  delete (*pos);
-                }
-                else {
-                  PDEBUGPRINTFX(DBG_SESSION,("Status: command '%s' has handled status, but not finished() -> NOT deleted",(*pos)->getName()));
-                }
-                // - anyway, remove from list
-                fStatusWaitCommands.erase(pos);
+            // normally process status
+            if ((*pos)->handleStatus(aStatusCommandP)) {
+              PDEBUGPRINTFX(DBG_SESSION,("Status: processed, removed command '%s' from status wait queue",(*pos)->getName()));
+              // done with command, remove from queue
+              // - anyway, remove from list (before deleting, queue needs the IDs)
+              TSmlCommand *cmdP = *pos;
+              fStatusWaitCommands.erase(pos);
+              if (cmdP->finished()) {
+                // - if this is an interrupted command, make sure to remove pointer
+                if (cmdP==fInterruptedCommandP) fInterruptedCommandP=NULL;
+                // - delete command itself
+                //   NOTE; if not finished, command is owned otherwise and must
+                //   persist
+                PDEBUGPRINTFX(DBG_SESSION,("Status: command '%s' has handled status and allows to be deleted",cmdP->getName()));
+                delete cmdP;
               }
               else {
-                // command not yet acknowledged, keep in queue
-                (*pos)->setWaitingForStatus(true); // is again waiting for a status
-                PDEBUGPRINTFX(DBG_SESSION,("(intermediate) Status processed, command kept in queue, not deleted"));
+                PDEBUGPRINTFX(DBG_SESSION,("Status: command '%s' has handled status, but not finished() -> NOT deleted",cmdP->getName()));
               }
-            } // else normal processing
-            break; // exit for loop (iterator is not ok any more)
-          }
-        } // for
+            }
+            else {
+              // command not yet acknowledged, keep in queue
+              (*pos)->setWaitingForStatus(true); // is again waiting for a status
+              PDEBUGPRINTFX(DBG_SESSION,("(intermediate) Status processed, command kept in queue, not deleted"));
+            }
+          } // else normal processing
+        } // if
         if (!found) {
           // no matching command found
           PDEBUGPRINTFX(DBG_ERROR,("No command found for status -> ignoring"));
@@ -3085,6 +3099,77 @@ void TSyncSession::nextMessageRequest(void)
 
 
 
+// TStatusWaitQueue: commands waiting for a status, indexed by
+// the (MsgID,CmdID) they were sent with
+
+void TStatusWaitQueue::push_back(TSmlCommand *aCmdP)
+{
+  iterator pos = fCommands.insert(fCommands.end(),aCmdP);
+  fIndex.insert(TStatusWaitIndex::value_type(TStatusWaitKey(aCmdP->getMsgID(),aCmdP->getCmdID()),pos));
+} // TStatusWaitQueue::push_back
+
+
+void TStatusWaitQueue::unindex(iterator aPos)
+{
+  TStatusWaitIndex::iterator idx;
+  // - usually, the command still has the IDs it was indexed with
+  std::pair<TStatusWaitIndex::iterator,TStatusWaitIndex::iterator> range =
+    fIndex.equal_range(TStatusWaitKey((*aPos)->getMsgID(),(*aPos)->getCmdID()));
+  for (idx=range.first; idx!=range.second; ++idx) {
+    if (idx->second==aPos) {
+      fIndex.erase(idx);
+      return;
+    }
+  }
+  // - command was re-issued with new IDs while waiting
+  for (idx=fIndex.begin(); idx!=fIndex.end(); ++idx) {
+    if (idx->second==aPos) {
+      fIndex.erase(idx);
+      return;
+    }
+  }
+} // TStatusWaitQueue::unindex
+
+
+TStatusWaitQueue::iterator TStatusWaitQueue::erase(iterator aPos)
+{
+  unindex(aPos);
+  return fCommands.erase(aPos);
+} // TStatusWaitQueue::erase
+
+
+void TStatusWaitQueue::clear(void)
+{
+  fIndex.clear();
+  fCommands.clear();
+} // TStatusWaitQueue::clear
+
+
+TStatusWaitQueue::iterator TStatusWaitQueue::find(TStatusCommand *aStatusCmdP)
+{
+  // candidates with matching IDs, in queue order
+  std::pair<TStatusWaitIndex::iterator,TStatusWaitIndex::iterator> range =
+    fIndex.equal_range(TStatusWaitKey(aStatusCmdP->getRefMsgID(),aStatusCmdP->getRefCmdID()));
+  for (TStatusWaitIndex::iterator idx=range.first; idx!=range.second; ++idx) {
+    if ((*idx->second)->matchStatus(aStatusCmdP))
+      return idx->second;
+  }
+  // not found in index: could be a command which was re-issued with
+  // new IDs after queueing (rare), so check all of them the slow way
+  for (iterator pos=fCommands.begin(); pos!=fCommands.end(); ++pos) {
+    if ((*pos)->matchStatus(aStatusCmdP)) {
+      // re-index with current IDs
+      unindex(pos);
+      fIndex.insert(TStatusWaitIndex::value_type(TStatusWaitKey((*pos)->getMsgID(),(*pos)->getCmdID()),pos));
+      return pos;
+    }
+  }
+  return fCommands.end();
+} // TStatusWaitQueue::find
+
+
+
+
 // check if session must continue (for session-level reasons, that
 // is without regarding sync state of server or client)
 bool TSyncSession::sessionMustContinue(void) {
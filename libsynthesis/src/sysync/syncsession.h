@@ -286,6 +286,39 @@ class TLocalEngineDS;
 typedef std::list<TLocalEngineDS*> TLocalDataStorePContainer; // contains local data stores
 
 
+/// @brief queue of sent commands waiting for status
+/// Can be used like a TSmlCommandPContainer and keeps the commands in the order
+/// in which they were queued, but additionally indexes them by (MsgID,CmdID)
+/// so that finding the command for an incoming status does not need to scan
+/// the entire queue (which made processing a message with many statuses quadratic).
+class TStatusWaitQueue {
+public:
+  typedef TSmlCommandPContainer::iterator iterator;
+  typedef TSmlCommandPContainer::size_type size_type;
+  iterator begin(void) { return fCommands.begin(); };
+  iterator end(void) { return fCommands.end(); };
+  bool empty(void) const { return fCommands.empty(); };
+  size_type size(void) const { return fCommands.size(); };
+  /// @brief add command at the end of the queue, indexed by its current MsgID/CmdID
+  void push_back(TSmlCommand *aCmdP);
+  /// @brief remove command from queue (does not delete the command, must be called before deleting it)
+  iterator erase(iterator aPos);
+  /// @brief remove all commands from queue (does not delete the commands)
+  void clear(void);
+  /// @brief find first queued command the status refers to
+  /// @return end() if no command matches
+  iterator find(TStatusCommand *aStatusCmdP);
+private:
+  // (MsgID,CmdID) -> position in fCommands
+  typedef std::pair<uInt32,uInt32> TStatusWaitKey;
+  typedef std::multimap<TStatusWaitKey,iterator> TStatusWaitIndex;
+  // remove index entry for the command at aPos
+  void unindex(iterator aPos);
+  TSmlCommandPContainer fCommands;
+  TStatusWaitIndex fIndex;
+}; // TStatusWaitQueue
+
+
 // Sync session
 class TSyncSession {
   friend class TSmlCommand;
@@ -678,6 +711,8 @@ public:
   TRemoteDataStore *findRemoteDataStore(const char *aDatastoreURI);
   // Profiling
   TP_DEFINFO(fTPInfo)
+  // - item/field object pool counters at session start
+  TObjectPoolStats fObjectPoolStats;
   // access to config
   TSessionConfig *getSessionConfig(void);
   #ifdef SCRIPT_SUPPORT
@@ -946,7 +981,7 @@ private:
   bool fOutgoingMessageFull; // outgoing message is full, message must be finished and sent
   // context-free command queues
   // - sent commands waiting for status
-  TSmlCommandPContainer fStatusWaitCommands;
+  TStatusWaitQueue fStatusWaitCommands;
   // - received commands that could not be executed immediately
   TSmlCommandPContainer fDelayedExecutionCommands;
   sInt32 fDelayedExecSyncEnds;
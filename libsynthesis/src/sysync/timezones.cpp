@@ -44,6 +44,8 @@
 #include "stringutils.h"
 #include "vtimezone.h"
 
+#include <algorithm>
+
 namespace sysync {
 
 static bool tzcmp  ( const tz_entry &t, const tz_entry &tzi, bool olsonSupport );
@@ -90,6 +92,211 @@ const class tzdata : public std::vector<tz_entry>
 } tz;
 
 
+// name index of the built-in entries: their indices sorted by name (case
+// insensitive), entries with the same name in their original order
+static const class tznameindex : public std::vector<int>
+{
+ public:
+  tznameindex() {
+    for (int i=1; i<(int)tz.size(); i++) {
+      if (!tz[i].name.empty()) push_back(i);
+    }
+    std::stable_sort(begin(), end(), lessByName);
+  }
+
+  // index of first entry named aName, 0 if none
+  int find(cAppCharP aName) const {
+    const_iterator from, to;
+    range(aName, from, to);
+    return from!=to ? *from : 0;
+  }
+
+  // all entries named aName, sorted by index
+  void range(cAppCharP aName, const_iterator &aFrom, const_iterator &aTo) const {
+    size_t lo= 0, hi= size();
+    while (lo<hi) {
+      size_t mid= (lo+hi)/2;
+      if (strucmp(tz[(*this)[mid]].name.c_str(), aName)<0) lo= mid+1;
+      else                                                 hi= mid;
+    }
+    aFrom= begin()+lo;
+    while (lo<size() && strucmp(tz[(*this)[lo]].name.c_str(), aName)==0) lo++;
+    aTo= begin()+lo;
+  }
+
+ private:
+  static bool lessByName(int a, int b) {
+    return strucmp(tz[a].name.c_str(), tz[b].name.c_str())<0;
+  }
+} tzNames;
+
+
+// order of the rules which tzcmp() compares when no name is given:
+// bias first, then DST on/off and, only for DST zones, DST bias and
+// both changes. Zones with the same bias are therefore adjacent, as
+// needed for the offsets only comparison ("o").
+static int ruleOrder( const tz_entry &a, const tz_entry &b )
+{
+  if (a.bias!=b.bias) return a.bias<b.bias ? -1 : 1;
+  bool aIsDst= DSTCond( a );
+  bool bIsDst= DSTCond( b );
+  if (aIsDst!=bIsDst) return aIsDst ? 1 : -1;
+  if (!aIsDst) return 0;
+  if (a.biasDST!=b.biasDST) return a.biasDST<b.biasDST ? -1 : 1;
+  const tChange *ac[2]= { &a.dst, &a.std };
+  const tChange *bc[2]= { &b.dst, &b.std };
+  for (int k=0; k<2; k++) {
+    const tChange &x= *ac[k];
+    const tChange &y= *bc[k];
+    if (x.wMonth    !=y.wMonth    ) return x.wMonth    <y.wMonth     ? -1 : 1;
+    if (x.wDayOfWeek!=y.wDayOfWeek) return x.wDayOfWeek<y.wDayOfWeek ? -1 : 1;
+    if (x.wNth      !=y.wNth      ) return x.wNth      <y.wNth       ? -1 : 1;
+    if (x.wHour     !=y.wHour     ) return x.wHour     <y.wHour      ? -1 : 1;
+    if (x.wMinute   !=y.wMinute   ) return x.wMinute   <y.wMinute    ? -1 : 1;
+  } // for
+  return 0;
+} // ruleOrder
+
+
+// rule index of the built-in entries: their indices sorted by ruleOrder(),
+// entries with the same rules in their original order
+static const class tzruleindex : public std::vector<int>
+{
+ public:
+  tzruleindex() {
+    for (int i=1; i<(int)tz.size(); i++) push_back(i);
+    std::stable_sort(begin(), end(), lessByRules);
+  }
+
+  // range of entries which can match aTZ (with DST already cleared
+  // for specific idents, see FoundTZ()); only the bias is relevant
+  // when comparing offsets only
+  void candidates(const tz_entry &aTZ, bool aBiasOnly,
+                  const_iterator &aFrom, const_iterator &aTo) const {
+    size_t lo= 0, hi= size();
+    while (lo<hi) {
+      size_t mid= (lo+hi)/2;
+      if (cmp(tz[(*this)[mid]], aTZ, aBiasOnly)<0) lo= mid+1;
+      else                                         hi= mid;
+    }
+    aFrom= begin()+lo;
+    hi= size();
+    while (lo<hi) {
+      size_t mid= (lo+hi)/2;
+      if (cmp(tz[(*this)[mid]], aTZ, aBiasOnly)<=0) lo= mid+1;
+      else                                          hi= mid;
+    }
+    aTo= begin()+lo;
+  }
+
+ private:
+  static int cmp(const tz_entry &a, const tz_entry &b, bool aBiasOnly) {
+    if (aBiasOnly) return a.bias<b.bias ? -1 : a.bias>b.bias ? 1 : 0;
+    return ruleOrder(a, b);
+  }
+  static bool lessByRules(int a, int b) {
+    return ruleOrder(tz[a], tz[b])<0;
+  }
+} tzRules;
+
+
+// ---------------------------------------------------------------------------------
+// TZNameIndex
+
+bool TZNameIndex::lessByName(const TEntry &a, const TEntry &b)
+{
+  return strucmp(a.pos->name.c_str(), b.pos->name.c_str())<0;
+} // TZNameIndex::lessByName
+
+
+bool TZNameIndex::update(TZList &aList, int aFirstIndex)
+{
+  TZList::iterator pos;
+  if (fCount==0) pos= aList.begin();
+  else           { pos= fLast; pos++; }
+  bool added= false;
+  while (pos!=aList.end()) {
+    if (!pos->name.empty()) {
+      TEntry e;
+      e.index= aFirstIndex+(int)fCount;
+      e.pos= pos;
+      // insert behind entries with the same name, which have lower indices
+      fEntries.insert(std::upper_bound(fEntries.begin(), fEntries.end(), e, lessByName), e);
+    }
+    fLast= pos;
+    fCount++;
+    added= true;
+    pos++;
+  }
+  return added;
+} // TZNameIndex::update
+
+
+bool TZNameIndex::find(cAppCharP aName, int &aIndex) const
+{
+  size_t lo= 0, hi= fEntries.size();
+  while (lo<hi) {
+    size_t mid= (lo+hi)/2;
+    if (strucmp(fEntries[mid].pos->name.c_str(), aName)<0) lo= mid+1;
+    else                                                   hi= mid;
+  }
+  // same names are sorted by index, so the first not removed one wins
+  for (; lo<fEntries.size() && strucmp(fEntries[lo].pos->name.c_str(), aName)==0; lo++) {
+    if (!(fEntries[lo].pos->ident=="-")) {
+      aIndex= fEntries[lo].index;
+      return true;
+    }
+  }
+  return false;
+} // TZNameIndex::find
+
+
+// ---------------------------------------------------------------------------------
+// TZMatchCache
+
+bool TZMatchCache::sameKey(const TEntry &aEntry, const tz_entry &aTZ, sInt16 aYear)
+{
+  const tz_entry &t= aEntry.tz;
+  return aEntry.year==aYear &&
+         t.bias==aTZ.bias &&
+         t.biasDST==aTZ.biasDST &&
+         memcmp(&t.std, &aTZ.std, sizeof(t.std))==0 &&
+         memcmp(&t.dst, &aTZ.dst, sizeof(t.dst))==0 &&
+         t.name==aTZ.name;
+} // TZMatchCache::sameKey
+
+
+bool TZMatchCache::lookup(const tz_entry &aTZ, sInt16 aYear, bool &aFound, timecontext_t &aContext)
+{
+  for (std::list<TEntry>::iterator pos= fEntries.begin(); pos!=fEntries.end(); pos++) {
+    if (sameKey(*pos, aTZ, aYear)) {
+      aFound= pos->found;
+      aContext= pos->context;
+      // move to front
+      if (pos!=fEntries.begin()) fEntries.splice(fEntries.begin(), fEntries, pos);
+      return true;
+    }
+  }
+  return false;
+} // TZMatchCache::lookup
+
+
+void TZMatchCache::store(const tz_entry &aTZ, sInt16 aYear, bool aFound, timecontext_t aContext)
+{
+  TEntry e;
+  e.tz.name= aTZ.name;
+  e.tz.bias= aTZ.bias;
+  e.tz.biasDST= aTZ.biasDST;
+  e.tz.std= aTZ.std;
+  e.tz.dst= aTZ.dst;
+  e.year= aYear;
+  e.found= aFound;
+  e.context= aContext;
+  fEntries.push_front(e);
+  if (fEntries.size()>maxEntries) fEntries.pop_back();
+} // TZMatchCache::store
+
+
 // ---------------------------------------------------------------------------------
 // GZones
 
@@ -227,15 +434,63 @@ bool GZones::matchTZ(const tz_entry &aTZ, TDebugLogger *aLogP, timecontext_t &aC
         return false;
       }
     } // result
-  }
+  };
 
-  c(aTZ, aLogP, this);
+  // The result only depends on name and rules of aTZ, the current year and
+  // the list of zones, so recent results remain valid as long as no zones
+  // were added, removed or reactivated.
+  sInt16 year= MyYear(this);
+  bool found;
+  #ifdef MUTEX_SUPPORT
+    lockMutex(muP);
+  #endif
+  if (fNameIndex.update(tzP, tctx_numtimezones) || fIndexedChangeCount!=fChangeCount) {
+    fMatchCache.clear();
+    fIndexedChangeCount= fChangeCount;
+  }
+  bool cached= fMatchCache.lookup(aTZ, year, found, aContext);
+  #ifdef MUTEX_SUPPORT
+    unlockMutex(muP);
+  #endif
+  if (cached) {
+    PLOGDEBUGPRINTFX(aLogP, DBG_PARSE+DBG_EXOTIC,
+                     ("matchTZ %s: cached result", aTZ.name.c_str()));
+    return found;
+  }
 
+  comparison c(aTZ, aLogP, this);
   foreachTZ(c);
+  found= c.result(aContext);
 
-  return c.result(aContext);
+  #ifdef MUTEX_SUPPORT
+    lockMutex(muP);
+  #endif
+  fMatchCache.store(aTZ, year, found, aContext);
+  #ifdef MUTEX_SUPPORT
+    unlockMutex(muP);
+  #endif
+  return found;
 } // matchTZ
 
+
+bool GZones::findByName(cAppCharP aName, timecontext_t &aContext)
+{
+  int i= tzNames.find(aName);
+  if (i==0) {
+    #ifdef MUTEX_SUPPORT
+      lockMutex(muP);
+    #endif
+    fNameIndex.update(tzP, tctx_numtimezones);
+    if (!fNameIndex.find(aName, i)) i= 0;
+    #ifdef MUTEX_SUPPORT
+      unlockMutex(muP);
+    #endif
+  }
+  if (i==0) return false;
+  aContext= TCTX_ENUMCONTEXT(i);
+  return true;
+} // findByName
+
 bool GZones::foreachTZ(visitor &v)
 {
   int  i; // visit hard coded elements first
@@ -649,6 +904,42 @@ static bool YearFit( const tz_entry &t, const tz_entry &tzi, GZones* g )
 
 
 
+/*  Returns the index of the first hard coded entry behind <aOffs> which
+ *  matches <t> (see FoundTZ), 0 if there is none. Only entries which can
+ *  match according to the name or rule index are compared.
+ */
+static int FindBuiltinTZ( const tz_entry &t, GZones* g, int aOffs, bool olsonSupport )
+{
+  int i;
+  if (olsonSupport && !t.name.empty()) {
+    // name might also be a location, which is not indexed
+    for (i= aOffs+1; i<(int)tctx_numtimezones; i++) {
+      const tz_entry &tzi = tz[ i ];
+      if (tzcmp  ( t, tzi, olsonSupport ) &&
+          YearFit( t, tzi, g )) return i;
+    } // for
+    return 0;
+  } // if
+
+  std::vector<int>::const_iterator from, to;
+  if (!t.name.empty()) tzNames.range   ( t.name.c_str(), from, to );
+  else                 tzRules.candidates( t, t.ident=="o", from, to );
+
+  // candidates with the same bias but different rules are not sorted
+  // by index, so look at all of them
+  int found= 0;
+  for (; from!=to; from++) {
+    i= *from;
+    if (i<=aOffs || (found!=0 && i>found)) continue;
+    const tz_entry &tzi = tz[ i ];
+    if (tzcmp  ( t, tzi, olsonSupport ) &&
+        YearFit( t, tzi, g )) found= i;
+  } // for
+  return found;
+} // FindBuiltinTZ
+
+
+
 /*  Returns true, if the given TZ is existing already
  *    <t>            tz_entry to search for:
  *                   If <t.name> == "" search for any entry with these values.
@@ -690,16 +981,13 @@ bool FoundTZ( const tz_entry &tc,
     ClrDST  ( t );
   } // if
 
-  int  i; // search hard coded elements first
-  for (i= offs+1; i<(int)tctx_numtimezones; i++) {
-    const tz_entry &tzi = tz[ i ];
-    if (tzcmp  ( t, tzi, olsonSupport ) &&
-        YearFit( t, tzi, g )) {
-      aName=        tzi.name;
-    //printf( "name='%s' i=%d\n", aName.c_str(), i );
-      ok   = true; break;
-    } // if
-  } // for
+  int  i= FindBuiltinTZ( t, g, offs, olsonSupport ); // search hard coded elements first
+  if (i!=0) {
+    aName= tz[ i ].name;
+  //printf( "name='%s' i=%d\n", aName.c_str(), i );
+    ok   = true;
+  }
+  else i= tctx_numtimezones;
 
 //printf( "ok=%d name='%s' i=%d olson=%d\n", ok, aName.c_str(), i, olsonSupport );
 
@@ -740,6 +1028,7 @@ bool FoundTZ( const tz_entry &tc,
             pos->ident == "-" && // removed element ?
             tzcmp( t, *pos, olsonSupport )) {
           pos->ident= t.ident; // reactivate the identifier
+          g->zonesChanged();
           aName = pos->name;  // should be the same
           ok    = true; break;
         } // if
@@ -794,6 +1083,7 @@ bool RemoveTZ( const tz_entry &t, GZones* g )
     if (!(pos->ident=="-") && // element must not be removed
         tzcmp( t, *pos, olsonSupport )) {
       pos->ident = "-";
+      g->zonesChanged();
     //gz()->tzP.erase( pos ); // do not remove it, keep it persistent
       ok= true; break;
     } // if
@@ -837,7 +1127,17 @@ bool TimeZoneNameToContext( cAppCharP aName, timecontext_t &aContext, GZones* g,
   t.dynYear= "";    // luz: must be initialized!
 
   string          tName;
-  if (FoundTZ( t, tName, aContext, g, olsonSupport )) return true;
+  if (!olsonSupport) {
+    // name only search, same result as FoundTZ(), but indexed
+    if (g!=NULL) {
+      if (g->findByName( aName, aContext )) return true;
+    }
+    else {
+      int i= tzNames.find( aName );
+      if (i!=0) { aContext= TCTX_ENUMCONTEXT( i ); return true; }
+    }
+  }
+  else if (FoundTZ( t, tName, aContext, g, olsonSupport )) return true;
 
   /*
   int  i;     aContext= TCTX_UNKNOWN;
@@ -206,6 +206,77 @@ void ClrDST( tz_entry &t );
 
 typedef std::list<tz_entry> TZList;
 
+
+/*! @brief name index of the additional time zones of a GZones object
+ *
+ *  Entries are never erased from GZones::tzP (removed zones are only
+ *  marked with ident "-"), so the index only has to catch up with the
+ *  entries appended since the last update(). A copy starts out empty,
+ *  because the index refers to the list of the original object.
+ */
+class TZNameIndex {
+  public:
+    TZNameIndex() { clear(); }
+    TZNameIndex(const TZNameIndex &) { clear(); }
+    TZNameIndex &operator=(const TZNameIndex &) { clear(); return *this; }
+
+    void clear() { fEntries.clear(); fCount= 0; }
+
+    /// add entries appended to aList since the last call
+    /// @param aFirstIndex context index of the first entry in aList
+    /// @return true if new entries were found
+    bool update(TZList &aList, int aFirstIndex);
+
+    /// find first entry named aName (case insensitive) which is not removed
+    /// @return true if found, aIndex is its context index then
+    bool find(cAppCharP aName, int &aIndex) const;
+
+  private:
+    typedef struct {
+      int index;            // context index of the entry
+      TZList::iterator pos; // the entry itself
+    } TEntry;
+    static bool lessByName(const TEntry &a, const TEntry &b);
+    std::vector<TEntry> fEntries; // sorted by name, same names by index
+    size_t fCount;                // number of list entries indexed so far
+    TZList::iterator fLast;       // last entry indexed, valid if fCount>0
+}; // TZNameIndex
+
+
+/*! @brief recent results of GZones::matchTZ()
+ *
+ *  Parsing a batch of items usually matches the same few VTIMEZONEs over
+ *  and over again, so a handful of entries suffices. Like TZNameIndex,
+ *  copies start out empty.
+ */
+class TZMatchCache {
+  public:
+    enum { maxEntries = 16 };
+
+    TZMatchCache() {}
+    TZMatchCache(const TZMatchCache &) {}
+    TZMatchCache &operator=(const TZMatchCache &) { clear(); return *this; }
+
+    void clear() { fEntries.clear(); }
+
+    /// look up result for name and rules of aTZ in aYear
+    /// @return true if cached, aFound/aContext are set then
+    bool lookup(const tz_entry &aTZ, sInt16 aYear, bool &aFound, timecontext_t &aContext);
+    /// remember result for name and rules of aTZ in aYear
+    void store(const tz_entry &aTZ, sInt16 aYear, bool aFound, timecontext_t aContext);
+
+  private:
+    typedef struct {
+      tz_entry tz;           // name and rules which were matched
+      sInt16 year;           // year the rules were matched for
+      bool found;
+      timecontext_t context;
+    } TEntry;
+    static bool sameKey(const TEntry &aEntry, const tz_entry &aTZ, sInt16 aYear);
+    std::list<TEntry> fEntries; // most recently used first
+}; // TZMatchCache
+
+
 class GZones {
   public:
     GZones() {
@@ -217,6 +288,8 @@ class GZones {
       sysTZ= predefinedSysTZ; // default to predefined zone, if none, this will be obtained from OS APIs
       isDbg= false; // !!! IMPORTANT: do NOT enable this except for test targets, as it leads to recursions (debugPrintf calls time routines!)
       fSystemZoneDefinitionsFinalized = false;
+      fChangeCount = 0;
+      fIndexedChangeCount = 0;
 
       #ifdef SYDEBUG
         getDbgMask  = 0;
@@ -286,6 +359,20 @@ class GZones {
      */
     bool foreachTZ(visitor &v);
 
+    /*! @brief find time zone by name (case insensitive)
+     *
+     * Same result as FoundTZ() with ident "?" and without olson
+     * support: the first built-in zone with that name, otherwise the
+     * first additional zone with that name which is not removed.
+     * Uses name indexes instead of comparing all entries.
+     *
+     * @return true if found
+     */
+    bool findByName(cAppCharP aName, timecontext_t &aContext);
+
+    /// must be called when additional zones are removed or reactivated
+    void zonesChanged() { fChangeCount++; }
+
     void ResetCache(void) {
       sysTZ= predefinedSysTZ; // reset cached system time zone to make sure it is re-evaluated
     }
@@ -300,6 +387,11 @@ class GZones {
     bool                    isDbg; // write debug information
     bool fSystemZoneDefinitionsFinalized; // finalizeSystemZoneDefinitions() already called
 
+    TZNameIndex        fNameIndex; // name index of tzP
+    TZMatchCache      fMatchCache; // recent matchTZ() results
+    uInt32           fChangeCount; // incremented by zonesChanged()
+    uInt32    fIndexedChangeCount; // fChangeCount when fMatchCache was last validated
+
     #ifdef SYDEBUG
       uInt32        getDbgMask; // allow debugging in a specific context
       TDebugLogger* getDbgLogger;
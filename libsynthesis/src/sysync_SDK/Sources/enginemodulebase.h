@@ -401,6 +401,14 @@ void SySyncDebugPuts(void* aCB,
                      int aDbgLevel, cAppCharP aLinePrefix,
                      cAppCharP aText);
 
+/**
+ * Writes out debug output which is still buffered in memory by log
+ * files in "async" logflushmode. Meant to be called from signal
+ * handlers before aborting the process, therefore does not wait
+ * for other threads indefinitely.
+ */
+void SySyncDebugFlush();
+
 
 // factory function declarations - must be implemented in the source file of the leaf derivates of TEngineInterface
 #ifdef SYSYNC_CLIENT
@@ -21,6 +21,27 @@ static const char table [64] = {
   'w','x','y','z','0','1','2','3','4','5','6','7','8','9','+','/'
 };
 
+// value of each char in B64 input: 0..63 for the B64 alphabet,
+// -2 for the '=' padding, -1 for all chars which are ignored
+static const sInt8 values [256] = {
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,63,
+  52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-2,-1,-1,
+  -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,
+  15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,
+  -1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
+  41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+  -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+};
+
 
 // free memory allocated with encode or decode above
 void b64::free(void *mem)
@@ -66,7 +87,8 @@ char *b64::encode (const uInt8 *instr, uInt32 len, uInt32 *outlenP, sInt16 maxLi
   }
 
   outstr = (char *)malloc(outlen*sizeof(char));
-  memset(outstr,0,outlen);
+  if (!outstr) return NULL;
+  // no need to clear the buffer, all of it up to the terminating NUL gets written below
 
   linechars=0;
   o_off=0;
@@ -75,14 +97,13 @@ char *b64::encode (const uInt8 *instr, uInt32 len, uInt32 *outlenP, sInt16 maxLi
     i_off = i*3;
     // o_off = i*4; %%% not ok as there might be line ends in between
 
-    inbuf[0] = instr[i_off];
-    inbuf[1] = instr[i_off+1];
-    inbuf[2] = instr[i_off+2];
+    // all three bytes at once
+    uInt32 bits = (instr[i_off] << 16) | (instr[i_off+1] << 8) | instr[i_off+2];
 
-    outstr[o_off++] = table[(inbuf [0] & 0xFC) >> 2];
-    outstr[o_off++] = table[((inbuf [0] & 0x03) << 4) | ((inbuf [1] & 0xF0) >> 4)];
-    outstr[o_off++] = table[((inbuf [1] & 0x0F) << 2) | ((inbuf [2] & 0xC0) >> 6)];
-    outstr[o_off++] = table[inbuf [2] & 0x3F];
+    outstr[o_off++] = table[bits >> 18];
+    outstr[o_off++] = table[(bits >> 12) & 0x3F];
+    outstr[o_off++] = table[(bits >> 6) & 0x3F];
+    outstr[o_off++] = table[bits & 0x3F];
 
     // check line wrapping
     linechars+=4;
@@ -130,7 +151,9 @@ char *b64::encode (const uInt8 *instr, uInt32 len, uInt32 *outlenP, sInt16 maxLi
   // output length is either size of all complete quadruples including line feeds (o_off) or 4 more if
   // input was not evenly divisible by 3
   // (%%% luz added case for inover<>0, which produced 4 NULLs at end of string on inover==0)
-  if (outlenP) *outlenP = o_off+ (inover==0 ? 0 : 4);
+  if (inover) o_off+=4;
+  outstr[o_off]=0; // make it a C string
+  if (outlenP) *outlenP = o_off;
 
   return(outstr);
 }
@@ -144,7 +167,7 @@ uInt8 *b64::decode(const char *instr, uInt32 len, uInt32 *outlenP)
   sInt16 quadi;
   bool done;
   const char *p;
-  char c=0;
+  sInt8 c=0; // signed, also where char is unsigned
   uInt8 *outstr,*q;
 
   // get length if not passed as argument
@@ -166,6 +189,18 @@ uInt8 *b64::decode(const char *instr, uInt32 len, uInt32 *outlenP)
   done=false; // not done yet
 
   while (!done) {
+    // fast path: complete quads without any chars to ignore or padding
+    if (quadi==0) {
+      while (n+4<=len) {
+        sInt8 v0=values[(uInt8)p[0]], v1=values[(uInt8)p[1]], v2=values[(uInt8)p[2]], v3=values[(uInt8)p[3]];
+        if ((v0|v1|v2|v3)<0) break; // not a plain quad, process char by char
+        *q++ = (v0 << 2) | (v1 >> 4);
+        *q++ = ((v1 & 0x0F) << 4) | (v2 >> 2);
+        *q++ = ((v2 & 0x03) << 6) | v3;
+        p+=4;
+        n+=4;
+      }
+    }
     if (n<len) {
       // init new quad if needed
       if (quadi==0) {
@@ -176,21 +211,12 @@ uInt8 *b64::decode(const char *instr, uInt32 len, uInt32 *outlenP)
       c=*p++;
       n++;
       // process char
-      if ((c >= 'A') && (c <= 'Z'))
-        c = c - 'A';
-      else if ((c >= 'a') && (c <= 'z'))
-        c = c - 'a' + 26;
-      else if ((c >= '0') && (c <= '9'))
-        c = c - '0' + 52;
-      else if (c == '+')
-        c = 62;
-      else if (c == '/')
-        c = 63;
-      else if (c == '=') {
+      c = values[(uInt8)c];
+      if (c == -2) {
         // reaching a "=" is like end of data
         done=true;
       }
-      else
+      else if (c < 0)
         continue; // ignore all others
     }
     else
@@ -635,7 +635,13 @@ const char *appendDecoded(
   switch (aEncoding) {
     case enc_quoted_printable :
       // decode quoted-printable content
-      while ((c=*p++)) {
+      while (true) {
+        // copy everything up to the next escape in one step
+        const char *e=strchr(p,'=');
+        if (!e) e=p+strlen(p);
+        aBinString.append(p,e-p);
+        p=e;
+        if ((c=*p++)==0) break;
         // char found
         if (c=='=') {
           uInt16 code;
@@ -679,11 +685,12 @@ const char *appendDecoded(
       break;
     case enc_7bit:
     case enc_8bit:
-      // copy no more than size
-      if (aSize>0) aBinString.reserve(aBinString.size()+aSize);
-      while (*p && aSize>0) {
-        aBinString+=*p++;
-        aSize--;
+      // copy no more than size, stop at NUL
+      if (aSize>0) {
+        const char *e=(const char *)memchr(p,0,aSize);
+        if (e) aSize=e-p;
+        aBinString.append(p,aSize);
+        p+=aSize;
       }
       aText=p;
       break;
@@ -735,7 +742,26 @@ void appendEncoded(
       // - determine start of last line in aString
       //   Note: this is because property text will be folded when lines aMaxLineSize
       linestart=aString.size()-aCurrLineSize;
+      // usually most chars are copied unencoded
+      if (aString.size()+aSize>aString.capacity())
+        aString.reserve(aString.size()+aSize);
       for (p=aBinary;p<aBinary+aSize;p++) { // '\0' will not terminate the 'for' loop
+        // copy a run of chars which need no encoding in one step,
+        // but only as far as the line is guaranteed to not need a soft break
+        if (!aMaxLineSize || aString.size()-linestart<string::size_type(aMaxLineSize)-8) {
+          const uInt8 *run=p;
+          const uInt8 *runend=aBinary+aSize;
+          if (aMaxLineSize) {
+            string::size_type room=string::size_type(aMaxLineSize)-8-(aString.size()-linestart);
+            if (string::size_type(runend-p)>room) runend=p+room;
+          }
+          while (p<runend && *p>=0x20 && *p<=0x7F && *p!='=' && !(*p=='<' && aEncodeBinary))
+            p++;
+          if (p>run) {
+            aString.append((const char *)run,p-run);
+            if (p>=aBinary+aSize) break;
+          }
+        }
         c=*p;
         if (!aEncodeBinary && !c) break; // still exit at NUL when not encoding real binary data
         processed=false; // input data in c is not yet processed
@@ -900,6 +926,15 @@ uInt16 appendCharsAsUTF8(const char *aChars, string &aVal, TCharSets aCharSet, u
 
 
 
+// reserve room for aNumBytes more bytes in aVal
+// - only grows, so that repeated appends keep the exponential growth of string
+static inline void reserveMore(string &aVal, size_t aNumBytes)
+{
+  if (aVal.size()+aNumBytes>aVal.capacity())
+    aVal.reserve(aVal.size()+aNumBytes);
+} // reserveMore
+
+
 // add string as UTF8 to value and apply charset translation if needed
 // - if lineEndMode is not lem_none, all sorts of line ends will be converted
 //   to the specified mode.
@@ -908,7 +943,20 @@ void appendStringAsUTF8(const char *s, string &aVal, TCharSets aCharSet, TLineEn
   char c;
   const char *start=s;
   if (s) {
-    while ((c=*s++)!=0) {
+    // usually, the result is as long as the input
+    reserveMore(aVal,strlen(s));
+    while (true) {
+      // copy runs of chars which need neither charset nor line end conversion
+      // in one step: all chars for UTF8, 7-bit chars for all other charsets
+      const char *run=s;
+      uInt8 u;
+      while ((u=*s)!=0 &&
+             (aCharSet==chs_utf8 || u<0x80) &&
+             (aLEM==lem_none || (u!=0x0D && u!=0x0A && (u!=0x0B || !aAllowFilemakerCR))))
+        s++;
+      if (s>run) aVal.append(run,s-run);
+      // now process next char individually
+      if ((c=*s++)==0) break;
       if (aLEM!=lem_none) {
         // line end handling enabled
         if (c==0x0D) {
@@ -1022,6 +1070,24 @@ static void appendCharToString(
 } // appendCharToString
 
 
+// true if appendCharToString() appends c unchanged
+static inline bool isUnquotedChar(uInt8 c, TQuotingModes aQuotingMode)
+{
+  switch (aQuotingMode) {
+    case qm_none:
+      return true;
+    case qm_backslash:
+      return c!=0x0D && c!=0x0A && c!=0x08 && c!=0x09 && c!='"' && c!='\'' && c!='\\';
+    case qm_duplsingle:
+      return c!='\'';
+    case qm_dupldouble:
+      return c!='"';
+    default:
+      return false;
+  }
+} // isUnquotedChar
+
+
 // add UTF8 string to value in custom charset
 // - if aLEM is not lem_none, occurrence of any type of Linefeeds
 //   (LF,CR,CRLF and even CRCRLF) in input string will be
@@ -1045,18 +1111,36 @@ bool appendUTF8ToString(
   cAppCharP start=aUTF8;
 
   if (!aUTF8) return true; // nothing to copy, copied everything of that!
+  size_t len=strlen(aUTF8);
+  if (aMaxBytes && aMaxBytes<len) len=aMaxBytes;
+  // usually, the result is as long as the input
+  reserveMore(aVal,len);
   if (aCharSet==chs_utf8 && aLEM==lem_none && aQuotingMode==qm_none) {
-    // shortcut: simply append entire string
-    if (aMaxBytes==0)
-      aVal+=aUTF8;
-    else
-      aVal.append(aUTF8,aMaxBytes);
+    // shortcut: simply append entire string (or as much as allowed)
+    aVal.append(aUTF8,len);
     // advance "processed" pointer behind consumed part of string
-    p=aUTF8+aVal.size();
+    p=aUTF8+len;
   }
   else {
     // process char by char
     while((c=*aUTF8)!=0 && (aMaxBytes==0 || n<aMaxBytes)) {
+      // copy runs of chars which need no conversion and no quoting
+      // in one step: all chars for UTF8, 7-bit chars for all other charsets
+      cAppCharP run=aUTF8;
+      size_t room=aMaxBytes ? aMaxBytes-n : len;
+      while (room>0 && (c=*aUTF8)!=0 &&
+             (aCharSet==chs_utf8 || c<0x80) &&
+             (aLEM==lem_none || (c!=0x0D && c!=0x0A)) &&
+             isUnquotedChar(c,aQuotingMode)) {
+        aUTF8++;
+        room--;
+      }
+      if (aUTF8>run) {
+        aVal.append(run,aUTF8-run);
+        n+=aUTF8-run;
+        p=aUTF8;
+        continue; // check end and limit again
+      }
       p=aUTF8;
       // check for linefeed conversion
       if (aLEM!=lem_none && (c==0x0D || c==0x0A)) {
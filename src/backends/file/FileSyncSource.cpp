@@ -58,6 +58,9 @@ FileSyncSource::FileSyncSource(const SyncSourceParams &params,
     if (dataformat.empty()) {
         throwError("a database format must be specified");
     }
+    // listAllItems() only reads the directory and m_entryCounter is
+    // not used before change detection
+    enablePrefetch(m_operations);
 }
 
 std::string FileSyncSource::getMimeType() const
@@ -10,10 +10,14 @@
 #include <syncevo/icalstrdup.h>
 
 #include "CalDAVSource.h"
+#include "test.h"
 
 #include <boost/bind.hpp>
 #include <boost/algorithm/string/replace.hpp>
 
+#include <algorithm>
+#include <errno.h>
+
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
 
@@ -54,6 +58,15 @@ CalDAVSource::CalDAVSource(const SyncSourceParams &params,
                                             this, _1, _2, _3);
     m_operations.m_restoreData = boost::bind(&CalDAVSource::restoreData,
                                              this, _1, _2, _3);
+    m_cache.m_maxSize = (size_t)CalDAVCacheLimit().getPropertyValue(*getNode(CalDAVCacheLimit())) * 1024;
+}
+
+void CalDAVSource::endSubSync(bool success)
+{
+    m_cache.logStats();
+    if (success) {
+        storeServerInfos();
+    }
 }
 
 void CalDAVSource::listAllSubItems(SubRevisionMap_t &revisions)
@@ -364,8 +377,12 @@ int CalDAVSource::appendItem(SubRevisionMap_t &revisions,
              comp = icalcomponent_get_next_component(calendar, ICAL_VEVENT_COMPONENT)) {
         }
         event->m_calendar = calendar;
+        event->m_size = data.size();
 #endif
         m_cache.insert(make_pair(davLUID, event));
+#ifndef SHORT_ALL_SUB_ITEMS_DATA
+        m_cache.loaded(*event);
+#endif
     }
 
     // reset data for next item
@@ -410,6 +427,7 @@ SubSyncSource::SubItemResult CalDAVSource::insertSubItem(const std::string &luid
     boost::shared_ptr<Event> newEvent(new Event);
     newEvent->m_calendar.set(icalcomponent_new_from_string((char *)item.c_str()), // hack for old libical
                              "parsing iCalendar 2.0");
+    newEvent->m_size = item.size();
     struct icaltimetype lastmodtime = icaltime_null_time();
     icalcomponent *firstcomp = NULL;
     for (icalcomponent *comp = firstcomp = icalcomponent_get_first_component(newEvent->m_calendar, ICAL_VEVENT_COMPONENT);
@@ -535,6 +553,7 @@ SubSyncSource::SubItemResult CalDAVSource::insertSubItem(const std::string &luid
             }
             icalcomponent_merge_component(event.m_calendar,
                                           newEvent->m_calendar.release()); // function destroys merged calendar
+            event.m_size += newEvent->m_size;
         } else {
             // Google Calendar adds a default alarm each time a VEVENT is added
             // anew. Avoid that by resending our data if necessary (= no alarm set).
@@ -1153,7 +1172,7 @@ int CalDAVSource::storeItem(const std::string &wantedLuid,
 
 CalDAVSource::Event &CalDAVSource::loadItem(Event &event)
 {
-    if (!event.m_calendar) {
+    if (!m_cache.load(event)) {
         std::string item;
         try {
             readItem(event.m_DAVluid, item, true);
@@ -1241,6 +1260,7 @@ CalDAVSource::Event &CalDAVSource::loadItem(Event &event)
         event.m_calendar.set(icalcomponent_new_from_string((char *)item.c_str()), // hack for old libical
                              "parsing iCalendar 2.0");
         Event::fixIncomingCalendar(event.m_calendar.get());
+        event.m_size = item.size();
 
         // Sequence number/last-modified might have been increased by last save.
         // Or the cache was populated by setAllSubItems(), which doesn't give
@@ -1265,6 +1285,7 @@ CalDAVSource::Event &CalDAVSource::loadItem(Event &event)
                 }
             }
         }
+        m_cache.loaded(event);
     }
     return event;
 }
@@ -1409,6 +1430,133 @@ CalDAVSource::EventCache::iterator CalDAVSource::EventCache::findByUID(const std
     return end();
 }
 
+CalDAVSource::EventCache::EventCache() :
+    m_initialized(false),
+    m_maxSize(16 * 1024 * 1024),
+    m_loadedSize(0),
+    m_useCounter(0),
+    m_peakSize(0),
+    m_spilled(0),
+    m_unspilled(0)
+{
+}
+
+void CalDAVSource::EventCache::loaded(Event &event)
+{
+    touch(event);
+    // Only count; the actual size is determined by limitSize()
+    // because calendars also get freed or replaced elsewhere.
+    m_loadedSize += event.m_size;
+    if (m_maxSize && m_loadedSize > m_maxSize) {
+        limitSize(event);
+    }
+}
+
+bool CalDAVSource::EventCache::load(Event &event)
+{
+    if (event.m_calendar) {
+        touch(event);
+    } else if (event.m_spillOffset >= 0) {
+        // dropped earlier to save memory, no need to ask the server again
+        unspill(event);
+        loaded(event);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void CalDAVSource::EventCache::limitSize(const Event &keep)
+{
+    std::vector< std::pair<unsigned long, Event *> > candidates;
+    size_t size = keep.m_size;
+    BOOST_FOREACH(const value_type &entry, *this) {
+        Event *event = entry.second.get();
+        if (event->m_calendar && event != &keep) {
+            size += event->m_size;
+            candidates.push_back(std::make_pair(event->m_lastUsed, event));
+        }
+    }
+    if (size > m_peakSize) {
+        m_peakSize = size;
+    }
+    if (size > m_maxSize) {
+        // Drop least recently used calendars until there is room for
+        // a quarter of the limit, so that this scan does not happen
+        // for every single item.
+        std::sort(candidates.begin(), candidates.end());
+        size_t target = m_maxSize / 4 * 3;
+        for (size_t i = 0; i < candidates.size() && size > target; i++) {
+            Event *event = candidates[i].second;
+            size -= event->m_size;
+            spill(*event);
+        }
+        SE_LOG_DEBUG(NULL, NULL, "CalDAV cache: reduced parsed items to %lu KB, limit %lu KB, %lu items spilled so far",
+                     (unsigned long)(size / 1024),
+                     (unsigned long)(m_maxSize / 1024),
+                     m_spilled);
+    }
+    m_loadedSize = size;
+}
+
+void CalDAVSource::EventCache::spill(Event &event)
+{
+    if (!m_spillFile) {
+        FILE *file = tmpfile();
+        if (!file) {
+            SE_THROW(StringPrintf("creating temporary file for CalDAV cache: %s", strerror(errno)));
+        }
+        m_spillFile.reset(file, fclose);
+    }
+    eptr<char> icalstr(ical_strdup(icalcomponent_as_ical_string(event.m_calendar)));
+    size_t len = strlen(icalstr.get());
+    if (fseek(m_spillFile.get(), 0, SEEK_END) ||
+        fwrite(icalstr.get(), 1, len, m_spillFile.get()) != len) {
+        SE_THROW(StringPrintf("writing temporary file for CalDAV cache: %s", strerror(errno)));
+    }
+    event.m_spillSize = len;
+    event.m_spillOffset = ftell(m_spillFile.get()) - len;
+    event.m_calendar.set(NULL);
+    m_spilled++;
+}
+
+void CalDAVSource::EventCache::unspill(Event &event)
+{
+    std::string item;
+    item.resize(event.m_spillSize);
+    if (fseek(m_spillFile.get(), event.m_spillOffset, SEEK_SET) ||
+        fread(&item[0], 1, item.size(), m_spillFile.get()) != item.size()) {
+        SE_THROW(StringPrintf("reading temporary file for CalDAV cache: %s", strerror(errno)));
+    }
+    // The in-memory calendar is the current one from now on.
+    event.m_spillOffset = -1;
+    event.m_spillSize = 0;
+    event.m_calendar.set(icalcomponent_new_from_string((char *)item.c_str()), // hack for old libical
+                         "parsing spilled iCalendar 2.0");
+    event.m_size = item.size();
+    m_unspilled++;
+}
+
+void CalDAVSource::EventCache::logStats()
+{
+    size_t current = 0;
+    BOOST_FOREACH(const value_type &entry, *this) {
+        if (entry.second->m_calendar) {
+            current += entry.second->m_size;
+        }
+    }
+    if (current > m_peakSize) {
+        m_peakSize = current;
+    }
+    SE_LOG_DEBUG(NULL, NULL, "CalDAV cache: %lu items, parsed items %lu KB, peak %lu KB, limit %lu KB, %lu spilled, %lu loaded again",
+                 (unsigned long)size(),
+                 (unsigned long)(current / 1024),
+                 (unsigned long)(m_peakSize / 1024),
+                 (unsigned long)(m_maxSize / 1024),
+                 m_spilled,
+                 m_unspilled);
+}
+
 void CalDAVSource::backupData(const SyncSource::Operations::ConstBackupInfo &oldBackup,
                               const SyncSource::Operations::BackupInfo &newBackup,
                               BackupReport &backupReport)
@@ -1502,6 +1650,124 @@ bool CalDAVSource::typeMatches(const StringMap &props) const
     }
 }
 
+#ifdef ENABLE_UNIT_TESTS
+
+class CalDAVCacheTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(CalDAVCacheTest);
+    CPPUNIT_TEST(testSpill);
+    CPPUNIT_TEST(testUnlimited);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    typedef CalDAVSource::Event Event;
+    typedef CalDAVSource::EventCache EventCache;
+
+    static std::string createItem(int nr, const std::string &summary) {
+        return StringPrintf("BEGIN:VCALENDAR\r\n"
+                            "VERSION:2.0\r\n"
+                            "BEGIN:VEVENT\r\n"
+                            "UID:caldav-cache-test-%d\r\n"
+                            "DTSTART:20120101T100000Z\r\n"
+                            "SUMMARY:%s\r\n"
+                            "END:VEVENT\r\n"
+                            "END:VCALENDAR\r\n",
+                            nr, summary.c_str());
+    }
+
+    /** parse and add to cache, like CalDAVSource::appendItem() */
+    static void addItem(EventCache &cache, int nr) {
+        std::string item = createItem(nr, StringPrintf("item %d", nr));
+        boost::shared_ptr<Event> event(new Event);
+        event->m_DAVluid = StringPrintf("%d.ics", nr);
+        event->m_UID = StringPrintf("caldav-cache-test-%d", nr);
+        event->m_calendar.set(icalcomponent_new_from_string((char *)item.c_str()), // hack for old libical
+                              "parsing iCalendar 2.0");
+        event->m_size = item.size();
+        cache.insert(std::make_pair(event->m_DAVluid, event));
+        cache.loaded(*event);
+    }
+
+    static Event &getItem(EventCache &cache, int nr) {
+        EventCache::iterator it = cache.find(StringPrintf("%d.ics", nr));
+        CPPUNIT_ASSERT(it != cache.end());
+        return *it->second;
+    }
+
+    static int countSpilled(EventCache &cache) {
+        int spilled = 0;
+        BOOST_FOREACH(const EventCache::value_type &entry, cache) {
+            if (!entry.second->m_calendar) {
+                CPPUNIT_ASSERT(entry.second->m_spillOffset >= 0);
+                spilled++;
+            }
+        }
+        return spilled;
+    }
+
+    static std::string getSummary(Event &event) {
+        CPPUNIT_ASSERT(event.m_calendar);
+        const char *summary = icalcomponent_get_summary(event.m_calendar);
+        return summary ? summary : "";
+    }
+
+    void testSpill() {
+        static const int numItems = 20;
+        EventCache cache;
+        // room for about four items
+        cache.m_maxSize = createItem(0, "item 0").size() * 4 + 1;
+        for (int i = 0; i < numItems; i++) {
+            addItem(cache, i);
+        }
+        CPPUNIT_ASSERT_EQUAL(numItems, (int)cache.size());
+        int spilled = countSpilled(cache);
+        CPPUNIT_ASSERT(spilled >= numItems - 4);
+        CPPUNIT_ASSERT(spilled < numItems);
+        // most recent item must have been kept, oldest one dropped
+        CPPUNIT_ASSERT(getItem(cache, numItems - 1).m_calendar);
+        CPPUNIT_ASSERT(!getItem(cache, 0).m_calendar);
+
+        // Load spilled items again and modify every second one, as
+        // CalDAVSource does when updating a sub item. Loading drops
+        // other items, including already modified ones.
+        for (int i = 0; i < numItems; i += 2) {
+            Event &event = getItem(cache, i);
+            CPPUNIT_ASSERT(cache.load(event));
+            CPPUNIT_ASSERT_EQUAL(StringPrintf("item %d", i), getSummary(event));
+            icalcomponent_set_summary(event.m_calendar, StringPrintf("modified %d", i).c_str());
+        }
+        CPPUNIT_ASSERT(!getItem(cache, 0).m_calendar);
+
+        // all items must have their latest content, regardless whether
+        // they were spilled once or several times
+        for (int i = numItems - 1; i >= 0; i--) {
+            Event &event = getItem(cache, i);
+            CPPUNIT_ASSERT(cache.load(event));
+            CPPUNIT_ASSERT_EQUAL(StringPrintf(i % 2 ? "item %d" : "modified %d", i), getSummary(event));
+            CPPUNIT_ASSERT_EQUAL(StringPrintf("caldav-cache-test-%d", i), event.m_UID);
+        }
+        CPPUNIT_ASSERT(countSpilled(cache) >= numItems - 4);
+
+        // not spilled and not parsed: must come from server
+        Event &event = getItem(cache, 1);
+        event.m_calendar.set(NULL);
+        event.m_spillOffset = -1;
+        CPPUNIT_ASSERT(!cache.load(event));
+    }
+
+    void testUnlimited() {
+        EventCache cache;
+        cache.m_maxSize = 0;
+        for (int i = 0; i < 100; i++) {
+            addItem(cache, i);
+        }
+        CPPUNIT_ASSERT_EQUAL(0, countSpilled(cache));
+    }
+};
+
+SYNCEVOLUTION_TEST_SUITE_REGISTRATION(CalDAVCacheTest);
+
+#endif // ENABLE_UNIT_TESTS
+
 SE_END_CXX
 
 #endif // ENABLE_DAV
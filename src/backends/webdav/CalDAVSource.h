@@ -17,6 +17,8 @@
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <stdio.h>
+
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
 
@@ -33,7 +35,7 @@ class CalDAVSource : public WebDAVSource,
 
     /* implementation of SubSyncSource interface */
     virtual void begin() { contactServer(); }
-    virtual void endSubSync(bool success) { if (success) { storeServerInfos(); } }
+    virtual void endSubSync(bool success);
     virtual std::string subDatabaseRevision() { return databaseRevision(); }
     virtual void listAllSubItems(SubRevisionMap_t &revisions);
     virtual void updateAllSubItems(SubRevisionMap_t &revisions);
@@ -84,6 +86,8 @@ class CalDAVSource : public WebDAVSource,
     virtual std::string getContent() const { return "VEVENT"; }
     virtual bool getContentMixed() const { return true; }
 
+    friend class CalDAVCacheTest;
+
  private:
     /**
      * Information about each merged item.
@@ -92,7 +96,11 @@ class CalDAVSource : public WebDAVSource,
     public:
         Event() :
             m_sequence(0),
-            m_lastmodtime(0)
+            m_lastmodtime(0),
+            m_size(0),
+            m_spillOffset(-1),
+            m_spillSize(0),
+            m_lastUsed(0)
         {}
 
         /** the ID used by WebDAVSource */
@@ -124,6 +132,23 @@ class CalDAVSource : public WebDAVSource,
          */
         eptr<icalcomponent> m_calendar;
 
+        /**
+         * estimated memory used by m_calendar: length of the
+         * iCalendar 2.0 text it was parsed from
+         */
+        size_t m_size;
+
+        /**
+         * m_calendar was dropped to stay within the cache limit and
+         * its serialized form was written into the spill file at this
+         * offset; -1 if not spilled
+         */
+        long m_spillOffset;
+        size_t m_spillSize;
+
+        /** EventCache::m_useCounter when m_calendar was last loaded */
+        unsigned long m_lastUsed;
+
         /**
          * clean up calendar directly after receiving it from peer:
          * RECURRENCE-ID in UTC, remove X-LIC-ERROR
@@ -167,10 +192,52 @@ class CalDAVSource : public WebDAVSource,
     class EventCache : public std::map<std::string, boost::shared_ptr<Event> >
     {
       public:
-        EventCache() : m_initialized(false) {}
+        EventCache();
         bool m_initialized;
 
         iterator findByUID(const std::string &uid);
+
+        /**
+         * Maximum estimated size of all parsed calendars, 0 for
+         * unlimited. Set from "calDAVCacheLimit" in the source config.ini.
+         */
+        size_t m_maxSize;
+
+        /** mark calendar of event as recently used */
+        void touch(Event &event) { event.m_lastUsed = ++m_useCounter; }
+
+        /**
+         * account for a calendar which was just parsed and drop
+         * calendars of other events if over the limit
+         */
+        void loaded(Event &event);
+
+        /**
+         * make event.m_calendar available again if it was dropped by
+         * loaded(), otherwise just mark it as used
+         *
+         * @return false if the calendar must be retrieved from the server
+         */
+        bool load(Event &event);
+
+        /** log memory statistics */
+        void logStats();
+
+      private:
+        /** sum of m_size of calendars loaded since last limitSize(), upper bound */
+        size_t m_loadedSize;
+        unsigned long m_useCounter;
+        /** temporary file with spilled calendars, created on demand */
+        boost::shared_ptr<FILE> m_spillFile;
+
+        size_t m_peakSize;
+        unsigned long m_spilled, m_unspilled;
+
+        /** spill least recently used calendars except the one of keep */
+        void limitSize(const Event &keep);
+        void spill(Event &event);
+        /** read calendar dropped by loaded() back into event.m_calendar */
+        void unspill(Event &event);
     } m_cache;
 
     Event &findItem(const std::string &davLUID);
@@ -22,6 +22,7 @@
 #include <syncevo/LogRedirect.h>
 #include <syncevo/SmartPtr.h>
 #include <syncevo/SuspendFlags.h>
+#include <syncevo/HTTPConnectionPool.h>
 
 #include <sstream>
 
@@ -193,6 +194,9 @@ Session::Session(const boost::shared_ptr<Settings> &settings) :
     m_settings(settings),
     m_debugging(false),
     m_session(NULL),
+    m_verifySSLHost(settings->verifySSLHost()),
+    m_verifySSLCertificate(settings->verifySSLCertificate()),
+    m_connected(false),
     m_attempt(0)
 {
     int logLevel = m_settings->logLevel();
@@ -262,6 +266,8 @@ Session::Session(const boost::shared_ptr<Settings> &settings) :
     ne_set_read_timeout(m_session, seconds);
     ne_set_connect_timeout(m_session, seconds);
     ne_hook_pre_send(m_session, preSendHook, this);
+    ne_hook_post_send(m_session, postSendHook, this);
+    ne_set_notifier(m_session, notifyStatus, this);
 }
 
 Session::~Session()
@@ -272,21 +278,38 @@ Session::~Session()
     ne_sock_exit();
 }
 
-boost::shared_ptr<Session> Session::m_cachedSession;
+std::list< boost::shared_ptr<Session> > Session::m_cachedSessions;
 
 boost::shared_ptr<Session> Session::create(const boost::shared_ptr<Settings> &settings)
 {
     URI uri = URI::parse(settings->getURL());
-    if (m_cachedSession &&
-        m_cachedSession->m_uri == uri &&
-        m_cachedSession->m_proxyURL == settings->proxy()) {
-        // reuse existing session with new settings pointer
-        m_cachedSession->m_settings = settings;
-        return m_cachedSession;
+    std::string proxy = settings->proxy();
+    bool verifySSLHost = settings->verifySSLHost();
+    bool verifySSLCertificate = settings->verifySSLCertificate();
+    boost::shared_ptr<Session> session;
+    for (std::list< boost::shared_ptr<Session> >::iterator it = m_cachedSessions.begin();
+         it != m_cachedSessions.end();
+         ++it) {
+        if ((*it)->m_uri == uri &&
+            (*it)->m_proxyURL == proxy &&
+            (*it)->m_verifySSLHost == verifySSLHost &&
+            (*it)->m_verifySSLCertificate == verifySSLCertificate) {
+            // reuse existing session with new settings pointer
+            session = *it;
+            session->m_settings = settings;
+            m_cachedSessions.erase(it);
+            break;
+        }
+    }
+    if (!session) {
+        // create new session
+        session.reset(new Session(settings));
+    }
+    m_cachedSessions.push_front(session);
+    while (m_cachedSessions.size() > MAX_CACHED_SESSIONS) {
+        m_cachedSessions.pop_back();
     }
-    // create new session
-    m_cachedSession.reset(new Session(settings));
-    return m_cachedSession;
+    return session;
 }
 
 
@@ -330,6 +353,42 @@ void Session::preSendHook(ne_request *req, void *userdata, ne_buffer *header) th
     }
 }
 
+void Session::notifyStatus(void *userdata, ne_session_status status, const ne_session_status_info *info) throw()
+{
+    try {
+        Session *session = static_cast<Session *>(userdata);
+        switch (status) {
+        case ne_status_connecting:
+            session->m_connectStart = Timespec::monotonic();
+            break;
+        case ne_status_connected:
+            // neon negotiates TLS after reporting the connection,
+            // so the TLS handshake is not included
+            session->m_connected = true;
+            HTTPConnectionPool::get().connected((Timespec::monotonic() - session->m_connectStart).duration());
+            break;
+        default:
+            break;
+        }
+    } catch (...) {
+        Exception::handle();
+    }
+}
+
+int Session::postSendHook(ne_request *req, void *userdata, const ne_status *status) throw()
+{
+    try {
+        Session *session = static_cast<Session *>(userdata);
+        if (!session->m_connected) {
+            HTTPConnectionPool::get().reused();
+        }
+        session->m_connected = false;
+    } catch (...) {
+        Exception::handle();
+    }
+    return NE_OK;
+}
+
 void Session::preSend(ne_request *req, ne_buffer *header)
 {
     // sanity check: startOperation must have been called
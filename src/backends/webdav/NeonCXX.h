@@ -206,7 +206,10 @@ class Session {
      * @param settings    must provide information about settings on demand
      */
     Session(const boost::shared_ptr<Settings> &settings);
-    static boost::shared_ptr<Session> m_cachedSession;
+
+    /** recently used sessions, most recent one first */
+    static std::list< boost::shared_ptr<Session> > m_cachedSessions;
+    static const size_t MAX_CACHED_SESSIONS = 4;
 
     bool m_forceAuthorizationOnce;
     std::string m_forceUsername, m_forcePassword;
@@ -234,9 +237,11 @@ class Session {
     /**
      * Create or reuse Session instance.
      * 
-     * One Session instance is kept alive throughout the life of the process,
-     * to reuse proxy information (libproxy has a considerably delay during
-     * initialization) and HTTP connection/authentication.
+     * The most recently used Session instances are kept alive
+     * throughout the life of the process, to reuse proxy information
+     * (libproxy has a considerably delay during initialization), HTTP
+     * connection/authentication and the TLS session. They are keyed
+     * by URL, proxy and TLS settings.
      */
     static boost::shared_ptr<Session> create(const boost::shared_ptr<Settings> &settings);
     ~Session();
@@ -335,6 +340,12 @@ class Session {
     ne_session *m_session;
     URI m_uri;
     std::string m_proxyURL;
+    /** TLS settings when the session was created */
+    bool m_verifySSLHost, m_verifySSLCertificate;
+    /** start of connecting, maintained by notifyStatus() */
+    Timespec m_connectStart;
+    /** current request needed a new connection */
+    bool m_connected;
     /** time when last successul request completed, maintained by checkError() */
     Timespec m_lastRequestEnd;
     /** number of times a request was sent, maintained by startOperation(), the credentials callback, and checkError() */
@@ -367,6 +378,11 @@ class Session {
     static void preSendHook(ne_request *req, void *userdata, ne_buffer *header) throw();
     /** implements forced Basic authentication, if requested */
     void preSend(ne_request *req, ne_buffer *header);
+
+    /** ne_set_notifier() callback, counts new connections in HTTPConnectionPool */
+    static void notifyStatus(void *userdata, ne_session_status status, const ne_session_status_info *info) throw();
+    /** ne_hook_post_send() callback, counts requests on already open connections */
+    static int postSendHook(ne_request *req, void *userdata, const ne_status *status) throw();
 };
 
 /**
@@ -26,6 +26,17 @@ BoolConfigProperty &WebDAVCredentialsOkay()
     return okay;
 }
 
+UIntConfigProperty &CalDAVCacheLimit()
+{
+    static UIntConfigProperty limit("calDAVCacheLimit",
+                                    "Limits the amount of parsed calendar data (measured as size\n"
+                                    "of the iCalendar 2.0 text, in KB) that a CalDAV source keeps\n"
+                                    "in memory during a sync. Least recently used items beyond that\n"
+                                    "are moved into a temporary file. 0 disables the limit.",
+                                    "16384");
+    return limit;
+}
+
 #ifdef ENABLE_DAV
 
 /**
@@ -12,6 +12,7 @@
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
 extern BoolConfigProperty &WebDAVCredentialsOkay();
+extern UIntConfigProperty &CalDAVCacheLimit();
 SE_END_CXX
 
 #ifdef ENABLE_DAV
@@ -123,6 +123,9 @@ public:
         // so that config migration always includes this property
         WebDAVCredentialsOkay().setHidden(true);
         SyncConfig::getRegistry().push_back(&WebDAVCredentialsOkay());
+        // only read by CalDAVSource from its own config.ini, not part of the
+        // registry shared by all sources
+        CalDAVCacheLimit().setSharing(ConfigProperty::SOURCE_SET_SHARING);
     }
 } registerMe;
 
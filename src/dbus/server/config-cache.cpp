@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2011 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "config-cache.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <syncevo/util.h>
+#include <syncevo/Logging.h>
+
+SE_BEGIN_CXX
+
+/**
+ * Upper limit for the number of cached reports. There are only a
+ * few sessions per config (see "maxlogdirs"), so this is only
+ * reached when session directories keep changing. Then the
+ * cache is simply flushed.
+ */
+static const size_t MAX_REPORTS = 10000;
+
+ConfigCache::ConfigCache() :
+    m_haveConfigs(false),
+    m_watching(false),
+    m_modified(false),
+    m_hits(0),
+    m_misses(0),
+    m_invalidations(0),
+    m_reportHits(0),
+    m_reportMisses(0)
+{
+}
+
+SyncConfig::ConfigList ConfigCache::getConfigs()
+{
+    check();
+    if (m_haveConfigs) {
+        m_hits++;
+    } else {
+        m_misses++;
+        m_configs = SyncConfig::getConfigs();
+        m_haveConfigs = true;
+    }
+    return m_configs;
+}
+
+SyncConfig::TemplateList ConfigCache::getPeerTemplates(const SyncConfig::DeviceList &devices)
+{
+    check();
+    // The result depends on the devices, so include them
+    // in the key. Never empty.
+    std::string key = "templates";
+    BOOST_FOREACH(const SyncConfig::DeviceDescription &device, devices) {
+        key += StringPrintf("\n%s\t%s\t%d",
+                            device.m_deviceId.c_str(),
+                            device.getFingerprint().c_str(),
+                            (int)device.m_matchMode);
+    }
+    if (key == m_templatesKey) {
+        m_hits++;
+    } else {
+        m_misses++;
+        m_templates = SyncConfig::getPeerTemplates(devices);
+        m_templatesKey = key;
+    }
+    return m_templates;
+}
+
+bool ConfigCache::getNamedConfig(const std::string &configName, Config_t &config)
+{
+    check();
+    NamedConfigs_t::const_iterator it = m_namedConfigs.find(configName);
+    if (it == m_namedConfigs.end()) {
+        m_misses++;
+        return false;
+    }
+    m_hits++;
+    config = it->second;
+    return true;
+}
+
+void ConfigCache::setNamedConfig(const std::string &configName, const Config_t &config)
+{
+    check();
+    // Passwords may have been read from the keyring. Don't keep
+    // them around longer than necessary.
+    Config_t &entry = m_namedConfigs[configName];
+    entry = config;
+    BOOST_FOREACH(const ConfigProperty *prop, SyncConfig::getRegistry()) {
+        if (dynamic_cast<const PasswordConfigProperty *>(prop)) {
+            entry[""].erase(prop->getMainName());
+        }
+    }
+    BOOST_FOREACH(Config_t::value_type &source, entry) {
+        if (boost::starts_with(source.first, "source/")) {
+            BOOST_FOREACH(const ConfigProperty *prop, SyncSourceConfig::getRegistry()) {
+                if (dynamic_cast<const PasswordConfigProperty *>(prop)) {
+                    source.second.erase(prop->getMainName());
+                }
+            }
+        }
+    }
+}
+
+bool ConfigCache::getReport(const std::string &dir, StringMap &report)
+{
+    Reports_t::const_iterator it = m_reports.find(dir);
+    time_t mtime;
+    off_t size;
+    if (it == m_reports.end() ||
+        !statReport(dir, mtime, size) ||
+        mtime != it->second.m_mtime ||
+        size != it->second.m_size) {
+        m_reportMisses++;
+        return false;
+    }
+    m_reportHits++;
+    report = it->second.m_report;
+    return true;
+}
+
+void ConfigCache::setReport(const std::string &dir, const StringMap &report)
+{
+    Report entry;
+    if (!statReport(dir, entry.m_mtime, entry.m_size)) {
+        // session still starting or broken, don't remember
+        return;
+    }
+    if (m_reports.size() >= MAX_REPORTS) {
+        m_reports.clear();
+    }
+    entry.m_report = report;
+    m_reports[dir] = entry;
+}
+
+bool ConfigCache::statReport(const std::string &dir, time_t &mtime, off_t &size)
+{
+    struct stat buf;
+    if (stat((dir + "/status.ini").c_str(), &buf)) {
+        return false;
+    }
+    mtime = buf.st_mtime;
+    size = buf.st_size;
+    return true;
+}
+
+void ConfigCache::invalidate(const std::string &reason)
+{
+    if (m_haveConfigs ||
+        !m_templatesKey.empty() ||
+        !m_namedConfigs.empty()) {
+        SE_LOG_DEBUG(NULL, NULL, "config cache: %s, flushing %lu configs",
+                     reason.c_str(),
+                     (unsigned long)m_namedConfigs.size());
+        m_invalidations++;
+    }
+    m_haveConfigs = false;
+    m_configs.clear();
+    m_templatesKey.clear();
+    m_templates.clear();
+    m_namedConfigs.clear();
+    m_modified = false;
+    // New directories might have been created, need to
+    // set up watches again. Not done here because
+    // we might be called by one of the watches.
+    m_watching = false;
+}
+
+StringMap ConfigCache::getStatistics() const
+{
+    StringMap stats;
+    stats["hits"] = boost::lexical_cast<std::string>(m_hits);
+    stats["misses"] = boost::lexical_cast<std::string>(m_misses);
+    stats["invalidations"] = boost::lexical_cast<std::string>(m_invalidations);
+    stats["configs"] = boost::lexical_cast<std::string>(m_namedConfigs.size());
+    stats["reportHits"] = boost::lexical_cast<std::string>(m_reportHits);
+    stats["reportMisses"] = boost::lexical_cast<std::string>(m_reportMisses);
+    stats["reports"] = boost::lexical_cast<std::string>(m_reports.size());
+    stats["watches"] = boost::lexical_cast<std::string>(m_watches.size());
+    return stats;
+}
+
+void ConfigCache::check()
+{
+    if (m_modified) {
+        invalidate("files modified");
+    }
+    if (!m_watching) {
+        m_watches.clear();
+        m_watching = true;
+        // same directories as in SyncConfig::getConfigs() and
+        // SyncConfig::matchPeerTemplates()
+        watch(SubstEnvironment("${XDG_CONFIG_HOME}/syncevolution"));
+        watch(SubstEnvironment("${XDG_CONFIG_HOME}/syncevolution-templates"));
+        SE_LOG_DEBUG(NULL, NULL, "config cache: watching %lu directories",
+                     (unsigned long)m_watches.size());
+    }
+}
+
+void ConfigCache::addWatch(const std::string &path)
+{
+    boost::shared_ptr<GLibDirNotify> notify(new GLibDirNotify(path.c_str(),
+                                                              boost::bind(&ConfigCache::fileModified, this, _1, _3)));
+    m_watches[path] = notify;
+}
+
+void ConfigCache::watch(const std::string &path)
+{
+    if (!isDir(path)) {
+        // Creating the directory must be noticed,
+        // watch its parent (but not recursively).
+        std::string parent = getDirname(path);
+        if (!parent.empty() && isDir(parent)) {
+            try {
+                addWatch(parent);
+            } catch (...) {
+                Exception::handle();
+            }
+        }
+        return;
+    }
+
+    try {
+        addWatch(path);
+    } catch (...) {
+        // without a watch, the cache might become stale:
+        // better stop using it until the next invalidation
+        Exception::handle();
+        m_modified = true;
+        return;
+    }
+    ReadDir dir(path, false);
+    BOOST_FOREACH(const std::string &entry, dir) {
+        std::string sub = path + "/" + entry;
+        if (!boost::starts_with(entry, ".") &&
+            isDir(sub)) {
+            watch(sub);
+        }
+    }
+}
+
+void ConfigCache::fileModified(GFile *file, GFileMonitorEvent event)
+{
+    PlainGStr path(g_file_get_path(file));
+    if (!path.get()) {
+        return;
+    }
+    std::string name = getBasename(path.get());
+    if (boost::starts_with(name, ".")) {
+        // internal state of peers and sources, logs, caches
+        return;
+    }
+    if (name == "config.ini" ||
+        name == "template.ini" ||
+        (event == G_FILE_MONITOR_EVENT_CREATED && isDir(path.get())) ||
+        (event == G_FILE_MONITOR_EVENT_DELETED && m_watches.find(path.get()) != m_watches.end())) {
+        // Only remember the event. The watch which calls us must not be
+        // destroyed right now.
+        m_modified = true;
+    }
+}
+
+SE_END_CXX
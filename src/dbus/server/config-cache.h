@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2011 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <syncevo/SyncConfig.h>
+#include <syncevo/GLibSupport.h>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+/**
+ * Results of the expensive ReadOperations, kept in memory between
+ * D-Bus calls. Everything is thrown away when the configuration
+ * changes, either because syncevo-dbus-server itself writes a
+ * config (Session::setNamedConfig() calls invalidate() right away,
+ * Server::m_configChangedSignal covers the helper) or because
+ * inotify reports modifications in the config or template
+ * directories (for example, by a command line running in parallel).
+ *
+ * Sync reports do not depend on the configuration. They are cached
+ * per session directory and reparsed when the status.ini file of the
+ * session changes.
+ */
+class ConfigCache : private boost::noncopyable
+{
+ public:
+    /** same as ReadOperations::Config_t */
+    typedef std::map< std::string, StringMap > Config_t;
+
+    ConfigCache();
+
+    /** SyncConfig::getConfigs() */
+    SyncConfig::ConfigList getConfigs();
+
+    /** SyncConfig::getPeerTemplates() */
+    SyncConfig::TemplateList getPeerTemplates(const SyncConfig::DeviceList &devices);
+
+    /**
+     * Look up the result of ReadOperations::getNamedConfig() for a
+     * local configuration without temporary changes. Password
+     * properties are not stored and must be added by the caller.
+     *
+     * @return true if found
+     */
+    bool getNamedConfig(const std::string &configName, Config_t &config);
+    void setNamedConfig(const std::string &configName, const Config_t &config);
+
+    /**
+     * Look up a serialized SyncReport for the session directory.
+     *
+     * @return true if found and status.ini not modified since it was stored
+     */
+    bool getReport(const std::string &dir, StringMap &report);
+    void setReport(const std::string &dir, const StringMap &report);
+
+    /** drop all configuration information */
+    void invalidate(const std::string &reason);
+
+    /** hit/miss statistics, for Server.GetCacheStatistics() */
+    StringMap getStatistics() const;
+
+ private:
+    /** true if m_configs is valid */
+    bool m_haveConfigs;
+    SyncConfig::ConfigList m_configs;
+
+    /** key for m_templates, empty if not valid */
+    std::string m_templatesKey;
+    SyncConfig::TemplateList m_templates;
+
+    typedef std::map<std::string, Config_t> NamedConfigs_t;
+    NamedConfigs_t m_namedConfigs;
+
+    struct Report {
+        time_t m_mtime;
+        off_t m_size;
+        StringMap m_report;
+    };
+    typedef std::map<std::string, Report> Reports_t;
+    Reports_t m_reports;
+
+    /**
+     * Monitors for the directories in the config and template trees,
+     * indexed by path. Hidden directories (.synthesis, .cache) are
+     * skipped and events are filtered by file name, because files
+     * rewritten by each sync (.internal.ini, .other.ini, ...) must
+     * not flush the cache. Only set up while something is cached.
+     */
+    typedef std::map<std::string, boost::shared_ptr<GLibDirNotify> > Watches_t;
+    Watches_t m_watches;
+    bool m_watching;
+    /** set by inotify callback, checked before using the cache */
+    bool m_modified;
+
+    unsigned long m_hits, m_misses, m_invalidations;
+    unsigned long m_reportHits, m_reportMisses;
+
+    /** handle pending inotify event, start watching if not done yet */
+    void check();
+    void watch(const std::string &path);
+    void addWatch(const std::string &path);
+    void fileModified(GFile *file, GFileMonitorEvent event);
+
+    static bool statReport(const std::string &dir, time_t &mtime, off_t &size);
+};
+
+SE_END_CXX
+
+#endif // CONFIG_CACHE_H
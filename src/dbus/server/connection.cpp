@@ -58,6 +58,7 @@ void Connection::failed(const std::string &reason)
     if (c) {
         m_server.delayDeletion(c);
         m_server.detach(this);
+        m_detachSignal();
     }
 }
 
@@ -118,6 +119,17 @@ void Connection::process(const Caller_t &caller,
         throw runtime_error("client does not own connection");
     }
 
+    processMessage(message, message_type);
+}
+
+void Connection::processMessage(const GDBusCXX::DBusArray<uint8_t> &message,
+                                const std::string &message_type)
+{
+    boost::shared_ptr<Connection> myself = m_me.lock();
+    if (!myself) {
+        SE_THROW("connection already destructing");
+    }
+
     // any kind of error from now on terminates the connection
     try {
         switch (m_state) {
@@ -363,7 +375,7 @@ void Connection::process(const Caller_t &caller,
         failed(error.what());
         throw;
     } catch (...) {
-        failed("unknown exception in Connection::process");
+        failed("unknown exception in Connection::processMessage");
         throw;
     }
 }
@@ -391,9 +403,12 @@ void Connection::send(const DBusArray<uint8_t> buffer,
     m_incomingMsg = SharedBuffer();
 
     // TODO: turn D-Bus exceptions into transport exceptions
-    StringMap meta;
-    meta["URL"] = url;
-    reply(buffer, type, meta, false, m_sessionID);
+    if (!m_local) {
+        StringMap meta;
+        meta["URL"] = url;
+        reply(buffer, type, meta, false, m_sessionID);
+    }
+    m_replySignal(buffer, type, url, false);
 }
 
 void Connection::sendFinalMsg()
@@ -404,9 +419,13 @@ void Connection::sendFinalMsg()
     if (m_state == SessionCommon::PROCESSING) {
         // send final, empty message and wait for close
         m_state = SessionCommon::FINAL;
-        reply(GDBusCXX::DBusArray<uint8_t>(0, 0),
-              "", StringMap(),
-              true, m_sessionID);
+        if (!m_local) {
+            reply(GDBusCXX::DBusArray<uint8_t>(0, 0),
+                  "", StringMap(),
+                  true, m_sessionID);
+        }
+        m_replySignal(GDBusCXX::DBusArray<uint8_t>(0, 0),
+                      "", "", true);
     }
 }
 
@@ -438,6 +457,12 @@ void Connection::close(const Caller_t &caller,
     m_server.delayDeletion(c);
     client->detach(this);
 
+    closeConnection(normal, error);
+}
+
+void Connection::closeConnection(bool normal,
+                                 const std::string &error)
+{
     if (!normal ||
         m_state != SessionCommon::FINAL) {
         std::string err = error.empty() ?
@@ -467,8 +492,11 @@ void Connection::abort()
         SE_LOG_DEBUG(NULL, NULL, "Connection %s: send abort to client (state %s)",
                      m_sessionID.c_str(),
                      SessionCommon::ConnectionStateToString(m_state).c_str());
-        sendAbort();
+        if (!m_local) {
+            sendAbort();
+        }
         m_abortSent = true;
+        m_abortSignal();
     } else {
         SE_LOG_DEBUG(NULL, NULL, "Connection %s: not sending abort to client, already done (state %s)",
                      m_sessionID.c_str(),
@@ -485,13 +513,15 @@ void Connection::shutdown()
     // trigger removal of this connection by removing all
     // references to it
     m_server.detach(this);
+    m_detachSignal();
 }
 
 Connection::Connection(Server &server,
                        const DBusConnectionPtr &conn,
                        const std::string &sessionID,
                        const StringMap &peer,
-                       bool must_authenticate) :
+                       bool must_authenticate,
+                       bool local) :
     DBusObjectHelper(conn,
                      std::string("/org/syncevolution/Connection/") + sessionID,
                      "org.syncevolution.Connection",
@@ -500,6 +530,7 @@ Connection::Connection(Server &server,
     m_peer(peer),
     m_mustAuthenticate(must_authenticate),
     m_state(SessionCommon::SETUP),
+    m_local(local),
     m_sessionID(sessionID),
     m_timeoutSeconds(-1),
     sendAbort(*this, "Abort"),
@@ -521,9 +552,10 @@ boost::shared_ptr<Connection> Connection::createConnection(Server &server,
                                                            const DBusConnectionPtr &conn,
                                                            const std::string &sessionID,
                                                            const StringMap &peer,
-                                                           bool must_authenticate)
+                                                           bool must_authenticate,
+                                                           bool local)
 {
-    boost::shared_ptr<Connection> c(new Connection(server, conn, sessionID, peer, must_authenticate));
+    boost::shared_ptr<Connection> c(new Connection(server, conn, sessionID, peer, must_authenticate, local));
     c->m_me = c;
     return c;
 }
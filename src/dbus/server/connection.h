@@ -57,6 +57,14 @@ class Connection : public GDBusCXX::DBusObjectHelper, public Resource
     SessionCommon::ConnectionState m_state;
     std::string m_failure;
 
+    /**
+     * True for connections created inside syncevo-dbus-server (see
+     * HTTPServer). Such connections are not owned by a D-Bus client
+     * and not exported on the bus, so instead of the D-Bus Reply and
+     * Abort signals the C++ signals below are used.
+     */
+    bool m_local;
+
     /** first parameter for Session::sync() */
     std::string m_syncMode;
     /** second parameter for Session::sync() */
@@ -133,7 +141,8 @@ class Connection : public GDBusCXX::DBusObjectHelper, public Resource
                const GDBusCXX::DBusConnectionPtr &conn,
                const std::string &session_num,
                const StringMap &peer,
-               bool must_authenticate);
+               bool must_authenticate,
+               bool local);
 
 public:
     const std::string m_description;
@@ -142,7 +151,27 @@ public:
                                                           const GDBusCXX::DBusConnectionPtr &conn,
                                                           const std::string &session_num,
                                                           const StringMap &peer,
-                                                          bool must_authenticate);
+                                                          bool must_authenticate,
+                                                          bool local = false);
+
+    const std::string &getSessionID() const { return m_sessionID; }
+
+    /**
+     * Implementation of Connection.Process() once the caller is
+     * known to own the connection; also used directly for local
+     * connections.
+     */
+    void processMessage(const GDBusCXX::DBusArray<uint8_t> &message,
+                        const std::string &message_type);
+
+    /**
+     * Implementation of Connection.Close() once the caller has
+     * dropped its reference; also used directly for local
+     * connections, whose owner must have called
+     * Server::delayDeletion() already.
+     */
+    void closeConnection(bool normal,
+                         const std::string &error);
 
     ~Connection();
 
@@ -170,6 +199,27 @@ public:
     /** connection went down (empty string) or failed (error message) */
     typedef boost::signals2::signal<void (const std::string &)> StatusSignal_t;
     StatusSignal_t m_statusSignal;
+
+    /**
+     * outgoing message (data, type, URL, final), emitted together
+     * with the D-Bus Reply signal
+     */
+    typedef boost::signals2::signal<void (const GDBusCXX::DBusArray<uint8_t> &,
+                                          const std::string &,
+                                          const std::string &,
+                                          bool)> ReplySignal_t;
+    ReplySignal_t m_replySignal;
+
+    /** emitted together with the D-Bus Abort signal */
+    typedef boost::signals2::signal<void ()> AbortSignal_t;
+    AbortSignal_t m_abortSignal;
+
+    /**
+     * connection removes itself, owner of a local connection must
+     * drop its reference
+     */
+    typedef boost::signals2::signal<void ()> DetachSignal_t;
+    DetachSignal_t m_detachSignal;
 };
 
 SE_END_CXX
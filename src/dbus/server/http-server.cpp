@@ -0,0 +1,467 @@
+/*
+ * Copyright (C) 2011 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "http-server.h"
+
+#ifdef ENABLE_LIBSOUP
+
+#include "server.h"
+#include "connection.h"
+
+#include <boost/foreach.hpp>
+
+#include <strings.h>
+
+#include <syncevo/util.h>
+#include <syncevo/Logging.h>
+
+using namespace GDBusCXX;
+
+SE_BEGIN_CXX
+
+void HTTPServer::Stats::add(const Timespec &latency)
+{
+    m_requests++;
+    m_total = m_total + latency;
+    if (latency > m_max) {
+        m_max = latency;
+    }
+}
+
+std::string HTTPServer::Stats::toString() const
+{
+    return StringPrintf("%lu requests, average latency %.3fs, max %.3fs",
+                        m_requests,
+                        m_requests ? m_total.duration() / m_requests : 0.0,
+                        m_max.duration());
+}
+
+StringMap HTTPServer::getStatistics() const
+{
+    StringMap stats;
+    unsigned long sessions = 0;
+    BOOST_FOREACH(const Peers_t::value_type &entry, m_peers) {
+        if (entry.second->m_connection) {
+            sessions++;
+        }
+    }
+    stats["port"] = StringPrintf("%d", m_port);
+    stats["sessions"] = StringPrintf("%lu", sessions);
+    stats["requests"] = StringPrintf("%lu", m_stats.m_requests);
+    // milliseconds
+    stats["latencyTotal"] = StringPrintf("%.0f", m_stats.m_total.duration() * 1000);
+    stats["latencyMax"] = StringPrintf("%.0f", m_stats.m_max.duration() * 1000);
+    return stats;
+}
+
+HTTPServer::HTTPServer(Server &server, int port) :
+    m_server(server),
+    m_port(port)
+{
+    m_soup.set(soup_server_new(SOUP_SERVER_PORT, port,
+                               NULL),
+               "SoupServer");
+    soup_server_add_handler(m_soup.get(), NULL, requestCb, this, NULL);
+    soup_server_run_async(m_soup.get());
+    // keep running while we are listening
+    m_server.autoTermRef();
+    m_server.setHTTPServer(this);
+    SE_LOG_INFO(NULL, NULL, "listening for SyncML via HTTP on port %d", port);
+}
+
+HTTPServer::~HTTPServer()
+{
+    SE_LOG_DEBUG(NULL, NULL, "HTTP server on port %d shutting down, %s",
+                 m_port, m_stats.toString().c_str());
+    // Don't get called back while tearing down libsoup and
+    // the connections.
+    BOOST_FOREACH(const Peers_t::value_type &entry, m_peers) {
+        Peer &peer = *entry.second;
+        peer.m_replyConn.disconnect();
+        peer.m_abortConn.disconnect();
+        peer.m_detachConn.disconnect();
+        if (peer.m_msg) {
+            g_signal_handlers_disconnect_by_func(peer.m_msg,
+                                                 (gpointer)finishedCb,
+                                                 this);
+            g_object_unref(peer.m_msg);
+            peer.m_msg = NULL;
+        }
+        if (peer.m_connection) {
+            m_server.delayDeletion(peer.m_connection);
+        }
+    }
+    m_peers.clear();
+    m_server.setHTTPServer(NULL);
+    if (m_soup) {
+        soup_server_quit(m_soup.get());
+        soup_server_disconnect(m_soup.get());
+        m_soup.set(NULL);
+    }
+    m_server.autoTermUnref();
+}
+
+void HTTPServer::requestCb(SoupServer *server,
+                           SoupMessage *msg,
+                           const char *path,
+                           GHashTable *query,
+                           SoupClientContext *client,
+                           gpointer userData) throw ()
+{
+    HTTPServer *me = static_cast<HTTPServer *>(userData);
+    try {
+        me->request(msg, path, query, client);
+    } catch (...) {
+        std::string explanation;
+        Exception::handle(explanation);
+        soup_message_set_status_full(msg, SOUP_STATUS_INTERNAL_SERVER_ERROR,
+                                     explanation.c_str());
+    }
+}
+
+void HTTPServer::request(SoupMessage *msg,
+                         const char *path,
+                         GHashTable *query,
+                         SoupClientContext *client)
+{
+    const char *host = soup_client_context_get_host(client);
+    m_server.autoTermCallback();
+
+    if (msg->method == SOUP_METHOD_GET) {
+        SE_LOG_INFO(NULL, NULL, "GET %s from %s", path, host);
+        static const char page[] = "<html>SyncEvolution SyncML Server</html>";
+        soup_message_set_status(msg, SOUP_STATUS_OK);
+        soup_message_set_response(msg, "text/html", SOUP_MEMORY_STATIC,
+                                  page, sizeof(page) - 1);
+        return;
+    } else if (msg->method != SOUP_METHOD_POST) {
+        soup_message_set_status(msg, SOUP_STATUS_NOT_IMPLEMENTED);
+        return;
+    }
+
+    const char *contentType = soup_message_headers_get_one(msg->request_headers,
+                                                           "Content-Type");
+    std::string type = contentType ? contentType : "";
+    const char *contentEncoding = soup_message_headers_get_one(msg->request_headers,
+                                                               "Content-Encoding");
+    std::string data;
+    if (contentEncoding && strcasecmp(contentEncoding, "identity")) {
+        // Rejecting the request with 415 tells the client to
+        // retry without compression.
+        if (!DecompressHTTPBody(msg->request_body->data, msg->request_body->length,
+                                contentEncoding, data)) {
+            SE_LOG_ERROR(NULL, NULL, "POST %s from %s: cannot decode Content-Encoding %s => 415 error",
+                         path, host, contentEncoding);
+            soup_message_set_status(msg, SOUP_STATUS_UNSUPPORTED_MEDIA_TYPE);
+            return;
+        }
+    } else {
+        data.assign(msg->request_body->data, msg->request_body->length);
+    }
+    const char *sessionID = query ?
+        static_cast<const char *>(g_hash_table_lookup(query, "sessionid")) :
+        NULL;
+    SE_LOG_DEBUG(NULL, NULL, "POST %s from %s type %s session %s length %lu",
+                 path, host, type.c_str(),
+                 sessionID ? sessionID : "<none>",
+                 (unsigned long)data.size());
+
+    if (!sessionID) {
+        start(msg, path, data, type);
+        return;
+    }
+
+    Peers_t::iterator it = m_peers.find(sessionID);
+    if (it == m_peers.end()) {
+        SE_LOG_ERROR(NULL, NULL, "unknown session %s => 404 error", sessionID);
+        soup_message_set_status(msg, SOUP_STATUS_NOT_FOUND);
+        return;
+    }
+    Peer &peer = *it->second;
+
+    // Detect resent message. Works even after the Connection
+    // is gone, because the client might not have received the
+    // last reply.
+    if (!peer.m_lastReply.empty() &&
+        peer.m_lastRequest == data) {
+        SE_LOG_DEBUG(NULL, NULL, "resend reply session %s", sessionID);
+        soup_message_set_status(msg, SOUP_STATUS_OK);
+        setResponse(msg, peer.m_lastReply, peer.m_lastReplyType);
+        return;
+    }
+    if (!peer.m_connection) {
+        SE_LOG_ERROR(NULL, NULL, "session %s already closed => 410 error", sessionID);
+        soup_message_set_status(msg, SOUP_STATUS_GONE);
+        return;
+    }
+    if (peer.m_msg) {
+        // message resend?! Ignore old request.
+        SE_LOG_DEBUG(NULL, NULL, "session %s: message resend?!", sessionID);
+        respond(peer, SOUP_STATUS_REQUEST_TIMEOUT);
+    }
+
+    // prepare resending, completed in reply()
+    peer.m_lastRequest = data;
+    peer.m_lastReply.clear();
+    peer.m_lastReplyType.clear();
+
+    // Keep the connection alive while it processes the message,
+    // it might fail and detach itself.
+    boost::shared_ptr<Connection> connection = peer.m_connection;
+    wait(peer, msg);
+    try {
+        connection->processMessage(DBusArray<uint8_t>(data.size(),
+                                                      reinterpret_cast<const uint8_t *>(data.c_str())),
+                                   type);
+    } catch (...) {
+        // Connection has failed and told us via signals,
+        // only log here.
+        Exception::handle();
+    }
+}
+
+void HTTPServer::start(SoupMessage *msg,
+                       const char *path,
+                       const std::string &data,
+                       const std::string &type)
+{
+    if (m_server.shutdownRequested()) {
+        soup_message_set_status(msg, SOUP_STATUS_SERVICE_UNAVAILABLE);
+        return;
+    }
+
+    // same peer description as in syncevo-http-server.py; the
+    // config is taken from the first path component
+    StringMap peerInfo;
+    peerInfo["description"] = "syncevo-dbus-server HTTP";
+    peerInfo["transport"] = "HTTP";
+    std::string config = path;
+    while (!config.empty() && config[0] == '/') {
+        config.erase(0, 1);
+    }
+    config = config.substr(0, config.find('/'));
+    peerInfo["config"] = config;
+    eptr<char> url(soup_uri_to_string(soup_message_get_uri(msg), FALSE));
+    peerInfo["URL"] = url.get();
+
+    boost::shared_ptr<Peer> peer(new Peer);
+    peer->m_sessionID = m_server.getNextSession();
+    peer->m_connection = Connection::createConnection(m_server,
+                                                      m_server.getConnection(),
+                                                      peer->m_sessionID,
+                                                      peerInfo,
+                                                      true,
+                                                      true);
+    SE_LOG_INFO(NULL, NULL, "new SyncML session %s for %s",
+                peer->m_sessionID.c_str(),
+                soup_uri_get_host(soup_message_get_uri(msg)));
+    peer->m_replyConn = peer->m_connection->m_replySignal.connect(boost::bind(&HTTPServer::reply, this, peer->m_sessionID, _1, _2, _3, _4));
+    peer->m_abortConn = peer->m_connection->m_abortSignal.connect(boost::bind(&HTTPServer::abort, this, peer->m_sessionID));
+    peer->m_detachConn = peer->m_connection->m_detachSignal.connect(boost::bind(&HTTPServer::detach, this, peer->m_sessionID));
+    m_peers[peer->m_sessionID] = peer;
+    peer->m_lastRequest = data;
+
+    boost::shared_ptr<Connection> connection = peer->m_connection;
+    wait(*peer, msg);
+    try {
+        connection->processMessage(DBusArray<uint8_t>(data.size(),
+                                                      reinterpret_cast<const uint8_t *>(data.c_str())),
+                                   type);
+    } catch (...) {
+        Exception::handle();
+    }
+}
+
+void HTTPServer::wait(Peer &peer, SoupMessage *msg)
+{
+    peer.m_msg = msg;
+    peer.m_received = Timespec::monotonic();
+    g_object_ref(msg);
+    g_signal_connect(msg, "finished", G_CALLBACK(finishedCb), this);
+    soup_server_pause_message(m_soup.get(), msg);
+}
+
+void HTTPServer::setResponse(SoupMessage *msg,
+                             const std::string &data,
+                             const std::string &type)
+{
+#ifdef HAVE_ZLIB
+    const char *accept = soup_message_headers_get_list(msg->request_headers,
+                                                       "Accept-Encoding");
+#else
+    const char *accept = NULL;
+#endif
+    if (accept && soup_header_contains(accept, "gzip")) {
+        std::string compressed = CompressHTTPBody(data.c_str(), data.size(), "gzip");
+        SE_LOG_DEBUG(NULL, NULL, "reply compressed from %lu to %lu bytes",
+                     (unsigned long)data.size(),
+                     (unsigned long)compressed.size());
+        soup_message_headers_replace(msg->response_headers, "Content-Encoding", "gzip");
+        soup_message_set_response(msg, type.c_str(), SOUP_MEMORY_COPY,
+                                  compressed.c_str(), compressed.size());
+    } else {
+        soup_message_set_response(msg, type.c_str(), SOUP_MEMORY_COPY,
+                                  data.c_str(), data.size());
+    }
+}
+
+void HTTPServer::respond(Peer &peer, guint status,
+                         const std::string &data,
+                         const std::string &type)
+{
+    SoupMessage *msg = peer.m_msg;
+    if (!msg) {
+        return;
+    }
+    peer.m_msg = NULL;
+    g_signal_handlers_disconnect_by_func(msg, (gpointer)finishedCb, this);
+
+    if (status == SOUP_STATUS_OK) {
+        Timespec latency = Timespec::monotonic() - peer.m_received;
+        peer.m_stats.add(latency);
+        m_stats.add(latency);
+        setResponse(msg, data, type);
+    }
+    soup_message_set_status(msg, status);
+    soup_server_unpause_message(m_soup.get(), msg);
+    g_object_unref(msg);
+}
+
+void HTTPServer::finishedCb(SoupMessage *msg, gpointer userData) throw ()
+{
+    HTTPServer *me = static_cast<HTTPServer *>(userData);
+    try {
+        // Lost connection to HTTP client. Keep the Connection,
+        // the client might still retry the request.
+        BOOST_FOREACH(const Peers_t::value_type &entry, me->m_peers) {
+            Peer &peer = *entry.second;
+            if (peer.m_msg == msg) {
+                SE_LOG_DEBUG(NULL, NULL, "session %s: HTTP client gone while waiting for reply",
+                             peer.m_sessionID.c_str());
+                g_signal_handlers_disconnect_by_func(msg, (gpointer)finishedCb, me);
+                peer.m_msg = NULL;
+                g_object_unref(msg);
+                break;
+            }
+        }
+    } catch (...) {
+        Exception::handle();
+    }
+}
+
+void HTTPServer::reply(const std::string &sessionID,
+                       const DBusArray<uint8_t> &buffer,
+                       const std::string &type,
+                       const std::string &url,
+                       bool final)
+{
+    Peers_t::iterator it = m_peers.find(sessionID);
+    if (it == m_peers.end()) {
+        return;
+    }
+    Peer &peer = *it->second;
+    SE_LOG_DEBUG(NULL, NULL, "session %s: reply %lu bytes, %s%s",
+                 sessionID.c_str(),
+                 (unsigned long)buffer.first,
+                 type.c_str(),
+                 final ? ", final" : "");
+
+    if (buffer.first) {
+        peer.m_lastReply.assign(reinterpret_cast<const char *>(buffer.second), buffer.first);
+        peer.m_lastReplyType = type;
+        if (peer.m_msg) {
+            respond(peer, SOUP_STATUS_OK, peer.m_lastReply, type);
+        } else {
+            // Connection does not need to know about the lost
+            // HTTP request, the client might still resend.
+            SE_LOG_DEBUG(NULL, NULL, "session %s: could not send reply immediately, buffering it",
+                         sessionID.c_str());
+        }
+    }
+    if (final) {
+        // Closing is what the client of the D-Bus API does in
+        // response to the final Reply. It must not happen while the
+        // Connection is still emitting that signal, so do it in the
+        // event loop.
+        peer.m_close.runOnce(0,
+                             boost::bind(&HTTPServer::close, this, sessionID));
+    }
+}
+
+void HTTPServer::close(const std::string &sessionID)
+{
+    Peers_t::iterator it = m_peers.find(sessionID);
+    if (it == m_peers.end() ||
+        !it->second->m_connection) {
+        return;
+    }
+    Peer &peer = *it->second;
+    SE_LOG_DEBUG(NULL, NULL, "session %s: closing connection", sessionID.c_str());
+    boost::shared_ptr<Connection> connection = peer.m_connection;
+    m_server.delayDeletion(connection);
+    retire(peer);
+    connection->closeConnection(true, "");
+}
+
+void HTTPServer::abort(const std::string &sessionID)
+{
+    Peers_t::iterator it = m_peers.find(sessionID);
+    if (it == m_peers.end()) {
+        return;
+    }
+    SE_LOG_DEBUG(NULL, NULL, "session %s: connection aborted", sessionID.c_str());
+    respond(*it->second, SOUP_STATUS_INTERNAL_SERVER_ERROR);
+}
+
+void HTTPServer::detach(const std::string &sessionID)
+{
+    Peers_t::iterator it = m_peers.find(sessionID);
+    if (it == m_peers.end()) {
+        return;
+    }
+    retire(*it->second);
+}
+
+void HTTPServer::retire(Peer &peer)
+{
+    if (!peer.m_connection) {
+        return;
+    }
+    SE_LOG_DEBUG(NULL, NULL, "session %s: done, %s",
+                 peer.m_sessionID.c_str(),
+                 peer.m_stats.toString().c_str());
+    peer.m_replyConn.disconnect();
+    peer.m_abortConn.disconnect();
+    peer.m_detachConn.disconnect();
+    // Connection might still be running code, let the server
+    // delete it.
+    m_server.delayDeletion(peer.m_connection);
+    peer.m_connection.reset();
+    respond(peer, SOUP_STATUS_GONE);
+
+    m_retired.push_back(peer.m_sessionID);
+    while (m_retired.size() > MAX_RETIRED) {
+        m_peers.erase(m_retired.front());
+        m_retired.pop_front();
+    }
+}
+
+SE_END_CXX
+
+#endif // ENABLE_LIBSOUP
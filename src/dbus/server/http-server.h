@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2011 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef ENABLE_LIBSOUP
+
+#include <map>
+#include <list>
+
+#include <libsoup/soup.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/signals2.hpp>
+
+#include <gdbus-cxx-bridge.h>
+
+#include "timeout.h"
+
+#include <syncevo/SmartPtr.h>
+#include <syncevo/Timespec.h>
+#include <syncevo/util.h>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+class Server;
+class Connection;
+
+/**
+ * Built-in replacement for test/syncevo-http-server.py: accepts
+ * SyncML messages via HTTP POST and feeds them directly into local
+ * Connection instances, without going through D-Bus.
+ *
+ * The semantic is the same as in the Python script: a POST without
+ * "sessionid" parameter starts a new Connection, the reply carries
+ * a RespURI with the session ID which the client then uses for all
+ * further messages. An identical resend of the last message in a
+ * session gets the previous reply. HTTP keep-alive and parallel
+ * sessions are handled by libsoup.
+ *
+ * Each request is held (paused) until the Connection replies. The
+ * time between receiving a request and sending the reply is
+ * recorded; totals are logged when a session ends and when the
+ * server shuts down and are available via Server.GetHTTPStatistics().
+ */
+class HTTPServer : private boost::noncopyable
+{
+ public:
+    /**
+     * @param port    TCP port to listen on, on all interfaces
+     */
+    HTTPServer(Server &server, int port);
+    ~HTTPServer();
+
+    /** latency counters for requests which got a reply */
+    struct Stats {
+        Stats() : m_requests(0) {}
+        void add(const Timespec &latency);
+        std::string toString() const;
+
+        /** number of replies sent */
+        unsigned long m_requests;
+        /** sum of all latencies */
+        Timespec m_total;
+        /** largest latency */
+        Timespec m_max;
+    };
+
+    const Stats &getStats() const { return m_stats; }
+
+    /** implementation of Server.GetHTTPStatistics() */
+    StringMap getStatistics() const;
+
+ private:
+    /** state of one SyncML session */
+    struct Peer {
+        Peer() : m_msg(NULL) {}
+
+        std::string m_sessionID;
+        boost::shared_ptr<Connection> m_connection;
+
+        /** paused request which waits for a reply, referenced */
+        SoupMessage *m_msg;
+        /** time when m_msg was received */
+        Timespec m_received;
+
+        /** last request and its reply, for resends */
+        std::string m_lastRequest;
+        std::string m_lastReply;
+        std::string m_lastReplyType;
+
+        Stats m_stats;
+
+        /** invokes close() after the final reply */
+        Timeout m_close;
+
+        boost::signals2::scoped_connection m_replyConn, m_abortConn, m_detachConn;
+    };
+    typedef std::map<std::string, boost::shared_ptr<Peer> > Peers_t;
+
+    Server &m_server;
+    int m_port;
+    eptr<SoupServer, GObject> m_soup;
+
+    /** all sessions, indexed by session ID */
+    Peers_t m_peers;
+
+    /**
+     * Session IDs of peers whose Connection is gone, oldest first.
+     * They are kept around for a while so that resending the last
+     * message still works (client didn't get the final reply).
+     */
+    std::list<std::string> m_retired;
+    static const size_t MAX_RETIRED = 16;
+
+    Stats m_stats;
+
+    static void requestCb(SoupServer *server,
+                          SoupMessage *msg,
+                          const char *path,
+                          GHashTable *query,
+                          SoupClientContext *client,
+                          gpointer userData) throw ();
+    void request(SoupMessage *msg,
+                 const char *path,
+                 GHashTable *query,
+                 SoupClientContext *client);
+
+    /** request got finished by libsoup, for example because the client disconnected */
+    static void finishedCb(SoupMessage *msg, gpointer userData) throw ();
+
+    /** start new Connection for a message without session ID */
+    void start(SoupMessage *msg,
+               const char *path,
+               const std::string &data,
+               const std::string &type);
+
+    /** pause message until the Connection replies */
+    void wait(Peer &peer, SoupMessage *msg);
+
+    /**
+     * set the reply body, gzip-compressed if the client accepts
+     * that (Accept-Encoding header of the request)
+     */
+    static void setResponse(SoupMessage *msg,
+                            const std::string &data,
+                            const std::string &type);
+
+    /** complete pending request of peer with the given status and (optional) reply */
+    void respond(Peer &peer, guint status,
+                 const std::string &data = "",
+                 const std::string &type = "");
+
+    /** Connection::m_replySignal */
+    void reply(const std::string &sessionID,
+               const GDBusCXX::DBusArray<uint8_t> &buffer,
+               const std::string &type,
+               const std::string &url,
+               bool final);
+    /** close Connection after final reply, triggered via Peer::m_close */
+    void close(const std::string &sessionID);
+
+    /** Connection::m_abortSignal */
+    void abort(const std::string &sessionID);
+    /** Connection::m_detachSignal */
+    void detach(const std::string &sessionID);
+
+    /**
+     * drop reference to Connection (if still around) and
+     * remember the peer for resends
+     */
+    void retire(Peer &peer);
+};
+
+SE_END_CXX
+
+#endif // ENABLE_LIBSOUP
+#endif // HTTP_SERVER_H
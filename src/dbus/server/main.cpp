@@ -26,6 +26,7 @@
 #include "server.h"
 #include "restart.h"
 #include "session-common.h"
+#include "http-server.h"
 
 #include <syncevo/SyncContext.h>
 #include <syncevo/SuspendFlags.h>
@@ -71,6 +72,7 @@ int main(int argc, char **argv, char **envp)
     restart.reset(new Restart(argv, envp));
 
     int duration = 600;
+    int httpPort = 0;
     int opt = 1;
     while(opt < argc) {
         if(argv[opt][0] != '-') {
@@ -83,6 +85,18 @@ int main(int argc, char **argv, char **envp)
                 std::cout << argv[opt-1] << ": unknown parameter value or not set" << std::endl;
                 return false;
             }
+        } else if (boost::iequals(argv[opt], "--http-port")) {
+            // serve SyncML via HTTP directly, instead of
+            // test/syncevo-http-server.py
+            opt++;
+            if (opt == argc || (httpPort = atoi(argv[opt])) <= 0) {
+                std::cout << argv[opt-1] << ": unknown parameter value or not set" << std::endl;
+                return false;
+            }
+#ifndef ENABLE_LIBSOUP
+            std::cout << argv[opt-1] << ": not supported, compiled without libsoup" << std::endl;
+            return false;
+#endif
         } else {
             std::cout << argv[opt] << ": unknown parameter" << std::endl;
             return false;
@@ -146,6 +160,13 @@ int main(int argc, char **argv, char **envp)
         boost::scoped_ptr<SyncEvo::Server> server(new SyncEvo::Server(loop, shutdownRequested, restart, conn, duration));
         server->activate();
 
+#ifdef ENABLE_LIBSOUP
+        boost::scoped_ptr<HTTPServer> httpServer;
+        if (httpPort) {
+            httpServer.reset(new HTTPServer(*server, httpPort));
+        }
+#endif
+
         if (gdbus) {
             unsetenv("G_DBUS_DEBUG");
         }
@@ -153,6 +174,9 @@ int main(int argc, char **argv, char **envp)
         dbus_bus_connection_undelay(conn);
         server->run();
         SE_LOG_DEBUG(NULL, NULL, "cleaning up");
+#ifdef ENABLE_LIBSOUP
+        httpServer.reset();
+#endif
         server.reset();
         obj.reset();
         guard.reset();
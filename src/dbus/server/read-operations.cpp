@@ -21,6 +21,7 @@
 #include "dbus-user-interface.h"
 #include "server.h"
 #include "dbus-sync.h"
+#include "config-cache.h"
 
 #include <syncevo/IniConfigNode.h>
 
@@ -44,7 +45,7 @@ void ReadOperations::getConfigs(bool getTemplates, std::vector<std::string> &con
         //clear existing templates in dbus server
         m_server.clearPeerTempls();
 
-        SyncConfig::TemplateList list = SyncConfig::getPeerTemplates(devices);
+        SyncConfig::TemplateList list = m_server.getConfigCache().getPeerTemplates(devices);
         std::map<std::string, int> numbers;
         BOOST_FOREACH(const boost::shared_ptr<SyncConfig::TemplateDescription> peer, list) {
             //if it is not a template for device
@@ -69,7 +70,7 @@ void ReadOperations::getConfigs(bool getTemplates, std::vector<std::string> &con
             }
         }
     } else {
-        SyncConfig::ConfigList list = SyncConfig::getConfigs();
+        SyncConfig::ConfigList list = m_server.getConfigCache().getConfigs();
         BOOST_FOREACH(const SyncConfig::ConfigList::value_type &server, list) {
             configNames.push_back(server.first);
         }
@@ -97,6 +98,46 @@ boost::shared_ptr<SyncConfig> ReadOperations::getLocalConfig(const string &confi
     return syncConfig;
 }
 
+/**
+ * Try to check passwords and read them from the keyring, environment
+ * or user if possible. The resolved values end up in the config
+ * nodes. If a config is given, they are also copied into it; this is
+ * needed for configs coming from the ConfigCache, which never stores
+ * passwords.
+ */
+static void checkPasswords(const std::string &configName,
+                           SyncConfig &syncConfig,
+                           ReadOperations::Config_t *config)
+{
+    DBusUserInterface ui(syncConfig.getKeyring());
+    ConfigPropertyRegistry &registry = SyncConfig::getRegistry();
+    BOOST_FOREACH(const ConfigProperty *prop, registry) {
+        prop->checkPassword(ui, configName, *syncConfig.getProperties());
+        if (config && dynamic_cast<const PasswordConfigProperty *>(prop)) {
+            InitStateString value = prop->getProperty(*syncConfig.getProperties());
+            if (value.wasSet()) {
+                (*config)[""][prop->getMainName()] = value;
+            }
+        }
+    }
+    list<string> configuredSources = syncConfig.getSyncSources();
+    BOOST_FOREACH(const string &sourceName, configuredSources) {
+        ConfigPropertyRegistry &registry = SyncSourceConfig::getRegistry();
+        SyncSourceNodes sourceNodes = syncConfig.getSyncSourceNodes(sourceName);
+
+        BOOST_FOREACH(const ConfigProperty *prop, registry) {
+            prop->checkPassword(ui, configName, *syncConfig.getProperties(),
+                                sourceName, sourceNodes.getProperties());
+            if (config && dynamic_cast<const PasswordConfigProperty *>(prop)) {
+                InitStateString value = prop->getProperty(*sourceNodes.getProperties());
+                if (value.wasSet()) {
+                    (*config)["source/" + sourceName][prop->getMainName()] = value;
+                }
+            }
+        }
+    }
+}
+
 void ReadOperations::getConfig(bool getTemplate,
                                Config_t &config)
 {
@@ -111,6 +152,9 @@ void ReadOperations::getNamedConfig(const std::string &configName,
     boost::shared_ptr<SyncConfig> dbusConfig;
     SyncConfig *syncConfig;
     string syncURL;
+    // Only unmodified local configs are cached. The cache strips
+    // passwords, they get resolved again on each call.
+    bool cacheable = false;
     /** get server template */
     if(getTemplate) {
         string peer, context;
@@ -175,23 +219,15 @@ void ReadOperations::getNamedConfig(const std::string &configName,
         }
         syncConfig = dbusConfig.get();
     } else {
-        dbusConfig = getLocalConfig(configName);
-        DBusUserInterface ui(dbusConfig->getKeyring());
-        //try to check password and read password from gnome keyring if possible
-        ConfigPropertyRegistry& registry = SyncConfig::getRegistry();
-        BOOST_FOREACH(const ConfigProperty *prop, registry) {
-            prop->checkPassword(ui, configName, *dbusConfig->getProperties());
-        }
-        list<string> configuredSources = dbusConfig->getSyncSources();
-        BOOST_FOREACH(const string &sourceName, configuredSources) {
-            ConfigPropertyRegistry& registry = SyncSourceConfig::getRegistry();
-            SyncSourceNodes sourceNodes = dbusConfig->getSyncSourceNodes(sourceName);
-
-            BOOST_FOREACH(const ConfigProperty *prop, registry) {
-                prop->checkPassword(ui, configName, *dbusConfig->getProperties(),
-                        sourceName, sourceNodes.getProperties());
+        if (!hasFilters()) {
+            if (m_server.getConfigCache().getNamedConfig(configName, config)) {
+                checkPasswords(configName, *getLocalConfig(configName), &config);
+                return;
             }
+            cacheable = true;
         }
+        dbusConfig = getLocalConfig(configName);
+        checkPasswords(configName, *dbusConfig, NULL);
         syncConfig = dbusConfig.get();
     }
 
@@ -241,6 +277,10 @@ void ReadOperations::getNamedConfig(const std::string &configName,
         }
         config.insert(pair<string, map<string, string> >( "source/" + name, localConfigs));
     }
+
+    if (cacheable) {
+        m_server.getConfigCache().setNamedConfig(configName, config);
+    }
 }
 
 void ReadOperations::getReports(uint32_t start, uint32_t count,
@@ -249,6 +289,9 @@ void ReadOperations::getReports(uint32_t start, uint32_t count,
     SyncContext client(m_configName, false);
     std::vector<string> dirs;
     client.getSessions(dirs);
+    ConfigCache &cache = m_server.getConfigCache();
+    boost::shared_ptr<SyncConfig> config(new SyncConfig(m_configName));
+    string storedPeerName = config->getPeerName();
 
     uint32_t index = 0;
     // newest report firstly
@@ -257,29 +300,30 @@ void ReadOperations::getReports(uint32_t start, uint32_t count,
         if(index >= start && index - start < count) {
             const string &dir = dirs[i];
             std::map<string, string> aReport;
-            // insert a 'dir' as an ID for the current report
-            aReport.insert(pair<string, string>("dir", dir));
-            SyncReport report;
-            // peerName is also extracted from the dir
-            string peerName = client.readSessionInfo(dir,report);
-            boost::shared_ptr<SyncConfig> config(new SyncConfig(m_configName));
-            string storedPeerName = config->getPeerName();
+            if (!cache.getReport(dir, aReport)) {
+                // insert a 'dir' as an ID for the current report
+                aReport.insert(pair<string, string>("dir", dir));
+                SyncReport report;
+                // peerName is also extracted from the dir
+                string peerName = client.readSessionInfo(dir,report);
+
+                /** serialize report to ConfigProps and then copy them to reports */
+                IniHashConfigNode node("/dev/null","",true);
+                node << report;
+                ConfigProps props;
+                node.readProperties(props);
+
+                BOOST_FOREACH(const ConfigProps::value_type &entry, props) {
+                    aReport.insert(entry);
+                }
+                // a new key-value pair <"peer", [peer name]> is transferred
+                aReport.insert(pair<string, string>("peer", peerName));
+                cache.setReport(dir, aReport);
+            }
             //if can't find peer name, use the peer name from the log dir
             if(!storedPeerName.empty()) {
-                peerName = storedPeerName;
-            }
-
-            /** serialize report to ConfigProps and then copy them to reports */
-            IniHashConfigNode node("/dev/null","",true);
-            node << report;
-            ConfigProps props;
-            node.readProperties(props);
-
-            BOOST_FOREACH(const ConfigProps::value_type &entry, props) {
-                aReport.insert(entry);
+                aReport["peer"] = storedPeerName;
             }
-            // a new key-value pair <"peer", [peer name]> is transferred
-            aReport.insert(pair<string, string>("peer", peerName));
             reports.push_back(aReport);
         }
         index++;
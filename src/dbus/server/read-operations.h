@@ -84,6 +84,12 @@ private:
      */
     virtual bool setFilters(SyncConfig &config) { return false; }
 
+    /**
+     * True if setFilters() would set filters. Results obtained
+     * with filters are not cached.
+     */
+    virtual bool hasFilters() const { return false; }
+
     /**
      * utility method which constructs a SyncConfig which references a local configuration (never a template)
      *
@@ -33,6 +33,7 @@
 #include "restart.h"
 #include "client.h"
 #include "auto-sync-manager.h"
+#include "http-server.h"
 
 #include <boost/pointer_cast.hpp>
 
@@ -88,9 +89,21 @@ vector<string> Server::getCapabilities()
     capabilities.push_back("SessionFlags");
     capabilities.push_back("SessionAttach");
     capabilities.push_back("DatabaseProperties");
+    capabilities.push_back("CacheStatistics");
+    capabilities.push_back("HTTPStatistics");
     return capabilities;
 }
 
+StringMap Server::getHTTPStatistics()
+{
+#ifdef ENABLE_LIBSOUP
+    if (m_httpServer) {
+        return m_httpServer->getStatistics();
+    }
+#endif
+    return StringMap();
+}
+
 StringMap Server::getVersions()
 {
     StringMap versions;
@@ -237,6 +250,7 @@ Server::Server(GMainLoop *loop,
     m_shutdownRequested(shutdownRequested),
     m_restart(restart),
     m_lastSession(time(NULL)),
+    m_httpServer(NULL),
     m_activeSession(NULL),
     m_lastInfoReq(0),
     m_bluezManager(new BluezManager(*this)),
@@ -257,6 +271,8 @@ Server::Server(GMainLoop *loop,
     srand(tv.tv_usec);
     add(this, &Server::getCapabilities, "GetCapabilities");
     add(this, &Server::getVersions, "GetVersions");
+    add(this, &Server::getCacheStatistics, "GetCacheStatistics");
+    add(this, &Server::getHTTPStatistics, "GetHTTPStatistics");
     add(this, &Server::attachClient, "Attach");
     add(this, &Server::detachClient, "Detach");
     add(this, &Server::enableNotifications, "EnableNotifications");
@@ -299,6 +315,8 @@ Server::Server(GMainLoop *loop,
 
     // connect ConfigChanged signal to source for that information
     m_configChangedSignal.connect(boost::bind(boost::ref(configChanged)));
+    // cached config information is stale now
+    m_configChangedSignal.connect(boost::bind(&ConfigCache::invalidate, &m_configCache, std::string("config changed")));
 
     // create auto sync manager, now that server is ready
     m_autoSync = AutoSyncManager::createAutoSyncManager(*this);
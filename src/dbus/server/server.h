@@ -33,6 +33,7 @@
 #include "presence-status.h"
 #include "timeout.h"
 #include "dbus-callbacks.h"
+#include "config-cache.h"
 
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
@@ -46,6 +47,7 @@ class Restart;
 class Client;
 class GLibNotify;
 class AutoSyncManager;
+class HTTPServer;
 
 /**
  * Implements the main org.syncevolution.Server interface.
@@ -89,6 +91,12 @@ class Server : public GDBusCXX::DBusObjectHelper,
     void fileModified();
     bool shutdown();
 
+    /** parsed configs and reports for ReadOperations */
+    ConfigCache m_configCache;
+
+    /** built-in SyncML HTTP server, NULL if not enabled */
+    HTTPServer *m_httpServer;
+
     /**
      * timer which counts seconds until server is meant to shut down
      */
@@ -176,6 +184,12 @@ class Server : public GDBusCXX::DBusObjectHelper,
     /** Server.GetVersions() */
     StringMap getVersions();
 
+    /** Server.GetCacheStatistics() */
+    StringMap getCacheStatistics() { return m_configCache.getStatistics(); }
+
+    /** Server.GetHTTPStatistics() */
+    StringMap getHTTPStatistics();
+
     /** Server.Attach() */
     void attachClient(const GDBusCXX::Caller_t &caller,
                       const boost::shared_ptr<GDBusCXX::Watch> &watch);
@@ -550,6 +564,14 @@ public:
                                              const Session &session);
     void autoTermRef(int counts = 1) { m_autoTerm.ref(counts); }
 
+    ConfigCache &getConfigCache() { return m_configCache; }
+
+    /** called by HTTPServer when it starts (this) and stops (NULL) */
+    void setHTTPServer(HTTPServer *httpServer) { m_httpServer = httpServer; }
+
+    /** true once the server started to shut down, no new sessions allowed */
+    bool shutdownRequested() const { return m_shutdownRequested; }
+
     void autoTermUnref(int counts = 1) { m_autoTerm.unref(counts); }
 
     /** callback to reset for auto termination checking */
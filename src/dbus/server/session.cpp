@@ -238,6 +238,8 @@ void Session::setNamedConfig(const std::string &configName,
         if(syncConfig.get()) {
             syncConfig->remove();
             m_setConfig = true;
+            // inotify is too slow for the next read in this session
+            m_server.getConfigCache().invalidate("config removed");
         }
         return;
     }
@@ -317,6 +319,8 @@ void Session::setNamedConfig(const std::string &configName,
         syncConfig->preFlush(syncConfig->getUserInterfaceNonNull());
         syncConfig->flush();
         m_setConfig = true;
+        // inotify is too slow for the next read in this session
+        m_server.getConfigCache().invalidate("config written");
     }
 }
 
@@ -488,38 +492,51 @@ void Session::getProgress(int32_t &progress,
 }
 
 void Session::fireStatus(bool flush)
+{
+    if (flush) {
+        // clients should see progress and status in the right order
+        m_progressThrottle.flush();
+    }
+    m_statusThrottle.fire(flush);
+}
+
+void Session::emitStatusNow()
 {
     Session::LoggingGuard guard(this);
     std::string status;
     uint32_t error;
     SourceStatuses_t sources;
 
-    /** not force flushing and not timeout, return */
-    if(!flush && !m_statusTimer.timeout()) {
-        return;
-    }
-    m_statusTimer.reset();
-
     getStatus(status, error, sources);
     emitStatus(status, error, sources);
 }
 
 void Session::fireProgress(bool flush)
+{
+    m_progressThrottle.fire(flush);
+}
+
+void Session::emitProgressNow()
 {
     Session::LoggingGuard guard(this);
     int32_t progress;
     SourceProgresses_t sources;
 
-    /** not force flushing and not timeout, return */
-    if(!flush && !m_progressTimer.timeout()) {
-        return;
-    }
-    m_progressTimer.reset();
-
     getProgress(progress, sources);
     emitProgress(progress, sources);
 }
 
+/**
+ * Minimum time between two StatusChanged resp. ProgressChanged
+ * signals in milliseconds, defaultMs unless overridden by
+ * SYNCEVOLUTION_DBUS_SIGNAL_INTERVAL.
+ */
+static unsigned long signalInterval(unsigned long defaultMs)
+{
+    const char *interval = getenv("SYNCEVOLUTION_DBUS_SIGNAL_INTERVAL");
+    return interval ? strtoul(interval, NULL, 10) : defaultMs;
+}
+
 boost::shared_ptr<Session> Session::createSession(Server &server,
                                                   const std::string &peerDeviceID,
                                                   const std::string &config_name,
@@ -559,8 +576,8 @@ Session::Session(Server &server,
     m_progress(0),
     m_progData(m_progress),
     m_error(0),
-    m_statusTimer(100),
-    m_progressTimer(50),
+    m_statusThrottle(signalInterval(100), boost::bind(&Session::emitStatusNow, this)),
+    m_progressThrottle(signalInterval(50), boost::bind(&Session::emitProgressNow, this)),
     m_restoreSrcTotal(0),
     m_restoreSrcEnd(0),
     m_runOperation(SessionCommon::OP_NULL),
@@ -680,6 +697,10 @@ void Session::doneCb(bool success) throw()
         }
 
         fireStatus(true);
+        SE_LOG_DEBUG(NULL, NULL, "session %s: %lu/%lu status and %lu/%lu progress signals sent/merged",
+                     getPath(),
+                     m_statusThrottle.getEmitted(), m_statusThrottle.getSuppressed(),
+                     m_progressThrottle.getEmitted(), m_progressThrottle.getSuppressed());
 
         boost::shared_ptr<Connection> connection = m_connection.lock();
         if (connection) {
@@ -1078,7 +1099,7 @@ void Session::sourceProgress(sysync::TProgressEventEnum type,
                 progress.m_prepareCount = extra1;
                 progress.m_prepareTotal = extra2;
                 m_progData.itemPrepare();
-                fireProgress(true);
+                fireProgress();
             } else {
                 // Check whether the sources where created.
                 if (sourceProgressCreated) {
@@ -1094,7 +1115,7 @@ void Session::sourceProgress(sysync::TProgressEventEnum type,
                 progress.m_phase     = "sending";
                 progress.m_sendCount = extra1;
                 progress.m_sendTotal = extra2;
-                fireProgress(true);
+                fireProgress();
             }
             break;
         case sysync::PEV_ITEMRECEIVED:
@@ -1103,7 +1124,7 @@ void Session::sourceProgress(sysync::TProgressEventEnum type,
                 progress.m_receiveCount = extra1;
                 progress.m_receiveTotal = extra2;
                 m_progData.itemReceive(sourceName, extra1, extra2);
-                fireProgress(true);
+                fireProgress();
             }
             break;
         case sysync::PEV_ALERTED:
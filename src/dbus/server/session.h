@@ -35,6 +35,7 @@
 #include "source-status.h"
 #include "timer.h"
 #include "timeout.h"
+#include "throttle.h"
 #include "resource.h"
 #include "dbus-callbacks.h"
 
@@ -218,9 +219,12 @@ class Session : public GDBusCXX::DBusObjectHelper,
                         SyncMode sourceSyncMode,
                         int32_t extra1, int32_t extra2, int32_t extra3);
 
-    /** timer for fire status/progress usages */
-    Timer m_statusTimer;
-    Timer m_progressTimer;
+    /**
+     * Rate limiting for StatusChanged and ProgressChanged. The
+     * interval can be set with SYNCEVOLUTION_DBUS_SIGNAL_INTERVAL.
+     */
+    Throttle m_statusThrottle;
+    Throttle m_progressThrottle;
 
     /** the total number of sources to be restored */
     int m_restoreSrcTotal;
@@ -281,8 +285,9 @@ class Session : public GDBusCXX::DBusObjectHelper,
      * Ensures that the corresponding D-Bus signal is sent.
      *
      * Doesn't always send the signal immediately, because often it is
-     * likely that more status changes will follow shortly. To ensure
-     * that the "final" status is sent, call with flush=true.
+     * likely that more status changes will follow shortly. Such
+     * changes are sent together a bit later. To send the status
+     * right away (state transitions), call with flush=true.
      *
      * @param flush      force sending the current status
      */
@@ -290,6 +295,10 @@ class Session : public GDBusCXX::DBusObjectHelper,
     /** like fireStatus() for progress information */
     void fireProgress(bool flush = false);
 
+    /** send current status resp. progress, called by throttles */
+    void emitStatusNow();
+    void emitProgressNow();
+
     /** Session.StatusChanged */
     GDBusCXX::EmitSignal3<const std::string &,
                           uint32_t,
@@ -477,6 +486,7 @@ public:
 private:
     /** set m_syncFilter and m_sourceFilters to config */
     virtual bool setFilters(SyncConfig &config);
+    virtual bool hasFilters() const { return m_tempConfig; }
 
     void dbusResultCb(const std::string &operation, bool success, const std::string &error) throw();
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2011 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#ifndef THROTTLE_H
+#define THROTTLE_H
+
+#include "timer.h"
+#include "timeout.h"
+
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/utility.hpp>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+/**
+ * Rate limiting for signals which report the current value of
+ * something (status, progress): intermediate values may be skipped,
+ * the latest one must not. fire() emits at most once per interval;
+ * changes in between are coalesced into one emission at the end of
+ * the interval.
+ */
+class Throttle : boost::noncopyable
+{
+    unsigned long m_intervalMs;
+    boost::function<void ()> m_emit;
+    Timer m_timer;
+    /** true once something was emitted, m_timer is valid */
+    bool m_emittedOnce;
+    /** pending change, emitted when m_pending triggers */
+    Timeout m_pending;
+    bool m_isPending;
+    unsigned long m_emitted;
+    unsigned long m_suppressed;
+
+    void emit()
+    {
+        if (m_isPending) {
+            m_pending.deactivate();
+            m_isPending = false;
+        }
+        send();
+    }
+
+    /** called by m_pending, which must not be deactivated while it runs */
+    void pendingCb()
+    {
+        m_isPending = false;
+        send();
+    }
+
+    void send()
+    {
+        m_timer.reset();
+        m_emittedOnce = true;
+        m_emitted++;
+        m_emit();
+    }
+
+ public:
+    /**
+     * @param intervalMs   minimum time between emissions
+     * @param emit         sends the current value
+     */
+    Throttle(unsigned long intervalMs, const boost::function<void ()> &emit) :
+        m_intervalMs(intervalMs),
+        m_emit(emit),
+        m_timer(intervalMs),
+        m_emittedOnce(false),
+        m_isPending(false),
+        m_emitted(0),
+        m_suppressed(0)
+    {}
+
+    /**
+     * Value has changed. Emit immediately if flush is true or the
+     * interval has passed, otherwise remember the change.
+     */
+    void fire(bool flush = false)
+    {
+        if (flush || !m_emittedOnce || m_timer.timeout()) {
+            emit();
+        } else {
+            m_suppressed++;
+            if (!m_isPending) {
+                m_isPending = true;
+                m_pending.runOnceMs(m_intervalMs,
+                                    boost::bind(&Throttle::pendingCb, this));
+            }
+        }
+    }
+
+    /** emit pending change now, if there is one */
+    void flush()
+    {
+        if (m_isPending) {
+            emit();
+        }
+    }
+
+    /** number of emissions */
+    unsigned long getEmitted() const { return m_emitted; }
+    /** number of fire() calls merged into a later emission */
+    unsigned long getSuppressed() const { return m_suppressed; }
+};
+
+SE_END_CXX
+
+#endif // THROTTLE_H
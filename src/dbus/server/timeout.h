@@ -75,7 +75,29 @@ public:
     void runOnce(int seconds,
                  const boost::function<void ()> &callback)
     {
-        activate(seconds, boost::bind(&Timeout::once, callback));
+        deactivate();
+
+        m_callback = boost::bind(&Timeout::once, callback);
+        m_tag = g_timeout_add_seconds(seconds, triggeredOnce, static_cast<gpointer>(this));
+        if (!m_tag) {
+            SE_THROW("g_timeout_add_seconds() failed");
+        }
+    }
+
+    /**
+     * invoke the callback once, with millisecond resolution;
+     * use runOnce() for longer timeouts, it wakes up less often
+     */
+    void runOnceMs(int milliseconds,
+                   const boost::function<void ()> &callback)
+    {
+        deactivate();
+
+        m_callback = boost::bind(&Timeout::once, callback);
+        m_tag = g_timeout_add(milliseconds, triggeredOnce, static_cast<gpointer>(this));
+        if (!m_tag) {
+            SE_THROW("g_timeout_add() failed");
+        }
     }
 
     /**
@@ -106,6 +128,25 @@ private:
         return false;
     }
 
+    static gboolean triggeredOnce(gpointer data) throw ()
+    {
+        try {
+            Timeout *me = static_cast<Timeout *>(data);
+            // The source is removed by returning false, so forget
+            // about it before invoking the callback. The callback may
+            // activate the timeout again or destroy the instance, so
+            // take it over and don't touch "me" afterwards.
+            boost::function<bool ()> callback;
+            callback.swap(me->m_callback);
+            me->m_tag = 0;
+            callback();
+        } catch (...) {
+            // Something unexpected went wrong, can only shut down.
+            Exception::handle(HANDLE_EXCEPTION_FATAL);
+        }
+        return false;
+    }
+
     static bool once(const boost::function<void ()> &callback) {
         callback();
         return false;
@@ -3566,6 +3566,8 @@ protected:
                               "\n"
                               "enableRefreshSync (FALSE, unshared)\n"
                               "\n"
+                              "enableCompression (FALSE, unshared)\n"
+                              "\n"
                               "maxMsgSize (150000, unshared), maxObjSize (4000000, unshared)\n"
                               "\n"
                               "SSLServerCertificates (" SYNCEVOLUTION_SSL_SERVER_CERTIFICATES ", unshared)\n"
@@ -4479,6 +4481,7 @@ private:
                          "peers/scheduleworld/config.ini:# remoteDeviceId = \n"
                          "peers/scheduleworld/config.ini:# enableWBXML = 1\n"
                          "peers/scheduleworld/config.ini:# enableRefreshSync = 0\n"
+                         "peers/scheduleworld/config.ini:# enableCompression = 0\n"
                          "peers/scheduleworld/config.ini:# maxMsgSize = 150000\n"
                          "peers/scheduleworld/config.ini:# maxObjSize = 4000000\n"
                          "peers/scheduleworld/config.ini:# SSLServerCertificates = \n"
@@ -4595,6 +4598,7 @@ private:
             "spds/syncml/config.txt:# remoteDeviceId = \n"
             "spds/syncml/config.txt:# enableWBXML = 1\n"
             "spds/syncml/config.txt:# enableRefreshSync = 0\n"
+            "spds/syncml/config.txt:# enableCompression = 0\n"
             "spds/syncml/config.txt:# maxMsgSize = 150000\n"
             "spds/syncml/config.txt:# maxObjSize = 4000000\n"
 #ifdef ENABLE_LIBSOUP
@@ -24,43 +24,111 @@
 
 #include <algorithm>
 #include <ctime>
+#include <strings.h>
 #include <syncevo/util.h>
+#include <syncevo/Logging.h>
+#include <syncevo/HTTPConnectionPool.h>
+
+#include <boost/algorithm/string/trim.hpp>
 
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
 
 
 CurlTransportAgent::CurlTransportAgent() :
-    m_easyHandle(easyInit()),
+    m_easyHandle(NULL),
     m_slist(NULL),
     m_status(INACTIVE),
     m_timeoutSeconds(0),
+    m_proxySet(false),
+    m_verifyServer(true),
+    m_verifyHost(true),
     m_reply(NULL),
     m_replyLen(0),
-    m_replySize(0)
+    m_replySize(0),
+    m_replyContent(NULL),
+    m_replyContentLen(0)
 {
+    m_curlErrorText[0] = 0;
+}
+
+void CurlTransportAgent::setupHandle()
+{
+    std::string key = HTTPConnectionPool::makeKey("curl", m_url, m_proxy,
+                                                  StringPrintf("%s %d %d",
+                                                               m_cacerts.c_str(),
+                                                               m_verifyServer,
+                                                               m_verifyHost));
+    if (m_easyHandle) {
+        if (key == m_key) {
+            return;
+        }
+        // different server, switch to a handle for it
+        releaseHandle();
+    }
+
+    HTTPConnectionPool::Handle handle = HTTPConnectionPool::get().acquire(key);
+    if (handle) {
+        SE_LOG_DEBUG(NULL, NULL, "reusing curl handle for %s", key.c_str());
+    } else {
+        handle.reset(easyInit(), curl_easy_cleanup);
+    }
+    CURL *easyHandle = static_cast<CURL *>(handle.get());
+
 #ifdef ENABLE_MAEMO /* hack because Maemo doesn't support IPv6 yet */
-    curl_easy_setopt(m_easyHandle, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
+    curl_easy_setopt(easyHandle, CURLOPT_IPRESOLVE, CURL_IPRESOLVE_V4);
 #endif
     /*
      * set up for post where message is pushed into curl via
      * its read callback and reply is stored in write callback
      */
     CURLcode code;
-    if ((code = curl_easy_setopt(m_easyHandle, CURLOPT_NOPROGRESS, false)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_PROGRESSFUNCTION, progressCallback)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_WRITEFUNCTION, writeDataCallback)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_WRITEDATA, (void *)this)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_READFUNCTION, readDataCallback)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_READDATA, (void *)this)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_ERRORBUFFER, this->m_curlErrorText )) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_AUTOREFERER, true)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_POST, true)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_FOLLOWLOCATION, true))) {
+    if ((code = curl_easy_setopt(easyHandle, CURLOPT_NOPROGRESS, false)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_PROGRESSFUNCTION, progressCallback)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_WRITEFUNCTION, writeDataCallback)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_WRITEDATA, (void *)this)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_HEADERFUNCTION, headerCallback)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_HEADERDATA, (void *)this)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_READFUNCTION, readDataCallback)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_READDATA, (void *)this)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_ERRORBUFFER, this->m_curlErrorText )) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_AUTOREFERER, true)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_POST, true)) ||
+        (code = curl_easy_setopt(easyHandle, CURLOPT_FOLLOWLOCATION, true)) ||
+        (m_proxySet &&
+         (code = curl_easy_setopt(easyHandle, CURLOPT_PROXY, m_proxy.c_str()))) ||
+        (!m_auth.empty() &&
+         (code = curl_easy_setopt(easyHandle, CURLOPT_PROXYUSERPWD, m_auth.c_str()))) ||
+        (!m_agent.empty() &&
+         (code = curl_easy_setopt(easyHandle, CURLOPT_USERAGENT, m_agent.c_str())))) {
         /* error encountered, throw exception */
-        curl_easy_cleanup(m_easyHandle);
         checkCurl(code);
     }
+
+    if (!m_cacerts.empty()) {
+        if (isDir(m_cacerts)) {
+            // libcurl + OpenSSL does not work with a directory set in CURLOPT_CAINFO.
+            // Must set the directory name as CURLOPT_CAPATH.
+            //
+            // Hopefully libcurl NSS also finds the directory name
+            // here ("NSS-powered libcurl provides the option only for
+            // backward compatibility. ").
+            code = curl_easy_setopt(easyHandle, CURLOPT_CAPATH, m_cacerts.c_str());
+        } else {
+            code = curl_easy_setopt(easyHandle, CURLOPT_CAINFO, m_cacerts.c_str());
+        }
+    }
+    if (!code) {
+        code = curl_easy_setopt(easyHandle, CURLOPT_SSL_VERIFYPEER, (long)m_verifyServer);
+    }
+    if (!code) {
+        code = curl_easy_setopt(easyHandle, CURLOPT_SSL_VERIFYHOST, (long)(m_verifyHost ? 2 : 0));
+    }
+    checkCurl(code);
+
+    m_handle = handle;
+    m_easyHandle = easyHandle;
+    m_key = key;
 }
 
 CURL *CurlTransportAgent::easyInit()
@@ -88,30 +156,42 @@ CurlTransportAgent::~CurlTransportAgent()
     if (m_reply) {
         free(m_reply);
     }
-    curl_easy_cleanup(m_easyHandle);
+    releaseHandle();
     curl_slist_free_all(m_slist);
 }
 
+void CurlTransportAgent::releaseHandle()
+{
+    if (!m_easyHandle) {
+        return;
+    }
+    // Keep the handle only if the last transfer went through,
+    // otherwise the connection might be in a bad state.
+    if (m_status == INACTIVE || m_status == GOT_REPLY) {
+        // Forget about all settings, in particular the callback data
+        // and header list which point into this instance, but keep
+        // connections and TLS session IDs.
+        curl_easy_reset(m_easyHandle);
+        HTTPConnectionPool::get().release(m_key, m_handle);
+    }
+    m_handle.reset();
+    m_easyHandle = NULL;
+}
+
 void CurlTransportAgent::setURL(const std::string &url)
 {
     m_url = url;
-    CURLcode code = curl_easy_setopt(m_easyHandle, CURLOPT_URL, m_url.c_str());
-    checkCurl(code);
 }
 
 void CurlTransportAgent::setProxy(const std::string &proxy)
 {
     m_proxy = proxy;
-    CURLcode code = curl_easy_setopt(m_easyHandle, CURLOPT_PROXY, m_proxy.c_str());
-    checkCurl(code);
+    m_proxySet = true;
 }
 
 void CurlTransportAgent::setProxyAuth(const std::string &user, const std::string &password)
 {
     m_auth = user + ":" + password;
-    CURLcode code = curl_easy_setopt(m_easyHandle, CURLOPT_PROXYUSERPWD,
-                                     m_auth.c_str());
-    checkCurl(code);
 }
 
 void CurlTransportAgent::setContentType(const std::string &type)
@@ -122,38 +202,17 @@ void CurlTransportAgent::setContentType(const std::string &type)
 void CurlTransportAgent::setUserAgent(const std::string &agent)
 {
     m_agent = agent;
-    CURLcode code = curl_easy_setopt(m_easyHandle, CURLOPT_USERAGENT,
-                                     m_agent.c_str());
-    checkCurl(code);
 }
 
 void CurlTransportAgent::setSSL(const std::string &cacerts,
                                 bool verifyServer,
                                 bool verifyHost)
 {
+    // applied in setupHandle(), because they are part of the key
+    // under which the handle is pooled
     m_cacerts = cacerts;
-    CURLcode code = CURLE_OK;
-
-    if (!m_cacerts.empty()) {
-        if (isDir(m_cacerts)) {
-            // libcurl + OpenSSL does not work with a directory set in CURLOPT_CAINFO.
-            // Must set the directory name as CURLOPT_CAPATH.
-            //
-            // Hopefully libcurl NSS also finds the directory name
-            // here ("NSS-powered libcurl provides the option only for
-            // backward compatibility. ").
-            code = curl_easy_setopt(m_easyHandle, CURLOPT_CAPATH, m_cacerts.c_str());
-        } else {
-            code = curl_easy_setopt(m_easyHandle, CURLOPT_CAINFO, m_cacerts.c_str());
-        }
-    }
-    if (!code) {
-        code = curl_easy_setopt(m_easyHandle, CURLOPT_SSL_VERIFYPEER, (long)verifyServer);
-    }
-    if (!code) {
-        code = curl_easy_setopt(m_easyHandle, CURLOPT_SSL_VERIFYHOST, (long)(verifyHost ? 2 : 0));
-    }
-    checkCurl(code);
+    m_verifyServer = verifyServer;
+    m_verifyHost = verifyHost;
 }
 
 void CurlTransportAgent::setTimeout(int seconds)
@@ -168,11 +227,18 @@ void CurlTransportAgent::shutdown()
 void CurlTransportAgent::send(const char *data, size_t len)
 {
     CURLcode code;
+    const char *message = data;
+    size_t messageLen = len;
+    std::string encoding;
+    encodeMessage(message, messageLen, encoding);
 
     m_replyLen = 0;
-    m_message = data;
+    m_replyEncoding = "";
+    m_replyContent = NULL;
+    m_replyContentLen = 0;
+    m_message = message;
     m_messageSent = 0;
-    m_messageLen = len;
+    m_messageLen = messageLen;
 
     curl_slist_free_all(m_slist);
     m_slist = NULL;
@@ -188,15 +254,24 @@ void CurlTransportAgent::send(const char *data, size_t len)
     std::string contentHeader("Content-Type: ");
     contentHeader += m_contentType;
     m_slist = curl_slist_append(m_slist, contentHeader.c_str());
+    if (!encoding.empty()) {
+        m_slist = curl_slist_append(m_slist, ("Content-Encoding: " + encoding).c_str());
+    }
+    std::string acceptEncoding = getAcceptEncoding();
+    if (!acceptEncoding.empty()) {
+        m_slist = curl_slist_append(m_slist, ("Accept-Encoding: " + acceptEncoding).c_str());
+    }
 
     m_status = ACTIVE;
     if (m_timeoutSeconds) {
         m_sendStartTime = Timespec::monotonic();
     }
     m_aborting = false;
-    if ((code = curl_easy_setopt(m_easyHandle, CURLOPT_PROGRESSDATA, static_cast<void *> (this)))||
+    setupHandle();
+    if ((code = curl_easy_setopt(m_easyHandle, CURLOPT_URL, m_url.c_str())) ||
+        (code = curl_easy_setopt(m_easyHandle, CURLOPT_PROGRESSDATA, static_cast<void *> (this)))||
         (code = curl_easy_setopt(m_easyHandle, CURLOPT_HTTPHEADER, m_slist)) ||
-        (code = curl_easy_setopt(m_easyHandle, CURLOPT_POSTFIELDSIZE, len))
+        (code = curl_easy_setopt(m_easyHandle, CURLOPT_POSTFIELDSIZE, messageLen))
        ){
         m_status = CANCELED;
         checkCurl(code);
@@ -206,10 +281,43 @@ void CurlTransportAgent::send(const char *data, size_t len)
         m_status = FAILED;
         checkCurl(code, false);
     } else {
+        countConnections();
+        long httpStatus = 0;
+        curl_easy_getinfo(m_easyHandle, CURLINFO_RESPONSE_CODE, &httpStatus);
+        if (compressionRejected(httpStatus, encoding, m_reply, m_replyLen)) {
+            send(data, len);
+            return;
+        }
+        m_replyContent = m_reply;
+        m_replyContentLen = m_replyLen;
+        decodeReply(m_replyContent, m_replyContentLen, m_replyEncoding);
         m_status = GOT_REPLY;
     }
 }
 
+void CurlTransportAgent::countConnections()
+{
+    long connects = 0;
+    if (curl_easy_getinfo(m_easyHandle, CURLINFO_NUM_CONNECTS, &connects)) {
+        return;
+    }
+    HTTPConnectionPool &pool = HTTPConnectionPool::get();
+    if (connects) {
+        // time until the connection was ready for the request,
+        // including the TLS handshake
+        double seconds = 0;
+#if LIBCURL_VERSION_NUM >= 0x071300
+        curl_easy_getinfo(m_easyHandle, CURLINFO_APPCONNECT_TIME, &seconds);
+#endif
+        if (!seconds) {
+            curl_easy_getinfo(m_easyHandle, CURLINFO_CONNECT_TIME, &seconds);
+        }
+        pool.connected(seconds);
+    } else {
+        pool.reused();
+    }
+}
+
 void CurlTransportAgent::cancel()
 {
     /* nothing to do */
@@ -222,10 +330,11 @@ TransportAgent::Status CurlTransportAgent::wait(bool noReply)
 
 void CurlTransportAgent::getReply(const char *&data, size_t &len, std::string &contentType)
 {
-    data = m_reply;
-    len = m_replyLen;
+    data = m_replyContent;
+    len = m_replyContentLen;
     const char *curlContentType;
-    if (!curl_easy_getinfo(m_easyHandle, CURLINFO_CONTENT_TYPE, &curlContentType) &&
+    if (m_easyHandle &&
+        !curl_easy_getinfo(m_easyHandle, CURLINFO_CONTENT_TYPE, &curlContentType) &&
         curlContentType) {
         contentType = curlContentType;
     } else {
@@ -263,6 +372,31 @@ size_t CurlTransportAgent::writeData(void *buffer, size_t size) throw()
     return size;
 }
 
+size_t CurlTransportAgent::headerCallback(void *buffer, size_t size, size_t nmemb, void *stream) throw()
+{
+    return static_cast<CurlTransportAgent *>(stream)->header(static_cast<const char *>(buffer), size * nmemb);
+}
+
+size_t CurlTransportAgent::header(const char *buffer, size_t size) throw()
+{
+    static const char contentEncoding[] = "Content-Encoding:";
+    static const size_t contentEncodingLen = sizeof(contentEncoding) - 1;
+
+    // each response (including redirects) starts with a new status line
+    if (size >= 5 && !strncmp(buffer, "HTTP/", 5)) {
+        m_replyEncoding = "";
+    } else if (size > contentEncodingLen &&
+               !strncasecmp(buffer, contentEncoding, contentEncodingLen)) {
+        try {
+            m_replyEncoding = boost::trim_copy(std::string(buffer + contentEncodingLen,
+                                                           size - contentEncodingLen));
+        } catch (...) {
+            return 0;
+        }
+    }
+    return size;
+}
+
 size_t CurlTransportAgent::readDataCallback(void *buffer, size_t size, size_t nmemb, void *stream) throw()
 {
     return static_cast<CurlTransportAgent *>(stream)->readData(buffer, size * nmemb);
@@ -25,6 +25,7 @@
 #ifdef ENABLE_LIBCURL
 
 #include <syncevo/TransportAgent.h>
+#include <syncevo/HTTPConnectionPool.h>
 #include <curl/curl.h>
 
 #include <syncevo/declarations.h>
@@ -36,6 +37,11 @@ SE_BEGIN_CXX
  *
  * The simple curl API is used, so sending blocks until the
  * reply is ready.
+ *
+ * The curl easy handle is created when sending the first message
+ * and handed over to the HTTPConnectionPool when the agent is
+ * destroyed, so that the next agent for the same server can
+ * use the open connection.
  */
 class CurlTransportAgent : public HTTPTransportAgent
 {
@@ -61,7 +67,11 @@ class CurlTransportAgent : public HTTPTransportAgent
     void setAborting(bool aborting) {m_aborting = aborting;}
 
  private:
+    /** owns the easy handle, NULL until setupHandle() */
+    HTTPConnectionPool::Handle m_handle;
     CURL *m_easyHandle;
+    /** HTTPConnectionPool key of m_handle */
+    std::string m_key;
     curl_slist *m_slist;
     std::string m_contentType;
     Status m_status;
@@ -76,6 +86,8 @@ class CurlTransportAgent : public HTTPTransportAgent
      */
     std::string m_url, m_proxy, m_auth, m_agent,
         m_cacerts;
+    bool m_proxySet;
+    bool m_verifyServer, m_verifyHost;
 
     /** message buffer (owned by caller) */
     const char *m_message;
@@ -91,6 +103,12 @@ class CurlTransportAgent : public HTTPTransportAgent
     /** total buffer size */
     size_t m_replySize;
 
+    /** Content-Encoding of the reply, from the response headers */
+    std::string m_replyEncoding;
+    /** reply after decoding, points into m_reply or into HTTPTransportAgent */
+    const char *m_replyContent;
+    size_t m_replyContentLen;
+
     /** error text from curl, set via CURLOPT_ERRORBUFFER */
     char m_curlErrorText[CURL_ERROR_SIZE];
 
@@ -102,12 +120,32 @@ class CurlTransportAgent : public HTTPTransportAgent
     static size_t writeDataCallback(void *ptr, size_t size, size_t nmemb, void *stream) throw();
     size_t writeData(void *buffer, size_t size) throw();
 
+    /** CURLOPT_HEADERFUNCTION, stream == CurlTransportAgent */
+    static size_t headerCallback(void *buffer, size_t size, size_t nmemb, void *stream) throw();
+    size_t header(const char *buffer, size_t size) throw();
+
     /** CURLOPT_PROGRESS callback, use this function to detect user abort */
     static int progressCallback (void *ptr, double dltotal, double dlnow, double uptotal, double upnow);
 
     /** check curl error code and turn into exception */
     void checkCurl(CURLcode code, bool exception = true);
 
+    /**
+     * get a handle for the current URL, proxy and TLS settings,
+     * either from the pool or a new one, and configure it
+     */
+    void setupHandle();
+
+    /**
+     * hand handle over to the pool if it is still usable, otherwise
+     * free it; pooled handles are reset so that they no longer refer
+     * to this instance
+     */
+    void releaseHandle();
+
+    /** update HTTPConnectionPool statistics after a transfer */
+    void countConnections();
+
     /**
      * initialize curl if necessary, return new handle
      *
@@ -215,11 +215,29 @@ GLibNotify::GLibNotify(const char *file,
                            (void *)&m_callback);
 }
 
+GLibDirNotify::GLibDirNotify(const char *dir,
+                             const callback_t &callback) :
+    m_callback(callback)
+{
+    GFileCXX filecxx(g_file_new_for_path(dir));
+    GError *error = NULL;
+    GFileMonitorCXX monitor(g_file_monitor_directory(filecxx.get(), G_FILE_MONITOR_NONE, NULL, &error));
+    m_monitor.swap(monitor);
+    if (!m_monitor) {
+        GLibErrorException(std::string("monitoring directory ") + dir, error);
+    }
+    g_signal_connect_after(m_monitor.get(),
+                           "changed",
+                           G_CALLBACK(changed),
+                           (void *)&m_callback);
+}
+
 #ifdef ENABLE_UNIT_TESTS
 
 class GLibTest : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(GLibTest);
     CPPUNIT_TEST(notify);
+    CPPUNIT_TEST(dirNotify);
     CPPUNIT_TEST_SUITE_END();
 
     struct Event {
@@ -283,6 +301,40 @@ class GLibTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(events.size() > 0);
         }
     }
+
+    void dirNotify()
+    {
+        list<Event> events;
+        static const char *dir = "GLibTest.dir";
+        rm_r(dir);
+        mkdir_p(dir);
+        string name = string(dir) + "/file";
+        GMainLoopCXX loop(g_main_loop_new(NULL, FALSE), false);
+        if (!loop) {
+            SE_THROW("could not allocate main loop");
+        }
+        GLibDirNotify notify(dir, boost::bind(notifyCallback, boost::ref(events), _1, _2, _3));
+        {
+            events.clear();
+            GLibEvent id(g_timeout_add_seconds(5, timeout, loop.get()), "timeout");
+            ofstream out(name.c_str());
+            out << "hello";
+            out.close();
+            g_main_loop_run(loop.get());
+            CPPUNIT_ASSERT(events.size() > 0);
+            PlainGStr basename(g_file_get_basename(events.front().m_file1.get()));
+            CPPUNIT_ASSERT_EQUAL(string("file"), string(basename.get()));
+        }
+
+        {
+            events.clear();
+            unlink(name.c_str());
+            GLibEvent id(g_timeout_add_seconds(5, timeout, loop.get()), "timeout");
+            g_main_loop_run(loop.get());
+            CPPUNIT_ASSERT(events.size() > 0);
+        }
+        rm_r(dir);
+    }
 };
 
 SYNCEVOLUTION_TEST_SUITE_REGISTRATION(GLibTest);
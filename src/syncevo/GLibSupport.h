@@ -133,6 +133,23 @@ class GLibNotify : public boost::noncopyable
     callback_t m_callback;
 };
 
+/**
+ * Wrapper around g_file_monitor_directory(): reports changes of the
+ * entries in a directory, not recursively. The first GFile passed
+ * to the callback is the entry which changed.
+ */
+class GLibDirNotify : public boost::noncopyable
+{
+ public:
+    typedef GLibNotify::callback_t callback_t;
+
+    GLibDirNotify(const char *dir,
+                  const callback_t &callback);
+ private:
+    GFileMonitorCXX m_monitor;
+    callback_t m_callback;
+};
+
 /**
  * always throws an exception, including information from GError if available:
  * <action>: <error message>|failure
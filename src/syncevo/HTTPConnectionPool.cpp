@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <syncevo/HTTPConnectionPool.h>
+#include <syncevo/util.h>
+#include <test.h>
+
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+const size_t HTTPConnectionPool::MAX_IDLE;
+
+HTTPConnectionPool &HTTPConnectionPool::get()
+{
+    static HTTPConnectionPool pool;
+    return pool;
+}
+
+std::string HTTPConnectionPool::makeKey(const std::string &stack,
+                                        const std::string &url,
+                                        const std::string &proxy,
+                                        const std::string &tls)
+{
+    std::string scheme, hostport;
+    size_t start = url.find("://");
+    if (start != url.npos) {
+        scheme = boost::to_lower_copy(url.substr(0, start));
+        start += 3;
+    } else {
+        start = 0;
+    }
+    size_t end = url.find_first_of("/?#", start);
+    hostport = boost::to_lower_copy(url.substr(start, end == url.npos ? url.npos : end - start));
+    // credentials are not part of the connection
+    size_t at = hostport.rfind('@');
+    if (at != hostport.npos) {
+        hostport.erase(0, at + 1);
+    }
+    // port is optional, default depends on scheme; beware of IPv6 "[::1]"
+    size_t colon = hostport.rfind(':');
+    if (colon == hostport.npos ||
+        hostport.find(']', colon) != hostport.npos) {
+        hostport += scheme == "https" ? ":443" : ":80";
+    }
+
+    return StringPrintf("%s %s://%s proxy=%s tls=%s",
+                        stack.c_str(),
+                        scheme.c_str(),
+                        hostport.c_str(),
+                        proxy.c_str(),
+                        tls.c_str());
+}
+
+HTTPConnectionPool::Handle HTTPConnectionPool::acquire(const std::string &key)
+{
+    for (Idle_t::iterator it = m_idle.begin();
+         it != m_idle.end();
+         ++it) {
+        if (it->first == key) {
+            Handle handle = it->second;
+            m_idle.erase(it);
+            m_stats.m_pooled++;
+            return handle;
+        }
+    }
+    return Handle();
+}
+
+void HTTPConnectionPool::release(const std::string &key, const Handle &handle)
+{
+    if (!handle) {
+        return;
+    }
+    m_idle.push_front(std::make_pair(key, handle));
+    while (m_idle.size() > MAX_IDLE) {
+        m_idle.pop_back();
+    }
+}
+
+void HTTPConnectionPool::clear()
+{
+    m_idle.clear();
+}
+
+void HTTPConnectionPool::connected(double seconds)
+{
+    m_stats.m_connections++;
+    m_stats.m_connectSeconds += seconds;
+}
+
+std::string HTTPConnectionPool::formatStats() const
+{
+    double average = m_stats.m_connections ?
+        m_stats.m_connectSeconds / m_stats.m_connections :
+        0;
+    return StringPrintf("%lu new connections in %.3fs, %lu requests on open connections (~%.3fs saved), %lu handles reused",
+                        m_stats.m_connections,
+                        m_stats.m_connectSeconds,
+                        m_stats.m_reused,
+                        m_stats.m_reused * average,
+                        m_stats.m_pooled);
+}
+
+#ifdef ENABLE_UNIT_TESTS
+
+class HTTPConnectionPoolTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(HTTPConnectionPoolTest);
+    CPPUNIT_TEST(key);
+    CPPUNIT_TEST(pool);
+    CPPUNIT_TEST_SUITE_END();
+
+    void key()
+    {
+        CPPUNIT_ASSERT_EQUAL(std::string("curl https://example.com:443 proxy= tls=1"),
+                             HTTPConnectionPool::makeKey("curl", "https://user@Example.com/sync?x=1", "", "1"));
+        CPPUNIT_ASSERT_EQUAL(std::string("curl http://example.com:8080 proxy=http://proxy:3128 tls="),
+                             HTTPConnectionPool::makeKey("curl", "http://example.com:8080", "http://proxy:3128", ""));
+        CPPUNIT_ASSERT_EQUAL(std::string("soup http://[::1]:80 proxy= tls="),
+                             HTTPConnectionPool::makeKey("soup", "http://[::1]/", "", ""));
+        CPPUNIT_ASSERT_EQUAL(std::string("soup http://[::1]:9000 proxy= tls="),
+                             HTTPConnectionPool::makeKey("soup", "http://[::1]:9000/", "", ""));
+    }
+
+    /** deleter which counts how often it was called */
+    class Counter {
+        int *m_freed;
+    public:
+        Counter(int *freed) : m_freed(freed) {}
+        void operator () (int *value) { delete value; (*m_freed)++; }
+    };
+
+    void pool()
+    {
+        HTTPConnectionPool pool;
+        int freed = 0;
+        CPPUNIT_ASSERT(!pool.acquire("a"));
+
+        HTTPConnectionPool::Handle a(new int(1), Counter(&freed));
+        pool.release("a", a);
+        a.reset();
+        CPPUNIT_ASSERT_EQUAL(0, freed);
+        CPPUNIT_ASSERT(!pool.acquire("b"));
+        a = pool.acquire("a");
+        CPPUNIT_ASSERT(a);
+        CPPUNIT_ASSERT(!pool.acquire("a"));
+        CPPUNIT_ASSERT_EQUAL(1lu, pool.getStats().m_pooled);
+
+        // least recently released handles get freed
+        pool.release("a", a);
+        a.reset();
+        for (size_t i = 0; i < HTTPConnectionPool::MAX_IDLE; i++) {
+            pool.release("b", HTTPConnectionPool::Handle(new int(2)));
+        }
+        CPPUNIT_ASSERT_EQUAL(1, freed);
+        CPPUNIT_ASSERT_EQUAL(HTTPConnectionPool::MAX_IDLE, pool.size());
+        CPPUNIT_ASSERT(!pool.acquire("a"));
+        pool.clear();
+        CPPUNIT_ASSERT_EQUAL((size_t)0, pool.size());
+
+        pool.connected(0.5);
+        pool.connected(1.5);
+        pool.reused();
+        CPPUNIT_ASSERT_EQUAL(std::string("2 new connections in 2.000s, 1 requests on open connections (~1.000s saved), 1 handles reused"),
+                             pool.formatStats());
+    }
+};
+
+SYNCEVOLUTION_TEST_SUITE_REGISTRATION(HTTPConnectionPoolTest);
+
+#endif // ENABLE_UNIT_TESTS
+
+SE_END_CXX
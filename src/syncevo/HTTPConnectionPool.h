@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#ifndef INCL_SYNCEVOLUTION_HTTP_CONNECTION_POOL
+# define INCL_SYNCEVOLUTION_HTTP_CONNECTION_POOL
+
+#include <string>
+#include <list>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+/**
+ * Process-wide cache of idle HTTP client handles (curl easy handles,
+ * libsoup sessions, ...). Such a handle keeps its open connections
+ * and the TLS session of the server, so the next transport talking
+ * to the same server via the same proxy with the same TLS settings
+ * neither has to connect nor to do a full TLS handshake. This
+ * matters for automatic syncs, which contact the same peers again
+ * and again.
+ *
+ * Handles are stored as boost::shared_ptr<void> with a deleter
+ * which frees them, so one pool can hold handles of different HTTP
+ * stacks. The key must include the name of the stack to keep them
+ * apart, see makeKey().
+ *
+ * The pool also collects statistics about new connections and
+ * requests which could use an existing one. Handles which are not
+ * pooled (like the neon sessions of the WebDAV backend) can report
+ * into the same statistics.
+ *
+ * Not thread-safe, like the rest of libsyncevolution.
+ */
+class HTTPConnectionPool : private boost::noncopyable
+{
+ public:
+    typedef boost::shared_ptr<void> Handle;
+
+    /** maximum number of idle handles, older ones are freed */
+    static const size_t MAX_IDLE = 8;
+
+    struct Stats {
+        Stats() :
+            m_connections(0),
+            m_connectSeconds(0),
+            m_reused(0),
+            m_pooled(0)
+        {}
+
+        /** number of new connections, including the TLS handshake for https */
+        unsigned long m_connections;
+        /** total time spent on establishing them */
+        double m_connectSeconds;
+        /** number of requests sent via an already open connection */
+        unsigned long m_reused;
+        /** number of handles taken from the pool instead of creating them */
+        unsigned long m_pooled;
+    };
+
+    /** the pool shared by all transports of the process */
+    static HTTPConnectionPool &get();
+
+    /**
+     * Key for a handle of the given HTTP stack ("curl", "soup", ...)
+     * which talks to the server of the URL (only scheme, host and
+     * port are relevant) via the proxy and uses TLS with the
+     * settings described by the tls string.
+     */
+    static std::string makeKey(const std::string &stack,
+                               const std::string &url,
+                               const std::string &proxy,
+                               const std::string &tls);
+
+    /**
+     * Take an idle handle out of the pool. The caller owns it
+     * exclusively until it hands it back with release().
+     *
+     * @return empty pointer if no handle for the key is available
+     */
+    Handle acquire(const std::string &key);
+
+    /**
+     * Return a handle which is not in use anymore. Must only be
+     * done if the handle is still usable; handles in an undefined
+     * state (for example, after a failed request) should be
+     * freed instead.
+     */
+    void release(const std::string &key, const Handle &handle);
+
+    /** free all idle handles and thus close their connections */
+    void clear();
+
+    /** number of idle handles */
+    size_t size() const { return m_idle.size(); }
+
+    /** a new connection was established in the given time */
+    void connected(double seconds);
+
+    /** a request was sent over an existing connection */
+    void reused() { m_stats.m_reused++; }
+
+    const Stats &getStats() const { return m_stats; }
+
+    /**
+     * "<n> new connections in <seconds>s, <m> requests on open
+     * connections (~<seconds>s saved), <k> handles reused",
+     * where the time saved is estimated based on the average
+     * time for a new connection
+     */
+    std::string formatStats() const;
+
+ private:
+    /** key and handle, most recently released first */
+    typedef std::list< std::pair<std::string, Handle> > Idle_t;
+    Idle_t m_idle;
+    Stats m_stats;
+};
+
+SE_END_CXX
+#endif // INCL_SYNCEVOLUTION_HTTP_CONNECTION_POOL
@@ -22,6 +22,7 @@
 #include <syncevo/LogRedirect.h>
 #include <syncevo/Logging.h>
 #include <syncevo/SyncContext.h>
+#include <syncevo/SynthesisEngine.h>
 #include "test.h"
 #include <syncevo/util.h>
 #include <sys/types.h>
@@ -55,6 +56,10 @@ void LogRedirect::abortHandler(int sig) throw()
     // Don't know state of logging system, don't log here!
     // SE_LOG_ERROR(NULL, NULL, "caught signal %d, shutting down", sig);
 
+    // Write Synthesis log lines which are still buffered in
+    // memory (logflushmode "async").
+    sysync::SySyncDebugFlush();
+
     // shut down redirection, also flushes to log
     if (m_redirect) {
         m_redirect->restore();
@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <libsoup/soup-status.h>
 #include <syncevo/Logging.h>
+#include <syncevo/util.h>
 
 #ifdef HAVE_LIBSOUP_SOUP_GNOME_FEATURES_H
 #include <libsoup/soup-gnome-features.h>
@@ -33,29 +34,96 @@
 SE_BEGIN_CXX
 
 SoupTransportAgent::SoupTransportAgent(GMainLoop *loop) :
-    m_session(soup_session_async_new()),
+    m_proxySet(false),
+    m_verifySSL(false),
+    m_session(NULL),
+    m_requestStarted(0),
     m_loop(loop ?
            g_main_loop_ref(loop) :
            g_main_loop_new(NULL, TRUE),
            "Soup main loop"),
     m_status(INACTIVE),
+    m_data(NULL),
+    m_dataLen(0),
     m_timeoutSeconds(0),
-    m_response(0)
+    m_response(0),
+    m_responseContent(NULL),
+    m_responseContentLen(0)
 {
+}
+
+SoupTransportAgent::~SoupTransportAgent()
+{
+    releaseSession();
+}
+
+void SoupTransportAgent::setupSession()
+{
+    std::string key = HTTPConnectionPool::makeKey("soup", m_URL,
+                                                  m_proxySet ? m_proxy : "<default>",
+                                                  StringPrintf("%s %d", m_cacerts.c_str(), m_verifySSL));
+    if (m_session) {
+        if (key == m_key) {
+            return;
+        }
+        releaseSession();
+    }
+
+    HTTPConnectionPool::Handle handle = HTTPConnectionPool::get().acquire(key);
+    if (handle) {
+        SE_LOG_DEBUG(NULL, NULL, "reusing libsoup session for %s", key.c_str());
+    } else {
+        handle.reset(soup_session_async_new(), g_object_unref);
+        SoupSession *session = static_cast<SoupSession *>(handle.get());
+        if (!session) {
+            SE_THROW_EXCEPTION(TransportException, "could not allocate SoupSession");
+        }
+        if (!m_proxySet) {
 #ifdef HAVE_LIBSOUP_SOUP_GNOME_FEATURES_H
-    // use default GNOME proxy settings
-    soup_session_add_feature_by_type(m_session.get(), SOUP_TYPE_PROXY_RESOLVER_GNOME);
+            // use default GNOME proxy settings
+            soup_session_add_feature_by_type(session, SOUP_TYPE_PROXY_RESOLVER_GNOME);
 #endif
+        } else if (!m_proxy.empty()) {
+            eptr<SoupURI, SoupURI, GLibUnref> uri(soup_uri_new(m_proxy.c_str()), "Proxy URI");
+            g_object_set(session,
+                         SOUP_SESSION_PROXY_URI, uri.get(),
+                         NULL);
+        }
+        if (m_verifySSL && !m_cacerts.empty()) {
+            g_object_set(session, SOUP_SESSION_SSL_CA_FILE, m_cacerts.c_str(), NULL);
+        }
+    }
+
+    m_handle = handle;
+    m_session = static_cast<SoupSession *>(handle.get());
+    m_key = key;
+    g_object_set(m_session,
+                 SOUP_SESSION_USER_AGENT, m_userAgent.empty() ? NULL : m_userAgent.c_str(),
+                 NULL);
+    m_requestStarted = g_signal_connect(m_session, "request-started",
+                                        G_CALLBACK(RequestStartedCallback),
+                                        static_cast<gpointer>(this));
 }
 
-SoupTransportAgent::~SoupTransportAgent()
+void SoupTransportAgent::releaseSession()
 {
-    if (m_session.get()) {
-        // ensure that no callbacks for this session will be triggered
-        // in the future, they would use a stale pointer to this agent
-        // instance
-        soup_session_abort(m_session.get());
+    if (!m_session) {
+        return;
+    }
+    g_signal_handler_disconnect(m_session, m_requestStarted);
+    m_requestStarted = 0;
+    if (m_status == ACTIVE) {
+        // ensure that no callbacks for the pending message will be
+        // triggered in the future, they would use a stale pointer to
+        // this agent instance; the session is not reused after that
+        soup_session_abort(m_session);
+    } else if (m_status == INACTIVE ||
+               m_status == GOT_REPLY ||
+               m_status == CLOSED) {
+        HTTPConnectionPool::get().release(m_key, m_handle);
     }
+    m_handle.reset();
+    m_session = NULL;
 }
 
 void SoupTransportAgent::setURL(const std::string &url)
@@ -65,16 +133,10 @@ void SoupTransportAgent::setURL(const std::string &url)
 
 void SoupTransportAgent::setProxy(const std::string &proxy)
 {
-    if (!proxy.empty()) {
-        eptr<SoupURI, SoupURI, GLibUnref> uri(soup_uri_new(proxy.c_str()), "Proxy URI");
-        g_object_set(m_session.get(),
-                     SOUP_SESSION_PROXY_URI, uri.get(),
-                     NULL);
-    } else {
-        g_object_set(m_session.get(),
-                     SOUP_SESSION_PROXY_URI, NULL,
-                     NULL);
-    }
+    // applied in setupSession(), because it is part of the key
+    // under which the session is pooled
+    m_proxy = proxy;
+    m_proxySet = true;
 }
 
 void SoupTransportAgent::setProxyAuth(const std::string &user, const std::string &password)
@@ -108,9 +170,7 @@ void SoupTransportAgent::setContentType(const std::string &type)
 
 void SoupTransportAgent::setUserAgent(const std::string &agent)
 {
-    g_object_set(m_session.get(),
-                 SOUP_SESSION_USER_AGENT, agent.c_str(),
-                 NULL);
+    m_userAgent = agent;
 }
 
 void SoupTransportAgent::setTimeout(int seconds)
@@ -126,34 +186,44 @@ void SoupTransportAgent::send(const char *data, size_t len)
         SE_THROW_EXCEPTION(TransportException, "could not allocate SoupMessage");
     }
 
-    // use CA certificates if available and needed,
-    // fail if not available and needed
-    if (m_verifySSL) {
-        if (!m_cacerts.empty()) {
-            g_object_set(m_session.get(), SOUP_SESSION_SSL_CA_FILE, m_cacerts.c_str(), NULL);
-        } else {
-            SoupURI *uri = soup_message_get_uri(message.get());
-            if (!strcmp(uri->scheme, SOUP_URI_SCHEME_HTTPS)) {
-                SE_THROW_EXCEPTION(TransportException, "SSL certificate checking requested, but no CA certificate file configured");
-            }
+    // use CA certificates if available and needed (done by
+    // setupSession()), fail if not available and needed
+    if (m_verifySSL && m_cacerts.empty()) {
+        SoupURI *uri = soup_message_get_uri(message.get());
+        if (!strcmp(uri->scheme, SOUP_URI_SCHEME_HTTPS)) {
+            SE_THROW_EXCEPTION(TransportException, "SSL certificate checking requested, but no CA certificate file configured");
         }
     }
+    setupSession();
 
+    m_data = data;
+    m_dataLen = len;
+    encodeMessage(data, len, m_encoding);
+    if (!m_encoding.empty()) {
+        soup_message_headers_append(message->request_headers, "Content-Encoding", m_encoding.c_str());
+    }
+    std::string acceptEncoding = getAcceptEncoding();
+    if (!acceptEncoding.empty()) {
+        soup_message_headers_append(message->request_headers, "Accept-Encoding", acceptEncoding.c_str());
+    }
     soup_message_set_request(message.get(), m_contentType.c_str(),
                              SOUP_MEMORY_TEMPORARY, data, len);
     m_status = ACTIVE;
+    m_sendStart = Timespec::monotonic();
     if (m_timeoutSeconds) {
         m_message = message.get();
         m_timeoutEventSource = g_timeout_add_seconds(m_timeoutSeconds, TimeoutCallback, static_cast<gpointer> (this));
     }
-    soup_session_queue_message(m_session.get(), message.release(),
+    soup_session_queue_message(m_session, message.release(),
                                SessionCallback, static_cast<gpointer>(this));
 }
 
 void SoupTransportAgent::cancel()
 {
     m_status = CANCELED;
-    soup_session_abort(m_session.get());
+    if (m_session) {
+        soup_session_abort(m_session);
+    }
     if(g_main_loop_is_running(m_loop.get()))
       g_main_loop_quit(m_loop.get());
 }
@@ -199,8 +269,8 @@ TransportAgent::Status SoupTransportAgent::wait(bool noReply)
 void SoupTransportAgent::getReply(const char *&data, size_t &len, std::string &contentType)
 {
     if (m_response) {
-        data = m_response->data;
-        len = m_response->length;
+        data = m_responseContent;
+        len = m_responseContentLen;
         contentType = m_responseContentType;
     } else {
         data = NULL;
@@ -230,6 +300,23 @@ void SoupTransportAgent::HandleSessionCallback(SoupSession *session,
     } else {
         m_response = NULL;
     }
+    if (msg->status_code != 200 &&
+        compressionRejected(msg->status_code, m_encoding,
+                            m_response ? m_response->data : NULL,
+                            m_response ? m_response->length : 0)) {
+        // keep the main loop running, wait() continues
+        // with the new message
+        m_response = NULL;
+        try {
+            send(m_data, m_dataLen);
+            return;
+        } catch (const std::exception &ex) {
+            m_failure = ex.what();
+            m_status = FAILED;
+            g_main_loop_quit(m_loop.get());
+            return;
+        }
+    }
     if (msg->status_code != 200) {
         m_failure = m_URL;
         m_failure += " via libsoup: ";
@@ -245,16 +332,45 @@ void SoupTransportAgent::HandleSessionCallback(SoupSession *session,
         }
     } else {
         m_status = GOT_REPLY;
+        m_responseContent = m_response ? m_response->data : NULL;
+        m_responseContentLen = m_response ? m_response->length : 0;
+        const char *encoding = soup_message_headers_get(msg->response_headers,
+                                                        "Content-Encoding");
+        try {
+            decodeReply(m_responseContent, m_responseContentLen,
+                        encoding ? encoding : "");
+        } catch (const std::exception &ex) {
+            m_failure = ex.what();
+            m_status = FAILED;
+        }
     }
 
     g_main_loop_quit(m_loop.get());
 }
 
+void SoupTransportAgent::RequestStartedCallback(SoupSession *session,
+                                                SoupMessage *msg,
+                                                SoupSocket *socket,
+                                                gpointer user_data)
+{
+    static const char connected[] = "syncevolution-connected";
+    HTTPConnectionPool &pool = HTTPConnectionPool::get();
+    if (g_object_get_data(G_OBJECT(socket), connected)) {
+        pool.reused();
+    } else {
+        // first request on this socket: includes time for
+        // connecting and TLS handshake
+        SoupTransportAgent *agent = static_cast<SoupTransportAgent *>(user_data);
+        g_object_set_data(G_OBJECT(socket), connected, GINT_TO_POINTER(1));
+        pool.connected((Timespec::monotonic() - agent->m_sendStart).duration());
+    }
+}
+
 gboolean SoupTransportAgent::processCallback()
 {
     //stop the message processing and mark status as timeout
     guint message_status = SOUP_STATUS_CANCELLED;
-    soup_session_cancel_message(m_session.get(), m_message, message_status);
+    soup_session_cancel_message(m_session, m_message, message_status);
     m_status = TIME_OUT;
     return FALSE;
 }
@@ -26,6 +26,7 @@
 
 #include <syncevo/TransportAgent.h>
 #include <syncevo/SmartPtr.h>
+#include <syncevo/HTTPConnectionPool.h>
 #include <libsoup/soup.h>
 #include <glib.h>
 
@@ -46,6 +47,10 @@ class GLibUnref {
  *
  * An asynchronous soup session is used and the main loop
  * is invoked in the wait() method to make progress.
+ *
+ * The session is created when sending the first message and
+ * handed over to the HTTPConnectionPool afterwards, together
+ * with its open connections.
  */
 class SoupTransportAgent : public HTTPTransportAgent
 {
@@ -74,18 +79,34 @@ class SoupTransportAgent : public HTTPTransportAgent
     virtual void setTimeout(int seconds);
     gboolean processCallback();
  private:
+    std::string m_proxy;
+    /** false if setProxy() was not called: use system proxy settings */
+    bool m_proxySet;
+    std::string m_userAgent;
     std::string m_proxyUser;
     std::string m_proxyPassword;
     std::string m_cacerts;
     bool m_verifySSL;
     std::string m_URL;
     std::string m_contentType;
-    eptr<SoupSession, GObject> m_session;
+    /** owns m_session, empty until setupSession() */
+    HTTPConnectionPool::Handle m_handle;
+    SoupSession *m_session;
+    /** HTTPConnectionPool key of m_session */
+    std::string m_key;
+    /** "request-started" signal handler */
+    gulong m_requestStarted;
     eptr<GMainLoop, GMainLoop, GLibUnref> m_loop;
     Status m_status;
     std::string m_failure;
 
     SoupMessage *m_message;
+    /** uncompressed message (owned by caller), needed for resending it */
+    const char *m_data;
+    size_t m_dataLen;
+    /** Content-Encoding of the pending message */
+    std::string m_encoding;
+    Timespec m_sendStart;
     GLibEvent m_timeoutEventSource;
     int m_timeoutSeconds;
 
@@ -95,6 +116,21 @@ class SoupTransportAgent : public HTTPTransportAgent
     /** response, copied from SoupMessage */
     eptr<SoupBuffer, SoupBuffer, GLibUnref> m_response;
     std::string m_responseContentType;
+    /** decoded response, points into m_response or into HTTPTransportAgent */
+    const char *m_responseContent;
+    size_t m_responseContentLen;
+
+    /** get session for current URL, proxy and TLS settings, from the pool or a new one */
+    void setupSession();
+
+    /** hand session over to the pool if it is still usable, otherwise free it */
+    void releaseSession();
+
+    /** "request-started" signal: counts new and reused connections */
+    static void RequestStartedCallback(SoupSession *session,
+                                       SoupMessage *msg,
+                                       SoupSocket *socket,
+                                       gpointer user_data);
 
     /** SoupSessionCallback, redirected into user_data->HandleSessionCallback() */
     static void SessionCallback(SoupSession *session,
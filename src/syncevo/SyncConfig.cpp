@@ -1255,6 +1255,14 @@ static BoolConfigProperty syncPropRefreshSync("enableRefreshSync",
                                               "example, Funambol's One Media server rejects too many slow\n"
                                               "syncs in a row with a 417 'retry later' error.\n",
                                               "FALSE");
+static BoolConfigProperty syncPropCompression("enableCompression",
+                                              "compress messages sent via HTTP with gzip and ask the\n"
+                                              "server to compress its replies; SyncML messages in XML\n"
+                                              "format shrink considerably. If the server rejects a\n"
+                                              "compressed message, it is sent again without compression\n"
+                                              "and compression remains off for the rest of the session.\n"
+                                              "Only applicable when this side sends the messages via HTTP.",
+                                              "FALSE");
 static ConfigProperty syncPropLogDir("logdir",
                                      "full path to directory where automatic backups and logs\n"
                                      "are stored for all synchronizations; if unset, then\n"
@@ -1617,6 +1625,7 @@ public:
         registry.push_back(&syncPropRemoteDevID);
         registry.push_back(&syncPropWBXML);
         registry.push_back(&syncPropRefreshSync);
+        registry.push_back(&syncPropCompression);
         registry.push_back(&syncPropMaxMsgSize);
         registry.push_back(&syncPropMaxObjSize);
         registry.push_back(&syncPropSSLServerCertificates);
@@ -1911,6 +1920,8 @@ InitState<bool> SyncConfig::getWBXML() const { return syncPropWBXML.getPropertyV
 void SyncConfig::setWBXML(bool value, bool temporarily) { syncPropWBXML.setProperty(*getNode(syncPropWBXML), value, temporarily); }
 InitState<bool> SyncConfig::getRefreshSync() const { return syncPropRefreshSync.getPropertyValue(*getNode(syncPropRefreshSync)); }
 void SyncConfig::setRefreshSync(bool value, bool temporarily) { syncPropRefreshSync.setProperty(*getNode(syncPropRefreshSync), value, temporarily); }
+InitState<bool> SyncConfig::getCompression() const { return syncPropCompression.getPropertyValue(*getNode(syncPropCompression)); }
+void SyncConfig::setCompression(bool value, bool temporarily) { syncPropCompression.setProperty(*getNode(syncPropCompression), value, temporarily); }
 InitStateString SyncConfig::getLogDir() const { return syncPropLogDir.getProperty(*getNode(syncPropLogDir)); }
 void SyncConfig::setLogDir(const string &value, bool temporarily) { syncPropLogDir.setProperty(*getNode(syncPropLogDir), value, temporarily); }
 InitState<unsigned int> SyncConfig::getMaxLogDirs() const { return syncPropMaxLogDirs.getPropertyValue(*getNode(syncPropMaxLogDirs)); }
@@ -1545,6 +1545,12 @@ class SyncConfig {
     virtual InitState<bool> getRefreshSync() const;
     virtual void setRefreshSync(bool enableRefreshSync, bool temporarily = false);
 
+    /**
+     * Specifies whether HTTP messages are compressed.
+     */
+    virtual InitState<bool> getCompression() const;
+    virtual void setCompression(bool enableCompression, bool temporarily = false);
+
     virtual InitStateString getUserAgent() const { return "SyncEvolution"; }
     virtual InitStateString getMan() const { return "Patrick Ohly"; }
     virtual InitStateString getMod() const { return "SyncEvolution"; }
@@ -33,6 +33,7 @@
 
 #include <syncevo/LogStdout.h>
 #include <syncevo/TransportAgent.h>
+#include <syncevo/HTTPConnectionPool.h>
 #include <syncevo/CurlTransportAgent.h>
 #include <syncevo/SoupTransportAgent.h>
 #include <syncevo/ObexTransportAgent.h>
@@ -505,6 +506,10 @@ public:
                 }
             }
             m_logfile = m_path + "/" + LogfileBasename + ".html";
+            if (LogCompressionLevel()) {
+                // name chosen by the Synthesis engine, see <logcompression>
+                m_logfile += ".gz";
+            }
         }
 
         // update log level of default logger and our own replacement
@@ -693,8 +698,115 @@ public:
                 }
             }
         }
+#ifdef HAVE_ZLIB
+        compact();
+#endif
     }
 
+#ifdef HAVE_ZLIB
+    /**
+     * gzip log files and database dumps of older sessions which are
+     * complete (have an end time), if enabled via
+     * SYNCEVOLUTION_LOG_COMPRESSION
+     *
+     * Done by a background "find ... -exec gzip" process so that the
+     * current session is not delayed by it. It is started directly,
+     * without a shell, so no quoting of the directory names is
+     * needed. Files which are hard-linked between dumps
+     * are left alone because compressing them would break the
+     * sharing and thus use more space instead of less. status.ini
+     * files are needed for listing sessions and stay uncompressed,
+     * too. Everything reading these files (ReadFileMaybeCompressed(),
+     * synccompare) also accepts the compressed .gz variant.
+     *
+     * The newest completed session is skipped: the next session
+     * hard-links unchanged items from its dumps, which must not race
+     * with gzip replacing them. Sessions handed to the background
+     * process are marked with "compressed" in their status.ini and
+     * not looked at again.
+     */
+    void compact() {
+        int level = LogCompressionLevel();
+        if (!level || m_logdir.empty()) {
+            return;
+        }
+
+        vector<string> dirs;
+        getLogdirs(dirs);
+        // find <dir>... -type f -links 1 ! -name *.ini ! -name *.gz -exec nice gzip -q -f -<level> {} +
+        vector<string> args;
+        args.push_back("find");
+        bool newest = true;
+        for (vector<string>::reverse_iterator it = dirs.rbegin();
+             it != dirs.rend();
+             ++it) {
+            const string &dir = *it;
+            if (dir == m_path) {
+                // still in use
+                continue;
+            }
+            LogDir logdir(m_client);
+            logdir.openLogdir(dir);
+            SyncReport report;
+            logdir.readReport(report);
+            if (!report.getEnd()) {
+                // died prematurely or still running in some other process
+                continue;
+            }
+            if (newest) {
+                // baseline for the next dump
+                newest = false;
+                continue;
+            }
+            bool compressed = false;
+            if (logdir.m_info->getProperty("compressed", compressed) &&
+                compressed) {
+                continue;
+            }
+            logdir.m_info->setProperty("compressed", "1");
+            logdir.m_info->flush();
+            // must not be mistaken for an option or expression by find
+            args.push_back(boost::starts_with(dir, "/") ? dir : "./" + dir);
+        }
+        size_t count = args.size() - 1;
+        if (!count) {
+            return;
+        }
+        static const char * const options[] = {
+            "-type", "f", "-links", "1",
+            "!", "-name", "*.ini",
+            "!", "-name", "*.gz",
+            "-exec", "nice", "gzip", "-q", "-f"
+        };
+        args.insert(args.end(), options, options + sizeof(options) / sizeof(options[0]));
+        args.push_back(StringPrintf("-%d", level));
+        args.push_back("{}");
+        args.push_back("+");
+
+        SE_LOG_DEBUG(NULL, NULL, "compressing %lu older session(s) in the background", (unsigned long)count);
+        // Fork twice so that the process doing the work is not our
+        // child and doesn't have to be waited for. Only
+        // async-signal-safe calls between fork() and exec(): we may
+        // have threads. Therefore argv is prepared in advance.
+        vector<char *> argv;
+        BOOST_FOREACH(string &arg, args) {
+            argv.push_back(&arg[0]);
+        }
+        argv.push_back(NULL);
+        pid_t child = fork();
+        if (child == 0) {
+            if (fork() == 0) {
+                execvp(argv[0], &argv[0]);
+            }
+            _exit(0);
+        } else if (child > 0) {
+            waitpid(child, NULL, 0);
+        } else {
+            SE_LOG_DEBUG(NULL, NULL, "fork() for compression failed: %s", strerror(errno));
+        }
+    }
+#endif // HAVE_ZLIB
+
     // finalize session
     void endSession()
     {
@@ -1062,6 +1174,8 @@ public:
     void dumpDatabases(const string &suffix,
                        BackupReport SyncSourceReport::*report,
                        const string &excludeSource = "") {
+        SyncTiming::Scope timing(m_client.getTiming(), SyncTiming::PHASE_BACKUP);
+
         // Identify all logdirs of current context, of any peer.  Used
         // to search for previous backups of each source, if
         // necessary.
@@ -1407,6 +1521,10 @@ public:
     ~SourceList() {
         // free sync sources
         BOOST_FOREACH(SyncSource *source, *this) {
+            // background threads still use the source
+            if (source->getOperations().m_endPrefetch) {
+                source->getOperations().m_endPrefetch();
+            }
             delete source;
         }
     }
@@ -2118,6 +2236,88 @@ void SyncContext::initSources(SourceList &sourceList)
     }
 }
 
+/**
+ * Slot for the pre and post signals of a SyncSource operation which
+ * enters resp. leaves a SyncTiming phase. The parameters of the
+ * operation are ignored, so the same slot works for all of them.
+ */
+class SyncTimingSlot
+{
+    SyncTiming *m_timing;
+    SyncTiming::Phase m_phase;
+    bool m_enter;
+
+    void fire() const
+    {
+        if (m_enter) {
+            m_timing->push(m_phase);
+        } else {
+            m_timing->pop();
+        }
+    }
+
+ public:
+    typedef void result_type;
+
+    SyncTimingSlot(SyncTiming &timing, SyncTiming::Phase phase, bool enter) :
+        m_timing(&timing),
+        m_phase(phase),
+        m_enter(enter)
+    {}
+
+    void operator () (SyncSource &) const { fire(); }
+    template<class A1> void operator () (SyncSource &, const A1 &) const { fire(); }
+    template<class A1, class A2> void operator () (SyncSource &, const A1 &, const A2 &) const { fire(); }
+    template<class A1, class A2, class A3> void operator () (SyncSource &, const A1 &, const A2 &, const A3 &) const { fire(); }
+    template<class A1, class A2, class A3, class A4> void operator () (SyncSource &, const A1 &, const A2 &, const A3 &, const A4 &) const { fire(); }
+    template<class A1, class A2, class A3, class A4, class A5> void operator () (SyncSource &, const A1 &, const A2 &, const A3 &, const A4 &, const A5 &) const { fire(); }
+};
+
+template<class O> static void timeOperation(const O &operation, SyncTiming &timing, SyncTiming::Phase phase)
+{
+    operation.getPreSignal().connect(SyncTimingSlot(timing, phase, true));
+    operation.getPostSignal().connect(SyncTimingSlot(timing, phase, false));
+}
+
+void SyncContext::timeSourceOperations(SyncSource *source)
+{
+    const SyncSource::Operations &ops = source->getOperations();
+
+    timeOperation(ops.m_startDataRead, m_timing, SyncTiming::PHASE_CHANGES);
+    timeOperation(ops.m_readNextItem, m_timing, SyncTiming::PHASE_CHANGES);
+    timeOperation(ops.m_endDataWrite, m_timing, SyncTiming::PHASE_CHANGES);
+
+    timeOperation(ops.m_readItemAsKey, m_timing, SyncTiming::PHASE_ITEMS);
+    timeOperation(ops.m_insertItemAsKey, m_timing, SyncTiming::PHASE_ITEMS);
+    timeOperation(ops.m_updateItemAsKey, m_timing, SyncTiming::PHASE_ITEMS);
+    timeOperation(ops.m_deleteItem, m_timing, SyncTiming::PHASE_ITEMS);
+
+    timeOperation(ops.m_loadAdminData, m_timing, SyncTiming::PHASE_MAPS);
+    timeOperation(ops.m_saveAdminData, m_timing, SyncTiming::PHASE_MAPS);
+    timeOperation(ops.m_insertMapItem, m_timing, SyncTiming::PHASE_MAPS);
+    timeOperation(ops.m_updateMapItem, m_timing, SyncTiming::PHASE_MAPS);
+    timeOperation(ops.m_deleteMapItem, m_timing, SyncTiming::PHASE_MAPS);
+}
+
+void SyncContext::reportTiming()
+{
+    std::string timing = m_timing.format();
+    SE_LOG_DEBUG(NULL, NULL, "sync timing: %s", timing.c_str());
+    // cumulative, covers all syncs and WebDAV sessions of the process
+    SE_LOG_DEBUG(NULL, NULL, "HTTP connections: %s",
+                 HTTPConnectionPool::get().formatStats().c_str());
+
+    const char *file = getenv("SYNCEVOLUTION_SYNC_TIMING");
+    if (file) {
+        // one line per sync and process; in a local sync, both sides
+        // append to the same file
+        ofstream out(file, ios_base::app);
+        out << (m_serverMode ? "server " : "client ")
+            << getConfigName() << " "
+            << timing << endl;
+    }
+}
+
 void SyncContext::startSourceAccess(SyncSource *source)
 {
     if(m_firstSourceAccess) {
@@ -2434,6 +2634,9 @@ void SyncContext::getConfigXML(string &xml, string &configname)
         stringstream debug;
         bool logging = !m_sourceListPtr->getLogdir().empty();
         int loglevel = getLogLevel();
+        // "async" (written by a background thread, see
+        // LogRedirect::abortHandler()) must be chosen explicitly
+        const char *flushMode = getenv("SYNCEVOLUTION_LOG_FLUSH_MODE");
 
         debug <<
             "  <debug>\n"
@@ -2441,7 +2644,7 @@ void SyncContext::getConfigXML(string &xml, string &configname)
             "    <logpath>$(logpath)</logpath>\n"
             "    <filename>" <<
             LogfileBasename << "</filename>" <<
-            "    <logflushmode>flush</logflushmode>\n"
+            "    <logflushmode>" << (flushMode && *flushMode ? flushMode : "flush") << "</logflushmode>\n"
             "    <logformat>html</logformat>\n"
             "    <folding>auto</folding>\n"
             "    <timestamp>yes</timestamp>\n"
@@ -2454,6 +2657,11 @@ void SyncContext::getConfigXML(string &xml, string &configname)
             debug <<
                 "    <sessionlogs>yes</sessionlogs>\n"
                 "    <globallogs>yes</globallogs>\n";
+            int compression = LogCompressionLevel();
+            if (compression) {
+                // log file becomes syncevolution-log.html.gz, see LogDir::startSession()
+                debug << "    <logcompression>" << compression << "</logcompression>\n";
+            }
             debug << "<msgdump>" << (loglevel >= 5 ? "yes" : "no") << "</msgdump>\n";
             debug << "<xmltranslate>" << (loglevel >= 4 ? "yes" : "no") << "</xmltranslate>\n";
             if (loglevel >= 3) {
@@ -2484,6 +2692,14 @@ void SyncContext::getConfigXML(string &xml, string &configname)
     if (index != xml.npos) {
         stringstream datastores;
 
+        // Several items per Add/Replace/Delete command (and one Status
+        // for them) by default only in a local sync, where both sides
+        // are known to support it.
+        const char *itemsPerCommand = getenv("SYNCEVOLUTION_MAX_ITEMS_PER_COMMAND");
+        int maxItemsPerCommand = itemsPerCommand ? atoi(itemsPerCommand) :
+            m_localSync ? 100 :
+            1;
+
         BOOST_FOREACH(SyncSource *source, *m_sourceListPtr) {
             string fragment;
             source->getDatastoreXML(fragment, fragments);
@@ -2504,6 +2720,9 @@ void SyncContext::getConfigXML(string &xml, string &configname)
                 fragment;
 
             datastores << "      <resumesupport>on</resumesupport>\n";
+            if (maxItemsPerCommand > 1) {
+                datastores << "      <maxitemspercommand>" << maxItemsPerCommand << "</maxitemspercommand>\n";
+            }
             if (source->getOperations().m_writeBlob) {
                 // BLOB support is essential for caching partially received items.
                 datastores << "      <resumeitemsupport>on</resumeitemsupport>\n";
@@ -2928,6 +3147,7 @@ SyncMLStatus SyncContext::sync(SyncReport *report)
     SwapContext syncSentinel(this);
     try {
         m_sourceListPtr = &sourceList;
+        m_timing.reset();
         string url = getUsedSyncURL();
         if (boost::starts_with(url, "local://")) {
             initLocalSync(url.substr(strlen("local://")));
@@ -3025,6 +3245,19 @@ SyncMLStatus SyncContext::sync(SyncReport *report)
 
                 // request callback when starting to use source
                 source->getOperations().m_startDataRead.getPreSignal().connect(boost::bind(&SyncContext::startSourceAccess, this, source));
+                timeSourceOperations(source);
+            }
+
+            // let sources prepare change detection while the
+            // initial messages are exchanged
+            const char *prefetch = getenv("SYNCEVOLUTION_PREFETCH");
+            if (!m_serverMode &&
+                (!prefetch || atoi(prefetch))) {
+                BOOST_FOREACH(SyncSource *source, sourceList) {
+                    if (source->getOperations().m_startPrefetch) {
+                        source->getOperations().m_startPrefetch(boost::bind(&SyncTiming::overlapped, &m_timing, _1));
+                    }
+                }
             }
 
             // ready to go
@@ -3094,8 +3327,13 @@ SyncMLStatus SyncContext::sync(SyncReport *report)
             }
         }
 
+        HTTPTransportAgent *httpAgent = dynamic_cast<HTTPTransportAgent *>(m_agent.get());
+        if (httpAgent) {
+            report->setTransferStats(httpAgent->getTransferStats());
+        }
         sourceList.updateSyncReport(*report);
         sourceList.syncDone(status, report);
+        reportTiming();
     } catch(...) {
         Exception::handle(&status);
     }
@@ -3572,7 +3810,10 @@ SyncMLStatus SyncContext::doSync()
                 if (getLogLevel() > 4) {
                     SE_LOG_DEBUG(NULL, NULL, "before SessionStep: %s", Step2String(stepCmd).c_str());
                 }
-                m_engine.SessionStep(session, stepCmd, &progressInfo);
+                {
+                    SyncTiming::Scope timing(m_timing, SyncTiming::PHASE_ENGINE);
+                    m_engine.SessionStep(session, stepCmd, &progressInfo);
+                }
                 if (getLogLevel() > 4) {
                     SE_LOG_DEBUG(NULL, NULL, "after SessionStep: %s", Step2String(stepCmd).c_str());
                 }
@@ -3707,7 +3948,11 @@ SyncMLStatus SyncContext::doSync()
                 // sent or have it copied into caller's buffer using
                 // ReadSyncMLBuffer(), then send it to the server
                 sendBuffer = m_engine.GetSyncMLBuffer(session, true);
-                m_agent->send(sendBuffer.get(), sendBuffer.size());
+                m_timing.sent(sendBuffer.size());
+                {
+                    SyncTiming::Scope timing(m_timing, SyncTiming::PHASE_TRANSPORT);
+                    m_agent->send(sendBuffer.get(), sendBuffer.size());
+                }
                 stepCmd = sysync::STEPCMD_SENTDATA; // we have sent the data
                 break;
             }
@@ -3716,16 +3961,25 @@ SyncMLStatus SyncContext::doSync()
                 resendStart = time(NULL);
                 /* We are resending previous message, just read from the
                  * previous buffer */
-                m_agent->send(sendBuffer.get(), sendBuffer.size());
+                m_timing.sent(sendBuffer.size());
+                {
+                    SyncTiming::Scope timing(m_timing, SyncTiming::PHASE_TRANSPORT);
+                    m_agent->send(sendBuffer.get(), sendBuffer.size());
+                }
                 stepCmd = sysync::STEPCMD_SENTDATA; // we have sent the data
                 break;
             }
-            case sysync::STEPCMD_NEEDDATA:
+            case sysync::STEPCMD_NEEDDATA: {
                 if (!sendStart) {
                     // no message sent yet, record start of wait for data
                     sendStart = time(NULL);
                 }
-                switch (m_agent->wait()) {
+                TransportAgent::Status transportStatus;
+                {
+                    SyncTiming::Scope timing(m_timing, SyncTiming::PHASE_TRANSPORT);
+                    transportStatus = m_agent->wait();
+                }
+                switch (transportStatus) {
                 case TransportAgent::ACTIVE:
                     // Still sending the data?! Don't change anything,
                     // skip SessionStep() above.
@@ -3853,6 +4107,8 @@ SyncMLStatus SyncContext::doSync()
                     stepCmd = sysync::STEPCMD_TRANSPFAIL; // communication with server failed
                     break;
                 }
+                break;
+            }
             }
 
             // Don't tell engine to abort when it already did.
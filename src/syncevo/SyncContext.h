@@ -26,6 +26,7 @@
 #include <syncevo/SyncML.h>
 #include <syncevo/SynthesisEngine.h>
 #include <syncevo/UserInterface.h>
+#include <syncevo/SyncTiming.h>
 
 #include <string>
 #include <set>
@@ -86,6 +87,12 @@ class SyncContext : public SyncConfig {
      */
     SourceList *m_sourceListPtr;
 
+    /**
+     * time spent in the different phases of the current or most
+     * recent sync, see getTiming()
+     */
+    SyncTiming m_timing;
+
     /**
      * a pointer to the active SyncContext instance if one exists;
      * set by sync() and/or SwapContext
@@ -212,6 +219,13 @@ class SyncContext : public SyncConfig {
 
     bool isLocalSync() const { return m_localSync; }
 
+    /**
+     * Per-phase timing of the current or most recent sync. Logged
+     * at the end of each sync; also appended to the file named by
+     * SYNCEVOLUTION_SYNC_TIMING, if set.
+     */
+    SyncTiming &getTiming() { return m_timing; }
+
     bool isServerAlerted() const { return m_serverAlerted; }
     void setServerAlerted(bool serverAlerted) { m_serverAlerted = serverAlerted; }
 
@@ -728,6 +742,16 @@ class SyncContext : public SyncConfig {
      */
     void startSourceAccess(SyncSource *source);
 
+    /**
+     * connect m_timing to the operations of the source
+     */
+    void timeSourceOperations(SyncSource *source);
+
+    /**
+     * log m_timing at the end of sync()
+     */
+    void reportTiming();
+
     /**
      * utility function for status() and getChanges():
      * iterate over sources, check for changes and copy result
@@ -1016,6 +1016,13 @@ ConfigNode &operator << (ConfigNode &node, const SyncReport &report)
     } else {
         node.removeProperty("error");
     }
+    const SyncReport::TransferStats &stats = report.getTransferStats();
+    if (stats.m_wireSent || stats.m_wireReceived) {
+        node.setProperty("bytes-raw-sent", stats.m_rawSent);
+        node.setProperty("bytes-raw-received", stats.m_rawReceived);
+        node.setProperty("bytes-wire-sent", stats.m_wireSent);
+        node.setProperty("bytes-wire-received", stats.m_wireReceived);
+    }
 
     BOOST_FOREACH(const SyncReport::value_type &entry, report) {
         const std::string &name = entry.first;
@@ -1093,6 +1100,12 @@ ConfigNode &operator >> (ConfigNode &node, SyncReport &report)
     if (node.getProperty("error", error)) {
         report.setError(error);
     }
+    SyncReport::TransferStats stats;
+    node.getProperty("bytes-raw-sent", stats.m_rawSent);
+    node.getProperty("bytes-raw-received", stats.m_rawReceived);
+    node.getProperty("bytes-wire-sent", stats.m_wireSent);
+    node.getProperty("bytes-wire-received", stats.m_wireReceived);
+    report.setTransferStats(stats);
 
     ConfigNode::PropsType props;
     node.readProperties(props);
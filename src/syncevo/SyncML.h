@@ -433,10 +433,31 @@ class SyncSourceReport {
 };
 
 class SyncReport : public std::map<std::string, SyncSourceReport> {
+ public:
+    /**
+     * Size of the SyncML messages as produced and parsed by the
+     * engine ("raw") and as transmitted ("wire"). The two differ
+     * when the transport compresses messages. All zero if the
+     * transport does not count.
+     */
+    struct TransferStats {
+        TransferStats() :
+            m_rawSent(0),
+            m_rawReceived(0),
+            m_wireSent(0),
+            m_wireReceived(0)
+        {}
+
+        unsigned long m_rawSent, m_rawReceived;
+        unsigned long m_wireSent, m_wireReceived;
+    };
+
+ private:
     time_t m_start, m_end;
     SyncMLStatus m_status;
     std::string m_error;
     std::string m_localName, m_remoteName;
+    TransferStats m_transferStats;
 
  public:
     SyncReport() :
@@ -493,11 +514,15 @@ class SyncReport : public std::map<std::string, SyncSourceReport> {
     std::string getError() const { return m_error; }
     void setError(const std::string &error) { m_error = error; }
 
+    const TransferStats &getTransferStats() const { return m_transferStats; }
+    void setTransferStats(const TransferStats &stats) { m_transferStats = stats; }
+
     void clear() {
         std::map<std::string, SyncSourceReport>::clear();
         m_start = m_end = 0;
         m_error = "";
         m_status = STATUS_OK;
+        m_transferStats = TransferStats();
     }
 
     /** generate short string representing start and duration of sync */
@@ -40,9 +40,14 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 #include <fstream>
+#include <algorithm>
 #include <iostream>
 
 #ifdef ENABLE_UNIT_TESTS
@@ -792,6 +797,7 @@ void ItemCache::init(const SyncSource::Operations::ConstBackupInfo &oldBackup,
 {
     m_counter = 1;
     m_legacy = legacy;
+    m_compression = LogCompressionLevel();
     m_backup = newBackup;
     m_hash2counter.clear();
     m_dirname = oldBackup.m_dirname;
@@ -826,14 +832,27 @@ string ItemCache::getFilename(Hash_t hash)
 {
     Map_t::const_iterator it = m_hash2counter.find(hash);
     if (it != m_hash2counter.end()) {
-        stringstream dirname;
-        dirname << m_dirname << "/" << it->second;
-        return dirname.str();
+        return getItemFile(m_dirname, it->second);
     } else {
         return "";
     }
 }
 
+string ItemCache::getItemFile(const string &dirname, long counter)
+{
+    stringstream filename;
+    filename << dirname << "/" << counter;
+    struct stat buf;
+    if (stat(filename.str().c_str(), &buf) &&
+        errno == ENOENT) {
+        string compressed = filename.str() + ".gz";
+        if (!stat(compressed.c_str(), &buf)) {
+            return compressed;
+        }
+    }
+    return filename.str();
+}
+
 const char *ItemCache::m_hashSuffix =
 #ifdef USE_SHA256
     "-sha256"
@@ -852,13 +871,18 @@ void ItemCache::backupItem(const std::string &item,
     ItemCache::Hash_t hash = hashFunc(item);
     string oldfilename = getFilename(hash);
     if (!oldfilename.empty()) {
-        // found old file with same content, reuse it via hardlink
-        if (link(oldfilename.c_str(), filename.str().c_str())) {
+        // found old file with same content, reuse it via hardlink;
+        // keeps the compression of the old file
+        string newfilename = filename.str();
+        if (boost::ends_with(oldfilename, ".gz")) {
+            newfilename += ".gz";
+        }
+        if (link(oldfilename.c_str(), newfilename.c_str())) {
             // Hard linking failed. Record this, then continue
             // by ignoring the old file.
             SE_LOG_DEBUG(NULL, NULL, "hard linking old %s new %s: %s",
                          oldfilename.c_str(),
-                         filename.str().c_str(),
+                         newfilename.c_str(),
                          strerror(errno));
             oldfilename.clear();
         }
@@ -866,11 +890,15 @@ void ItemCache::backupItem(const std::string &item,
 
     if (oldfilename.empty()) {
         // write new file instead of reusing old one
-        ofstream out(filename.str().c_str());
-        out.write(item.c_str(), item.size());
-        out.close();
-        if (out.fail()) {
-            SE_THROW(string("error writing ") + filename.str() + ": " + strerror(errno));
+        if (m_compression) {
+            WriteFileCompressed(filename.str() + ".gz", item, m_compression);
+        } else {
+            ofstream out(filename.str().c_str());
+            out.write(item.c_str(), item.size());
+            out.close();
+            if (out.fail()) {
+                SE_THROW(string("error writing ") + filename.str() + ": " + strerror(errno));
+            }
         }
     }
 
@@ -909,7 +937,8 @@ void ItemCache::finalize(BackupReport &report)
 
 void SyncSourceRevisions::initRevisions()
 {
-    if (!m_revisionsSet) {
+    if (!m_revisionsSet &&
+        !usePrefetched(false)) {
         // might still be filled with garbage from previous run
         m_revisions.clear();
         listAllItems(m_revisions);
@@ -917,6 +946,120 @@ void SyncSourceRevisions::initRevisions()
     }
 }
 
+struct SyncSourceRevisions::Prefetch {
+    SyncSourceRevisions *m_source;
+    pthread_t m_thread;
+    /** thread started and not joined yet */
+    bool m_running;
+    /** set by thread: listAllItems() succeeded */
+    bool m_valid;
+    /** set by thread: duration of listAllItems() */
+    double m_seconds;
+    /** part of m_seconds which was not spent waiting for the thread */
+    double m_overlappedSeconds;
+    RevisionMap_t m_revisions;
+    SyncSource::Operations::Overlapped_t m_overlapped;
+};
+
+void *SyncSourceRevisions::prefetchThread(void *data)
+{
+    Prefetch *prefetch = static_cast<Prefetch *>(data);
+
+    // signals are handled by the main thread
+    sigset_t blocked;
+    sigfillset(&blocked);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+
+    Timespec start = Timespec::monotonic();
+    try {
+        prefetch->m_source->listAllItems(prefetch->m_revisions);
+        prefetch->m_valid = true;
+    } catch (...) {
+        // cannot log here, main thread will repeat the call
+        // and report the error
+        prefetch->m_revisions.clear();
+    }
+    prefetch->m_seconds = (Timespec::monotonic() - start).duration();
+    return NULL;
+}
+
+void SyncSourceRevisions::enablePrefetch(SyncSource::Operations &ops)
+{
+    ops.m_startPrefetch = boost::bind(&SyncSourceRevisions::startPrefetch, this, _1);
+    ops.m_endPrefetch = boost::bind(&SyncSourceRevisions::endPrefetch, this);
+}
+
+void SyncSourceRevisions::startPrefetch(const SyncSource::Operations::Overlapped_t &overlapped)
+{
+    if (m_prefetch) {
+        return;
+    }
+    m_prefetch.reset(new Prefetch);
+    m_prefetch->m_source = this;
+    m_prefetch->m_valid = false;
+    m_prefetch->m_seconds = 0;
+    m_prefetch->m_overlappedSeconds = 0;
+    m_prefetch->m_overlapped = overlapped;
+    m_prefetch->m_running = !pthread_create(&m_prefetch->m_thread, NULL,
+                                            prefetchThread, m_prefetch.get());
+    if (m_prefetch->m_running) {
+        SE_LOG_DEBUG(this, NULL, "listing items in the background");
+    } else {
+        m_prefetch.reset();
+    }
+}
+
+void SyncSourceRevisions::joinPrefetch()
+{
+    if (!m_prefetch || !m_prefetch->m_running) {
+        return;
+    }
+    Timespec start = Timespec::monotonic();
+    pthread_join(m_prefetch->m_thread, NULL);
+    m_prefetch->m_running = false;
+    double waited = (Timespec::monotonic() - start).duration();
+    m_prefetch->m_overlappedSeconds = std::max(m_prefetch->m_seconds - waited, 0.0);
+    if (m_prefetch->m_valid) {
+        SE_LOG_DEBUG(this, NULL, "listing %lu items in the background took %.3fs, waited %.3fs for it",
+                     (unsigned long)m_prefetch->m_revisions.size(),
+                     m_prefetch->m_seconds,
+                     waited);
+    } else {
+        SE_LOG_DEBUG(this, NULL, "listing items in the background failed, will list them again");
+    }
+}
+
+void SyncSourceRevisions::endPrefetch()
+{
+    joinPrefetch();
+    m_prefetch.reset();
+}
+
+bool SyncSourceRevisions::usePrefetched(bool consume)
+{
+    joinPrefetch();
+    if (!m_prefetch) {
+        return false;
+    }
+    if (!m_prefetch->m_valid) {
+        m_prefetch.reset();
+        return false;
+    }
+    // report the saved time only once
+    if (m_prefetch->m_overlapped) {
+        m_prefetch->m_overlapped(m_prefetch->m_overlappedSeconds);
+        m_prefetch->m_overlapped = SyncSource::Operations::Overlapped_t();
+    }
+    if (consume) {
+        m_revisions.swap(m_prefetch->m_revisions);
+        m_prefetch.reset();
+    } else {
+        m_revisions = m_prefetch->m_revisions;
+    }
+    m_revisionsSet = true;
+    return true;
+}
+
 
 void SyncSourceRevisions::backupData(const SyncSource::Operations::ConstBackupInfo &oldBackup,
                                      const SyncSource::Operations::BackupInfo &newBackup,
@@ -978,13 +1121,12 @@ void SyncSourceRevisions::restoreData(const SyncSource::Operations::ConstBackupI
             // nothing to do
         } else {
             // add or update, so need item
-            stringstream filename;
-            filename << oldBackup.m_dirname << "/" << counter;
+            string filename = ItemCache::getItemFile(oldBackup.m_dirname, counter);
             string data;
-            if (!ReadFile(filename.str(), data)) {
+            if (!ReadFileMaybeCompressed(filename, data)) {
                 throwError(StringPrintf("restoring %s from %s failed: could not read file",
                                         uid.c_str(),
-                                        filename.str().c_str()));
+                                        filename.c_str()));
             }
             // TODO: it would be nicer to recreate the item
             // with the original revision. If multiple peers
@@ -1057,6 +1199,9 @@ void SyncSourceRevisions::detectChanges(ConfigNode &trackingNode, ChangeMode mod
     }
 
     if (mode == CHANGES_NONE) {
+        // items listed in the background are not needed
+        endPrefetch();
+
         // shortcut because nothing changed: just copy our known item list
         ConfigProps props;
         trackingNode.readProperties(props);
@@ -1072,6 +1217,12 @@ void SyncSourceRevisions::detectChanges(ConfigNode &trackingNode, ChangeMode mod
         return;
     }
 
+    // a complete list from the background thread is as good as
+    // one from updateAllItems() or listAllItems()
+    if (!m_revisionsSet) {
+        usePrefetched(true);
+    }
+
     if (!m_revisionsSet &&
         mode == CHANGES_FULL) {
         ConfigProps props;
@@ -1279,6 +1430,153 @@ void SyncSourceLogging::init(const std::list<std::string> &fields,
                                                         this, _2));
 }
 
+// MapJournal file format: magic string, then records consisting of
+// <op 'S' or 'R'> <key size> <value size> <key> <value> <checksum>
+// with sizes and checksum as 32 bit little endian integers
+static const char MapJournalMagic[] = "SEMAPJ1\n";
+static const size_t MapJournalMagicSize = sizeof(MapJournalMagic) - 1;
+static const size_t MapJournalHeaderSize = 1 + 4 + 4;
+
+static void appendUInt32(std::string &buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        buffer += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static uint32_t readUInt32(const char *data)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    return bytes[0] |
+        (bytes[1] << 8) |
+        (bytes[2] << 16) |
+        (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+/** same algorithm as Hash(), for binary data and with fixed size */
+static uint32_t journalChecksum(const char *data, size_t len)
+{
+    uint32_t hashval = 5381;
+    for (size_t i = 0; i < len; i++) {
+        hashval = ((hashval << 5) + hashval) + static_cast<unsigned char>(data[i]);
+    }
+    return hashval;
+}
+
+MapJournal::MapJournal(const std::string &filename) :
+    m_filename(filename),
+    m_fd(-1)
+{
+}
+
+MapJournal::~MapJournal()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+size_t MapJournal::replay(ConfigProps &mapping) const
+{
+    std::string content;
+    if (!ReadFile(m_filename, content) ||
+        content.compare(0, MapJournalMagicSize, MapJournalMagic)) {
+        return 0;
+    }
+
+    size_t records = 0;
+    size_t offset = MapJournalMagicSize;
+    while (content.size() - offset >= MapJournalHeaderSize + 4) {
+        const char *record = content.data() + offset;
+        char op = record[0];
+        uint32_t keySize = readUInt32(record + 1);
+        uint32_t valueSize = readUInt32(record + 5);
+        if (keySize > content.size() || valueSize > content.size()) {
+            break;
+        }
+        size_t size = MapJournalHeaderSize + keySize + valueSize;
+        if (content.size() - offset < size + 4 ||
+            readUInt32(record + size) != journalChecksum(record, size)) {
+            // incomplete or damaged, ignore it and everything after it
+            break;
+        }
+        std::string key(record + MapJournalHeaderSize, keySize);
+        if (op == 'S') {
+            mapping[key] = std::string(record + MapJournalHeaderSize + keySize, valueSize);
+        } else if (op == 'R') {
+            mapping.erase(key);
+        } else {
+            break;
+        }
+        offset += size + 4;
+        records++;
+    }
+    return records;
+}
+
+void MapJournal::append(char op, const std::string &key, const std::string &value)
+{
+    std::string record;
+    if (m_fd < 0) {
+        mkdir_p(getDirname(m_filename));
+        int fd = open(m_filename.c_str(), O_WRONLY|O_CREAT|O_APPEND, S_IRUSR|S_IWUSR);
+        struct stat buf;
+        if (fd < 0 || fstat(fd, &buf)) {
+            std::string error = m_filename + ": " + strerror(errno);
+            if (fd >= 0) {
+                close(fd);
+            }
+            SE_THROW(error);
+        }
+        m_fd = fd;
+        if (!buf.st_size) {
+            record = MapJournalMagic;
+        }
+    }
+    size_t start = record.size();
+    record += op;
+    appendUInt32(record, key.size());
+    appendUInt32(record, value.size());
+    record += key;
+    record += value;
+    appendUInt32(record, journalChecksum(record.data() + start, record.size() - start));
+
+    // one write() per record, so a record is only incomplete
+    // when the process gets killed or the disk is full
+    size_t written = 0;
+    while (written < record.size()) {
+        ssize_t res = write(m_fd, record.data() + written, record.size() - written);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SE_THROW(m_filename + ": " + strerror(errno));
+        }
+        written += res;
+    }
+}
+
+void MapJournal::set(const std::string &key, const std::string &value)
+{
+    append('S', key, value);
+}
+
+void MapJournal::remove(const std::string &key)
+{
+    append('R', key, "");
+}
+
+void MapJournal::clear()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (unlink(m_filename.c_str()) && errno != ENOENT) {
+        SE_THROW(m_filename + ": " + strerror(errno));
+    }
+}
+
 sysync::TSyError SyncSourceAdmin::loadAdminData(const char *aLocDB,
                                                 const char *aRemDB,
                                                 char **adminData)
@@ -1330,9 +1628,11 @@ sysync::TSyError SyncSourceAdmin::insertMapItem(sysync::cMapID mID)
     }
 #else
     m_mapping[key] = value;
-    m_mappingNode->clear();
-    m_mappingNode->writeProperties(m_mapping);
-    m_mappingNode->flush();
+    if (m_journal) {
+        m_journal->set(key, value);
+    } else {
+        writeMap();
+    }
     return sysync::LOCERR_OK;
 #endif
 }
@@ -1348,9 +1648,11 @@ sysync::TSyError SyncSourceAdmin::updateMapItem(sysync::cMapID mID)
         return sysync::DB_Forbidden;
     } else {
         m_mapping[key] = value;
-        m_mappingNode->clear();
-        m_mappingNode->writeProperties(m_mapping);
-        m_mappingNode->flush();
+        if (m_journal) {
+            m_journal->set(key, value);
+        } else {
+            writeMap();
+        }
         return sysync::LOCERR_OK;
     }
 }
@@ -1366,9 +1668,11 @@ sysync::TSyError SyncSourceAdmin::deleteMapItem(sysync::cMapID mID)
         return sysync::DB_Forbidden;
     } else {
         m_mapping.erase(it);
-        m_mappingNode->clear();
-        m_mappingNode->writeProperties(m_mapping);
-        m_mappingNode->flush();
+        if (m_journal) {
+            m_journal->remove(key);
+        } else {
+            writeMap();
+        }
         return sysync::LOCERR_OK;
     }
 }
@@ -1377,9 +1681,11 @@ void SyncSourceAdmin::flush()
 {
     m_configNode->flush();
     if (m_mappingLoaded) {
-        m_mappingNode->clear();
-        m_mappingNode->writeProperties(m_mapping);
-        m_mappingNode->flush();
+        writeMap();
+        if (m_journal) {
+            // all changes are in the node now
+            m_journal->clear();
+        }
     }
 }
 
@@ -1387,10 +1693,30 @@ void SyncSourceAdmin::resetMap()
 {
     m_mapping.clear();
     m_mappingNode->readProperties(m_mapping);
+    if (m_journal) {
+        // changes made since the last flush(), for example
+        // by a session which was interrupted
+        size_t records = m_journal->replay(m_mapping);
+        if (records) {
+            SE_LOG_DEBUG(this, NULL, "restored %lu map item changes from %s",
+                         (unsigned long)records,
+                         m_journal->getFilename().c_str());
+            writeMap();
+        }
+        // start with an empty file, also when the old one was damaged
+        m_journal->clear();
+    }
     m_mappingIterator = m_mapping.begin();
     m_mappingLoaded = true;
 }
 
+void SyncSourceAdmin::writeMap()
+{
+    m_mappingNode->clear();
+    m_mappingNode->writeProperties(m_mapping);
+    m_mappingNode->flush();
+}
+
 
 void SyncSourceAdmin::mapid2entry(sysync::cMapID mID, string &key, string &value)
 {
@@ -1431,12 +1757,16 @@ void SyncSourceAdmin::entry2mapid(const string &key, const string &value, sysync
 void SyncSourceAdmin::init(SyncSource::Operations &ops,
                            const boost::shared_ptr<ConfigNode> &config,
                            const std::string adminPropertyName,
-                           const boost::shared_ptr<ConfigNode> &mapping)
+                           const boost::shared_ptr<ConfigNode> &mapping,
+                           const std::string &journalDir)
 {
     m_configNode = config;
     m_adminPropertyName = adminPropertyName;
     m_mappingNode = mapping;
     m_mappingLoaded = false;
+    if (!journalDir.empty()) {
+        m_journal.reset(new MapJournal(journalDir + "/map-items.journal"));
+    }
 
     ops.m_loadAdminData = boost::bind(&SyncSourceAdmin::loadAdminData,
                                       this, _1, _2, _3);
@@ -1459,7 +1789,8 @@ void SyncSourceAdmin::init(SyncSource::Operations &ops,
     init(ops,
          source->getProperties(true),
          SourceAdminDataName,
-         source->getServerNode());
+         source->getServerNode(),
+         source->getCacheDir());
 }
 
 void SyncSourceBlob::init(SyncSource::Operations &ops,
@@ -1497,6 +1828,7 @@ void TestingSyncSource::removeAllItems()
 class SyncSourceTest : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(SyncSourceTest);
     CPPUNIT_TEST(backendsAvailable);
+    CPPUNIT_TEST(mapJournal);
     CPPUNIT_TEST_SUITE_END();
 
     void backendsAvailable()
@@ -1507,6 +1839,57 @@ class SyncSourceTest : public CppUnit::TestFixture {
         CPPUNIT_ASSERT( !SyncSource::backendsInfo().empty() );
 #endif
     }
+
+    void mapJournal()
+    {
+        std::string filename = "SyncSourceTest.journal";
+        unlink(filename.c_str());
+        MapJournal journal(filename);
+        ConfigProps mapping;
+        CPPUNIT_ASSERT_EQUAL((size_t)0, journal.replay(mapping));
+
+        journal.set("a-1", "remote-a 0");
+        journal.set("b-1", std::string("remote\nb\0 2", 11));
+        journal.set("a-1", "remote-a 1");
+        journal.remove("b-1");
+        journal.set("c-1", "");
+        CPPUNIT_ASSERT_EQUAL((size_t)5, journal.replay(mapping));
+        CPPUNIT_ASSERT_EQUAL((size_t)2, mapping.size());
+        CPPUNIT_ASSERT_EQUAL(std::string("remote-a 1"), mapping["a-1"].get());
+        CPPUNIT_ASSERT_EQUAL(std::string(""), mapping["c-1"].get());
+
+        // binary values survive
+        journal.set("b-1", std::string("remote\nb\0 2", 11));
+        mapping.clear();
+        CPPUNIT_ASSERT_EQUAL((size_t)6, journal.replay(mapping));
+        CPPUNIT_ASSERT_EQUAL(std::string("remote\nb\0 2", 11), mapping["b-1"].get());
+
+        // incomplete last record is ignored
+        struct stat buf;
+        CPPUNIT_ASSERT_EQUAL(0, stat(filename.c_str(), &buf));
+        CPPUNIT_ASSERT_EQUAL(0, truncate(filename.c_str(), buf.st_size - 1));
+        mapping.clear();
+        CPPUNIT_ASSERT_EQUAL((size_t)5, journal.replay(mapping));
+        CPPUNIT_ASSERT(mapping.find("b-1") == mapping.end());
+
+        // damaged record is ignored, together with everything after it
+        std::string content;
+        CPPUNIT_ASSERT(ReadFile(filename, content));
+        content[content.find("remote-a 1")] = 'R';
+        {
+            std::ofstream out(filename.c_str());
+            out << content;
+        }
+        mapping.clear();
+        CPPUNIT_ASSERT_EQUAL((size_t)2, journal.replay(mapping));
+        CPPUNIT_ASSERT_EQUAL(std::string("remote-a 0"), mapping["a-1"].get());
+        CPPUNIT_ASSERT(mapping.find("b-1") != mapping.end());
+
+        journal.clear();
+        CPPUNIT_ASSERT(access(filename.c_str(), F_OK));
+        mapping.clear();
+        CPPUNIT_ASSERT_EQUAL((size_t)0, journal.replay(mapping));
+    }
 };
 
 SYNCEVOLUTION_TEST_SUITE_REGISTRATION(SyncSourceTest);
@@ -1243,6 +1243,34 @@ class SyncSourceBase : public Logger {
         typedef bool (IsEmpty_t)();
         boost::function<IsEmpty_t> m_isEmpty;
 
+        /**
+         * Start work in a background thread which will be needed
+         * later in the session, typically listing all items for
+         * change detection. Called by a client directly after open(),
+         * so that the work overlaps with the initial SyncML message
+         * exchange. The source itself waits for the result when it
+         * needs it.
+         *
+         * Only sources which can do that work without interfering
+         * with the main thread provide this operation.
+         *
+         * @param overlapped   invoked in the main thread with the number
+         *                     of seconds that the background work saved
+         *                     once its result gets used; may be empty
+         */
+        typedef boost::function<void (double seconds)> Overlapped_t;
+        typedef void (StartPrefetch_t)(const Overlapped_t &overlapped);
+        boost::function<StartPrefetch_t> m_startPrefetch;
+
+        /**
+         * Wait for the background work started by m_startPrefetch and
+         * discard its result. Must be called before destroying a source
+         * for which m_startPrefetch was called. Harmless if nothing
+         * was started or the result was used already.
+         */
+        typedef void (EndPrefetch_t)();
+        boost::function<EndPrefetch_t> m_endPrefetch;
+
         /**
          * Synthesis DB API callbacks. For documentation see the
          * Synthesis API specification (PDF and/or sync_dbapi.h).
@@ -2103,6 +2131,16 @@ public:
      */
     string getFilename(Hash_t hash);
 
+    /**
+     * Name of the file holding an item in a backup directory. Items
+     * are stored gzip-compressed in "<counter>.gz" if
+     * SYNCEVOLUTION_LOG_COMPRESSION was set when creating the backup
+     * or when the session directory was compacted later on, otherwise
+     * in "<counter>". Use ReadFileMaybeCompressed() to read either
+     * of them.
+     */
+    static string getItemFile(const string &dirname, long counter);
+
     /**
      * add a new item, reusing old one if possible
      *
@@ -2127,6 +2165,8 @@ private:
     SyncSource::Operations::BackupInfo m_backup;
     bool m_legacy;
     unsigned long m_counter;
+    /** compression level for new files, 0 for plain files */
+    int m_compression;
 };
 
 /**
@@ -2310,6 +2350,22 @@ class SyncSourceRevisions : virtual public SyncSourceChanges, virtual public Syn
               int granularity,
               SyncSource::Operations &ops);
 
+ protected:
+    /**
+     * set m_startPrefetch and m_endPrefetch operations which call
+     * listAllItems() in a background thread; detectChanges() and
+     * backupData() then use that result instead of listing items
+     * again
+     *
+     * Only call this if listAllItems() is thread-safe: it must not
+     * log, must not use the Synthesis engine or the glib main loop
+     * and must only write member variables which the main thread
+     * doesn't touch before detectChanges(). Errors in the background
+     * are ignored, listAllItems() is then simply called again in
+     * the main thread.
+     */
+    void enablePrefetch(SyncSource::Operations &ops);
+
  private:
     SyncSourceRaw *m_raw;
     SyncSourceDelete *m_del;
@@ -2321,6 +2377,21 @@ class SyncSourceRevisions : virtual public SyncSourceChanges, virtual public Syn
     bool m_firstCycle;
     void initRevisions();
 
+    /** state of background listAllItems(), NULL if none was started */
+    struct Prefetch;
+    boost::shared_ptr<Prefetch> m_prefetch;
+    static void *prefetchThread(void *data);
+    void startPrefetch(const SyncSource::Operations::Overlapped_t &overlapped);
+    void endPrefetch();
+    /** wait for background thread, log and remember how long it ran */
+    void joinPrefetch();
+    /**
+     * copy (consume == false) or move (consume == true) result of
+     * background listAllItems() into m_revisions
+     * @return false if there is no result
+     */
+    bool usePrefetched(bool consume);
+
     /**
      * Dump all data from source unmodified into the given directory.
      * The ConfigNode can be used to store meta information needed for
@@ -2403,10 +2474,53 @@ class SyncSourceLogging : public virtual SyncSourceBase
     void deleteItem(sysync::cItemID aID);
 };
 
+/**
+ * Binary file to which changes of the map items are appended, so
+ * that each change is saved without rewriting the whole map node.
+ *
+ * Each record stores one key/value pair to be set or one key to be
+ * removed, followed by a checksum. Reading stops at the first
+ * incomplete or damaged record, which is what an interrupted write
+ * leaves behind.
+ */
+class MapJournal
+{
+    std::string m_filename;
+    /** opened for appending when needed, -1 if not open */
+    int m_fd;
+
+    void append(char op, const std::string &key, const std::string &value);
+
+ public:
+    MapJournal(const std::string &filename);
+    ~MapJournal();
+
+    const std::string &getFilename() const { return m_filename; }
+
+    /**
+     * apply all valid records in the file to the map
+     *
+     * @return number of records applied
+     */
+    size_t replay(ConfigProps &mapping) const;
+
+    /** record setting a key, written before returning */
+    void set(const std::string &key, const std::string &value);
+
+    /** record removing a key, written before returning */
+    void remove(const std::string &key);
+
+    /** remove the file, once the map was written elsewhere */
+    void clear();
+};
+
 /**
  * Implements Load/SaveAdminData and MapItem handling in a SyncML
  * server. Uses a single property for the admin data in the "internal"
- * node and a complete node for the map items.
+ * node and a complete node for the map items. When a directory for
+ * it is available, changes of map items are only appended to a
+ * MapJournal and the node is written once when the source is
+ * flushed.
  */
 class SyncSourceAdmin : public virtual SyncSourceBase
 {
@@ -2414,6 +2528,8 @@ class SyncSourceAdmin : public virtual SyncSourceBase
     std::string m_adminPropertyName;
     boost::shared_ptr<ConfigNode> m_mappingNode;
     bool m_mappingLoaded;
+    /** changes of m_mapping not written to m_mappingNode yet, NULL if not used */
+    boost::shared_ptr<MapJournal> m_journal;
 
     ConfigProps m_mapping;
     ConfigProps::const_iterator m_mappingIterator;
@@ -2429,15 +2545,22 @@ class SyncSourceAdmin : public virtual SyncSourceBase
     void flush();
 
     void resetMap();
+    void writeMap();
     void mapid2entry(sysync::cMapID mID, string &key, string &value);
     void entry2mapid(const string &key, const string &value, sysync::MapID mID);
 
  public:
-    /** flexible initialization */
+    /**
+     * flexible initialization
+     *
+     * @param journalDir   directory for the MapJournal, empty if
+     *                     every change has to be written to the node
+     */
     void init(SyncSource::Operations &ops,
               const boost::shared_ptr<ConfigNode> &config,
               const std::string adminPropertyName,
-              const boost::shared_ptr<ConfigNode> &mapping);
+              const boost::shared_ptr<ConfigNode> &mapping,
+              const std::string &journalDir = "");
 
     /**
      * simpler initialization, using the default placement of data
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <syncevo/SyncTiming.h>
+#include <syncevo/util.h>
+#include <test.h>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+void SyncTiming::reset()
+{
+    m_start =
+        m_last = Timespec::monotonic();
+    m_stack.clear();
+    for (int phase = 0; phase < PHASE_MAX; phase++) {
+        m_seconds[phase] = 0;
+        m_counts[phase] = 0;
+    }
+    m_messages = 0;
+    m_bytes = 0;
+    m_overlapped = 0;
+}
+
+void SyncTiming::push(Phase phase)
+{
+    Timespec now = Timespec::monotonic();
+    if (!m_stack.empty()) {
+        m_seconds[m_stack.back()] += (now - m_last).duration();
+    }
+    m_stack.push_back(phase);
+    m_counts[phase]++;
+    m_last = now;
+}
+
+void SyncTiming::pop()
+{
+    if (m_stack.empty()) {
+        return;
+    }
+    Timespec now = Timespec::monotonic();
+    m_seconds[m_stack.back()] += (now - m_last).duration();
+    m_stack.pop_back();
+    m_last = now;
+}
+
+double SyncTiming::getTotal() const
+{
+    return (Timespec::monotonic() - m_start).duration();
+}
+
+const char *SyncTiming::getPhaseName(Phase phase)
+{
+    switch (phase) {
+    case PHASE_ENGINE: return "engine";
+    case PHASE_TRANSPORT: return "transport";
+    case PHASE_CHANGES: return "changes";
+    case PHASE_ITEMS: return "items";
+    case PHASE_MAPS: return "maps";
+    case PHASE_BACKUP: return "backup";
+    case PHASE_MAX: break;
+    }
+    return "???";
+}
+
+std::string SyncTiming::format() const
+{
+    std::string res;
+    double total = getTotal();
+    double other = total;
+    for (int i = 0; i < PHASE_MAX; i++) {
+        Phase phase = static_cast<Phase>(i);
+        res += StringPrintf("%s=%.3fs/%lu ",
+                            getPhaseName(phase),
+                            m_seconds[phase],
+                            m_counts[phase]);
+        other -= m_seconds[phase];
+    }
+    // the currently active phase is not accounted for yet
+    if (other < 0) {
+        other = 0;
+    }
+    res += StringPrintf("other=%.3fs total=%.3fs messages=%lu bytes=%lu overlapped=%.3fs",
+                        other, total, m_messages, m_bytes, m_overlapped);
+    return res;
+}
+
+#ifdef ENABLE_UNIT_TESTS
+
+class SyncTimingTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(SyncTimingTest);
+    CPPUNIT_TEST(nesting);
+    CPPUNIT_TEST_SUITE_END();
+
+    void nesting()
+    {
+        SyncTiming timing;
+        // unbalanced pop() must be harmless
+        timing.pop();
+        {
+            SyncTiming::Scope engine(timing, SyncTiming::PHASE_ENGINE);
+            Sleep(0.01);
+            for (int i = 0; i < 3; i++) {
+                SyncTiming::Scope items(timing, SyncTiming::PHASE_ITEMS);
+                Sleep(0.01);
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(1ul, timing.getCount(SyncTiming::PHASE_ENGINE));
+        CPPUNIT_ASSERT_EQUAL(3ul, timing.getCount(SyncTiming::PHASE_ITEMS));
+        CPPUNIT_ASSERT_EQUAL(0ul, timing.getCount(SyncTiming::PHASE_BACKUP));
+        CPPUNIT_ASSERT(timing.getSeconds(SyncTiming::PHASE_ITEMS) >= 0.03);
+        // time spent in nested phases is not counted twice
+        CPPUNIT_ASSERT(timing.getSeconds(SyncTiming::PHASE_ENGINE) >= 0.01);
+        CPPUNIT_ASSERT(timing.getSeconds(SyncTiming::PHASE_ENGINE) +
+                       timing.getSeconds(SyncTiming::PHASE_ITEMS) <= timing.getTotal());
+        CPPUNIT_ASSERT_EQUAL(0.0, timing.getSeconds(SyncTiming::PHASE_BACKUP));
+
+        timing.sent(100);
+        timing.sent(50);
+        CPPUNIT_ASSERT_EQUAL(2ul, timing.getMessages());
+        CPPUNIT_ASSERT_EQUAL(150ul, timing.getBytes());
+        CPPUNIT_ASSERT(timing.format().find(" messages=2 bytes=150") != std::string::npos);
+
+        timing.overlapped(0.5);
+        timing.overlapped(0.25);
+        CPPUNIT_ASSERT_EQUAL(0.75, timing.getOverlapped());
+        CPPUNIT_ASSERT(timing.format().find(" overlapped=0.750s") != std::string::npos);
+
+        timing.reset();
+        CPPUNIT_ASSERT_EQUAL(0ul, timing.getCount(SyncTiming::PHASE_ITEMS));
+        CPPUNIT_ASSERT_EQUAL(0.0, timing.getSeconds(SyncTiming::PHASE_ITEMS));
+        CPPUNIT_ASSERT_EQUAL(0ul, timing.getMessages());
+        CPPUNIT_ASSERT_EQUAL(0.0, timing.getOverlapped());
+    }
+};
+
+SYNCEVOLUTION_TEST_SUITE_REGISTRATION(SyncTimingTest);
+
+#endif // ENABLE_UNIT_TESTS
+
+SE_END_CXX
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2012 Intel Corporation
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#ifndef INCL_SYNCEVOLUTION_SYNC_TIMING
+# define INCL_SYNCEVOLUTION_SYNC_TIMING
+
+#include <syncevo/Timespec.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+
+#include <syncevo/declarations.h>
+SE_BEGIN_CXX
+
+/**
+ * Accumulates the time spent in the different phases of a sync
+ * session. Phases nest: entering a phase pauses the one which is
+ * currently active, leaving it resumes the outer phase. Therefore
+ * each phase only counts its own time and the sum of all phases
+ * never exceeds the total duration of the session; the remainder
+ * is reported as "other".
+ *
+ * Entering and leaving a phase costs two clock_gettime() calls,
+ * cheap enough to be done for each item.
+ *
+ * Also counts the SyncML messages sent by this side and their size
+ * and how much work was done in background threads.
+ */
+class SyncTiming : private boost::noncopyable
+{
+ public:
+    enum Phase {
+        /** Synthesis engine: parsing and generating SyncML messages */
+        PHASE_ENGINE,
+        /** sending a message and waiting for the reply */
+        PHASE_TRANSPORT,
+        /** change detection in the sources */
+        PHASE_CHANGES,
+        /** reading, adding, updating and deleting items */
+        PHASE_ITEMS,
+        /** admin data and ID mapping */
+        PHASE_MAPS,
+        /** database dumps before and after the sync */
+        PHASE_BACKUP,
+        PHASE_MAX
+    };
+
+    SyncTiming() { reset(); }
+
+    /** forget all previous measurements, start new session */
+    void reset();
+
+    /** pause current phase (if any) and enter the new one */
+    void push(Phase phase);
+
+    /** leave the current phase, resume the outer one; ignored if no phase is active */
+    void pop();
+
+    /** seconds spent in the phase itself, excluding nested phases */
+    double getSeconds(Phase phase) const { return m_seconds[phase]; }
+
+    /** number of times that the phase was entered */
+    unsigned long getCount(Phase phase) const { return m_counts[phase]; }
+
+    /** seconds since reset() */
+    double getTotal() const;
+
+    /** count one message of the given size as sent */
+    void sent(size_t bytes) { m_messages++; m_bytes += bytes; }
+
+    /** number of messages sent */
+    unsigned long getMessages() const { return m_messages; }
+
+    /** total size of messages sent */
+    unsigned long getBytes() const { return m_bytes; }
+
+    /** count work which ran in the background, in parallel to the phases */
+    void overlapped(double seconds) { m_overlapped += seconds; }
+
+    /** seconds of background work, not included in the phases */
+    double getOverlapped() const { return m_overlapped; }
+
+    /** "engine", "transport", ... */
+    static const char *getPhaseName(Phase phase);
+
+    /**
+     * One line with "<phase>=<seconds>s/<count>" for each phase,
+     * followed by "other=<seconds>s total=<seconds>s messages=<count> bytes=<count>
+     * overlapped=<seconds>s".
+     */
+    std::string format() const;
+
+    /** enter a phase in the constructor, leave it in the destructor */
+    class Scope : private boost::noncopyable
+    {
+        SyncTiming &m_timing;
+    public:
+        Scope(SyncTiming &timing, Phase phase) : m_timing(timing) { m_timing.push(phase); }
+        ~Scope() { m_timing.pop(); }
+    };
+
+ private:
+    Timespec m_start;
+    /** start of the current phase or when it was resumed */
+    Timespec m_last;
+    std::vector<Phase> m_stack;
+    double m_seconds[PHASE_MAX];
+    unsigned long m_counts[PHASE_MAX];
+    unsigned long m_messages;
+    unsigned long m_bytes;
+    double m_overlapped;
+};
+
+SE_END_CXX
+#endif // INCL_SYNCEVOLUTION_SYNC_TIMING
@@ -19,6 +19,9 @@
 
 #include <syncevo/TransportAgent.h>
 #include <syncevo/SyncConfig.h>
+#include <syncevo/Logging.h>
+
+#include <boost/algorithm/string/predicate.hpp>
 
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
@@ -39,6 +42,76 @@ void HTTPTransportAgent::setConfig(SyncConfig &config)
     setSSL(config.findSSLServerCertificate(),
            config.getSSLVerifyServer(),
            config.getSSLVerifyHost());
+#ifdef HAVE_ZLIB
+    setCompression(config.getCompression());
+#endif
+}
+
+void HTTPTransportAgent::encodeMessage(const char *&data, size_t &len, std::string &encoding)
+{
+    // a message sent again after compressionRejected() was already counted
+    if (m_resending) {
+        m_resending = false;
+    } else {
+        m_transferStats.m_rawSent += len;
+    }
+    if (m_compression && !m_compressionRejected) {
+        encoding = "gzip";
+        m_compressedMessage = CompressHTTPBody(data, len, encoding);
+        SE_LOG_DEBUG(NULL, NULL, "compressed message from %lu to %lu bytes",
+                     (unsigned long)len,
+                     (unsigned long)m_compressedMessage.size());
+        data = m_compressedMessage.c_str();
+        len = m_compressedMessage.size();
+    } else {
+        encoding = "";
+    }
+    m_transferStats.m_wireSent += len;
+}
+
+bool HTTPTransportAgent::compressionRejected(int httpStatus, const std::string &encoding,
+                                             const char *reply, size_t replyLen)
+{
+    if (encoding.empty()) {
+        return false;
+    }
+    switch (httpStatus) {
+    case 415: /* Unsupported Media Type, RFC 7231 for unsupported Content-Encoding */
+        break;
+    case 400: /* Bad Request, only if the server says why */
+        if (!reply ||
+            !boost::icontains(std::string(reply, replyLen), "encoding")) {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+    SE_LOG_INFO(NULL, NULL, "server rejected compressed message with HTTP status %d, sending it again without compression",
+                httpStatus);
+    m_compressionRejected = true;
+    m_resending = true;
+    return true;
+}
+
+void HTTPTransportAgent::decodeReply(const char *&data, size_t &len, const std::string &encoding)
+{
+    m_transferStats.m_wireReceived += len;
+    if (!encoding.empty() &&
+        !boost::iequals(encoding, "identity")) {
+        if (!DecompressHTTPBody(data, len, encoding, m_decompressedReply)) {
+            SE_THROW_EXCEPTION(TransportException,
+                               StringPrintf("could not decode reply with Content-Encoding %s",
+                                            encoding.c_str()));
+        }
+        SE_LOG_DEBUG(NULL, NULL, "decompressed %s reply from %lu to %lu bytes",
+                     encoding.c_str(),
+                     (unsigned long)len,
+                     (unsigned long)m_decompressedReply.size());
+        data = m_decompressedReply.c_str();
+        len = m_decompressedReply.size();
+    }
+    m_transferStats.m_rawReceived += len;
 }
 
 SE_END_CXX
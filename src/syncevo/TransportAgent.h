@@ -22,6 +22,7 @@
 
 #include <string>
 #include <syncevo/util.h>
+#include <syncevo/SyncML.h>
 
 #include <syncevo/declarations.h>
 SE_BEGIN_CXX
@@ -166,6 +167,12 @@ class TransportAgent
 class HTTPTransportAgent : public TransportAgent
 {
  public:
+    HTTPTransportAgent() :
+        m_compression(false),
+        m_compressionRejected(false),
+        m_resending(false)
+    {}
+
     /**
      * set proxy for transport, in protocol://[user@]host[:port] format
      */
@@ -194,11 +201,65 @@ class HTTPTransportAgent : public TransportAgent
      */
     virtual void setUserAgent(const std::string &agent) = 0;
 
+    /**
+     * Compress messages with gzip and accept compressed replies.
+     * If the server rejects a compressed message, the agent sends
+     * it again uncompressed and stops compressing messages.
+     */
+    void setCompression(bool enabled) { m_compression = enabled; }
+
     /**
      * convenience method which copies the HTTP settings from
      * SyncConfig
      */
     void setConfig(SyncConfig &config);
+
+    /** bytes sent and received so far, before and after compression */
+    const SyncReport::TransferStats &getTransferStats() const { return m_transferStats; }
+
+ protected:
+    /**
+     * Compresses the message if enabled and counts bytes. Afterwards
+     * data and len refer to what has to be sent, which is either the
+     * original message or m_compressedMessage.
+     *
+     * @retval encoding    Content-Encoding of data, empty if not compressed
+     */
+    void encodeMessage(const char *&data, size_t &len, std::string &encoding);
+
+    /**
+     * Must be called when the server replied with an error to a
+     * message sent with the given encoding. Turns off compression
+     * if the error indicates that the server cannot handle it:
+     * 415 Unsupported Media Type, or 400 Bad Request with a reply
+     * which mentions the encoding. Other errors are left to the caller.
+     *
+     * @param reply        body of the error reply, may be NULL
+     * @return true if the message has to be sent again uncompressed
+     */
+    bool compressionRejected(int httpStatus, const std::string &encoding,
+                             const char *reply, size_t replyLen);
+
+    /**
+     * Decompresses the reply if necessary and counts bytes.
+     * Afterwards data and len refer to the uncompressed reply,
+     * which may be stored in m_decompressedReply.
+     *
+     * @param encoding     Content-Encoding of the reply, may be empty
+     */
+    void decodeReply(const char *&data, size_t &len, const std::string &encoding);
+
+    /** value for Accept-Encoding header, empty if none */
+    std::string getAcceptEncoding() const { return m_compression ? "gzip, deflate" : ""; }
+
+ private:
+    bool m_compression;
+    bool m_compressionRejected;
+    /** set by compressionRejected(), next encodeMessage() is a resend */
+    bool m_resending;
+    std::string m_compressedMessage;
+    std::string m_decompressedReply;
+    SyncReport::TransferStats m_transferStats;
 };
 
 SE_END_CXX
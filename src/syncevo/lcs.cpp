@@ -20,8 +20,11 @@
 
 #include <syncevo/lcs.h>
 #include <syncevo/util.h>
+#include <syncevo/Timespec.h>
 #include <test.h>
 
+#include <boost/foreach.hpp>
+
 #include <list>
 #include <vector>
 #include <algorithm>
@@ -99,9 +102,25 @@ make_enumerate_chunks(const std::string &keyword, IT out, C count)
     return EnumerateChunks<IT, C>(keyword, out, count);
 }           
 
+/**
+ * pseudo-random sequence of numbers as strings, taken from
+ * a pool of the given size, so that some of them repeat
+ */
+static std::vector<std::string> randomSequence(size_t length, unsigned int pool, unsigned int &seed)
+{
+    std::vector<std::string> result;
+    result.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245 + 12345;
+        result.push_back(StringPrintf("%u", (seed >> 16) % pool));
+    }
+    return result;
+}
+
 class LCSTest : public CppUnit::TestFixture {
     CPPUNIT_TEST_SUITE(LCSTest);
     CPPUNIT_TEST(lcs);
+    CPPUNIT_TEST(linear);
     CPPUNIT_TEST_SUITE_END();
  
 public:
@@ -125,15 +144,83 @@ public:
                              out.str());
         CPPUNIT_ASSERT_EQUAL((size_t)3, result.size());
     }
+
+    /**
+     * Large enough for LCS::Hirschberg: must find an LCS of the same
+     * length as the matrix algorithm.
+     */
+    void linear()
+    {
+        typedef std::vector<std::string> content;
+        unsigned int seed = 1;
+        for (int i = 0; i < 10; i++) {
+            content content1 = randomSequence(300 + i * 50, 20 + i * 10, seed);
+            content content2 = randomSequence(400 - i * 10, 20 + i * 10, seed);
+            if (i % 2) {
+                // mostly identical, like two dumps of the same database
+                content2 = content1;
+                for (int e = 0; e < 10; e++) {
+                    content2.erase(content2.begin() + (seed >> 16) % content2.size());
+                    content2.insert(content2.begin() + (seed >> 8) % content2.size(), "new");
+                    seed = seed * 1103515245 + 12345;
+                }
+            }
+            std::vector< LCS::Entry<std::string> > matrix, linear;
+            LCS::lcs_matrix(content1, content2, std::back_inserter(matrix), LCS::accessor_sequence<content>());
+            LCS::lcs(content1, content2, std::back_inserter(linear), LCS::accessor_sequence<content>());
+            CPPUNIT_ASSERT_EQUAL(matrix.size(), linear.size());
+
+            size_t last_a = 0, last_b = 0;
+            BOOST_FOREACH(const LCS::Entry<std::string> &entry, linear) {
+                CPPUNIT_ASSERT(entry.index_a > last_a);
+                CPPUNIT_ASSERT(entry.index_b > last_b);
+                CPPUNIT_ASSERT_EQUAL(content1[entry.index_a - 1], entry.element);
+                CPPUNIT_ASSERT_EQUAL(content2[entry.index_b - 1], entry.element);
+                last_a = entry.index_a;
+                last_b = entry.index_b;
+            }
+        }
+    }
 };
 
 SYNCEVOLUTION_TEST_SUITE_REGISTRATION(LCSTest);
 
 #ifdef MAIN
+/**
+ * compare random sequences of 1k/10k/100k entries with the unit-cost
+ * algorithm, the full matrix only where it fits into memory
+ */
+static int benchmark()
+{
+    typedef std::vector<std::string> content;
+    unsigned int seed = 1;
+    for (size_t length = 1000; length <= 100000; length *= 10) {
+        content content1 = randomSequence(length, length / 2, seed);
+        content content2 = randomSequence(length, length / 2, seed);
+        std::vector< LCS::Entry<std::string> > result;
+        Timespec start = Timespec::monotonic();
+        LCS::lcs(content1, content2, std::back_inserter(result), LCS::accessor_sequence<content>());
+        Timespec duration = Timespec::monotonic() - start;
+        std::cout << length << " entries, linear: " << duration.duration() << "s, length " << result.size() << std::endl;
+        if (length <= 10000) {
+            result.clear();
+            start = Timespec::monotonic();
+            LCS::lcs_matrix(content1, content2, std::back_inserter(result), LCS::accessor_sequence<content>());
+            duration = Timespec::monotonic() - start;
+            std::cout << length << " entries, matrix: " << duration.duration() << "s, length " << result.size() << std::endl;
+        }
+    }
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
+    if (argc == 2 && std::string(argv[1]) == "--benchmark") {
+        return benchmark();
+    }
     if (argc != 3) {
         std::cerr << "Usage: lcs file1 file2" << std::endl;
+        std::cerr << "       lcs --benchmark" << std::endl;
         return 1;
     }
 
@@ -23,8 +23,11 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include <ostream>
 
+#include <stdint.h>
+
 // for size_t and ssize_t
 #include <unistd.h>
 
@@ -149,7 +152,7 @@ public:
  * template parameters.
  */
 template <class T, class ITO, class A>
-void lcs(const T &a, const T &b, ITO out, A access)
+void lcs_matrix(const T &a, const T &b, ITO out, A access)
 {
     // reserve two-dimensonal array for sub-problem solutions,
     // adding rows as we go
@@ -256,6 +259,234 @@ void lcs(const T &a, const T &b, ITO out, A access)
     }
 }
 
+/**
+ * Hirschberg's linear-space LCS algorithm for the unit-cost case
+ * (accessor_sequence): the first sequence is split in the middle, the
+ * LCS lengths of both halves against all prefixes resp. suffixes of
+ * the second sequence determine where to split that one, then both
+ * parts are solved recursively. Small sub-problems are handed to
+ * lcs_matrix().
+ *
+ * The lengths are computed with the bit-parallel algorithm from
+ * Allison/Dix and Hyyrö: one bit per entry of the second sequence,
+ * 64 entries per machine word, so the quadratic part of the work is
+ * divided by 64. Requires that entries can be ordered with operator <.
+ *
+ * Finds an LCS of the same length as lcs_matrix(), but not
+ * necessarily the same one when there is more than one.
+ */
+template <class T, class A> class Hirschberg {
+public:
+    typedef typename A::F F;
+    typedef std::list< std::pair<size_t, size_t> > indexlist;
+
+    Hirschberg(const T &a, const T &b, A access) :
+        m_a(a), m_b(b), m_access(access)
+    {}
+
+    /** appends 1-based index pairs of matching entries to indices */
+    void solve(size_t alo, size_t ahi, size_t blo, size_t bhi, indexlist &indices)
+    {
+        // strip common prefix and suffix, cheap and frequent
+        while (alo < ahi && blo < bhi &&
+               m_access.entry_at(m_a, alo) == m_access.entry_at(m_b, blo)) {
+            indices.push_back(std::make_pair(alo + 1, blo + 1));
+            alo++;
+            blo++;
+        }
+        indexlist suffix;
+        while (alo < ahi && blo < bhi &&
+               m_access.entry_at(m_a, ahi - 1) == m_access.entry_at(m_b, bhi - 1)) {
+            suffix.push_front(std::make_pair(ahi, bhi));
+            ahi--;
+            bhi--;
+        }
+
+        if (alo < ahi && blo < bhi) {
+            if (ahi - alo == 1) {
+                // single entry, splitting would not make progress
+                for (size_t j = blo; j < bhi; j++) {
+                    if (m_access.entry_at(m_a, alo) == m_access.entry_at(m_b, j)) {
+                        indices.push_back(std::make_pair(alo + 1, j + 1));
+                        break;
+                    }
+                }
+            } else if (ahi - alo <= MATRIX_CELLS / (bhi - blo)) {
+                solveMatrix(alo, ahi, blo, bhi, indices);
+            } else {
+                size_t amid = alo + (ahi - alo) / 2;
+                std::vector<size_t> forward, backward;
+                lengths(alo, amid, blo, bhi, false, forward);
+                lengths(amid, ahi, blo, bhi, true, backward);
+                // forward[k] = LCS of a[alo,amid) and b[blo,blo+k),
+                // backward[k] = LCS of a[amid,ahi) and b[bhi-k,bhi)
+                size_t n = bhi - blo;
+                size_t best = 0, split = 0;
+                for (size_t k = 0; k <= n; k++) {
+                    size_t len = forward[k] + backward[n - k];
+                    if (len > best) {
+                        best = len;
+                        split = k;
+                    }
+                }
+                solve(alo, amid, blo, blo + split, indices);
+                solve(amid, ahi, blo + split, bhi, indices);
+            }
+        }
+
+        indices.splice(indices.end(), suffix);
+    }
+
+private:
+    const T &m_a;
+    const T &m_b;
+    A m_access;
+
+    /** sub-problems up to this size are solved with the full matrix */
+    static const size_t MATRIX_CELLS = 4096;
+
+    /** the sub-sequence a[lo,hi), as expected by lcs_matrix() */
+    class Range {
+    public:
+        typedef typename Hirschberg::F value_type;
+
+        Range(const T &seq, A access, size_t lo, size_t hi) :
+            m_seq(seq), m_access(access), m_lo(lo), m_hi(hi) {}
+        size_t size() const { return m_hi - m_lo; }
+        bool empty() const { return m_hi == m_lo; }
+        const F &operator [] (size_t index) const { return m_access.entry_at(m_seq, m_lo + index); }
+
+    private:
+        const T &m_seq;
+        A m_access;
+        size_t m_lo, m_hi;
+    };
+
+    /** output iterator which stores indices shifted by offset */
+    class Collect {
+    public:
+        Collect(indexlist &indices, size_t aoffset, size_t boffset) :
+            m_indices(indices), m_aoffset(aoffset), m_boffset(boffset) {}
+        Collect &operator * () { return *this; }
+        Collect &operator ++ () { return *this; }
+        Collect &operator ++ (int) { return *this; }
+        Collect &operator = (const Entry<F> &entry) {
+            m_indices.push_back(std::make_pair(entry.index_a + m_aoffset,
+                                               entry.index_b + m_boffset));
+            return *this;
+        }
+
+    private:
+        indexlist &m_indices;
+        size_t m_aoffset, m_boffset;
+    };
+
+    void solveMatrix(size_t alo, size_t ahi, size_t blo, size_t bhi, indexlist &indices)
+    {
+        Range a(m_a, m_access, alo, ahi), b(m_b, m_access, blo, bhi);
+        lcs_matrix(a, b, Collect(indices, alo, blo), accessor_sequence<Range>());
+    }
+
+    /**
+     * Determines the LCS length of a[alo,ahi) and all prefixes
+     * of b[blo,bhi) (reverse == false) resp. all suffixes (reverse == true).
+     *
+     * @retval result     result[k] = LCS length for prefix/suffix of length k
+     */
+    void lengths(size_t alo, size_t ahi, size_t blo, size_t bhi, bool reverse,
+                 std::vector<size_t> &result)
+    {
+        size_t n = bhi - blo;
+        size_t words = (n + 63) / 64;
+
+        // bit p in the match vector of an entry is set if the entry
+        // is found at b[blo + p] (resp. b[bhi - 1 - p])
+        typedef std::map< F, std::vector<uint64_t> > Matches_t;
+        Matches_t matches;
+        for (size_t p = 0; p < n; p++) {
+            const F &entry = m_access.entry_at(m_b, reverse ? bhi - 1 - p : blo + p);
+            std::vector<uint64_t> &mask = matches[entry];
+            if (mask.empty()) {
+                mask.resize(words);
+            }
+            mask[p / 64] |= (uint64_t)1 << (p % 64);
+        }
+
+        // zero bits in the lowest k bits of v = LCS length of the
+        // rows processed so far and the first k entries
+        std::vector<uint64_t> v(words, ~(uint64_t)0);
+        for (size_t row = 0; row < ahi - alo; row++) {
+            typename Matches_t::const_iterator it =
+                matches.find(m_access.entry_at(m_a, reverse ? ahi - 1 - row : alo + row));
+            if (it == matches.end()) {
+                // v' = v
+                continue;
+            }
+            const std::vector<uint64_t> &mask = it->second;
+            // v' = (v + (v & mask)) | (v & ~mask), with carry across words
+            uint64_t carry = 0;
+            for (size_t w = 0; w < words; w++) {
+                uint64_t u = v[w] & mask[w];
+                uint64_t sum = v[w] + u;
+                uint64_t carryOut = sum < v[w];
+                sum += carry;
+                carryOut |= sum < carry;
+                carry = carryOut;
+                v[w] = sum | (v[w] & ~mask[w]);
+            }
+        }
+
+        result.resize(n + 1);
+        result[0] = 0;
+        size_t zeros = 0;
+        for (size_t p = 0; p < n; p++) {
+            if (!(v[p / 64] & ((uint64_t)1 << (p % 64)))) {
+                zeros++;
+            }
+            result[p + 1] = zeros;
+        }
+    }
+};
+
+/**
+ * Generic entry point, see lcs_matrix().
+ */
+template <class T, class ITO, class A>
+void lcs(const T &a, const T &b, ITO out, A access)
+{
+    lcs_matrix(a, b, out, access);
+}
+
+/**
+ * sequences with more entries than this (product of both lengths)
+ * are compared with the linear-space algorithm when all gaps have
+ * the same cost, see Hirschberg
+ */
+static const size_t LINEAR_THRESHOLD = 256 * 256;
+
+/**
+ * Unit cost: the gap cost calculation in lcs_matrix() is not needed
+ * and large inputs are compared with Hirschberg in linear space and
+ * (roughly) 1/64 of the time.
+ */
+template <class T, class ITO>
+void lcs(const T &a, const T &b, ITO out, accessor_sequence<T> access)
+{
+    if (b.empty() || a.size() <= LINEAR_THRESHOLD / b.size()) {
+        lcs_matrix(a, b, out, access);
+        return;
+    }
+
+    typename Hirschberg< T, accessor_sequence<T> >::indexlist indices;
+    Hirschberg< T, accessor_sequence<T> > hirschberg(a, b, access);
+    hirschberg.solve(0, a.size(), 0, b.size(), indices);
+    for (typename Hirschberg< T, accessor_sequence<T> >::indexlist::iterator it = indices.begin();
+         it != indices.end();
+         it++) {
+        *out++ = Entry<typename accessor_sequence<T>::F>(it->first, it->second, access.entry_at(a, it->first - 1));
+    }
+}
+
 } // namespace lcs
 SE_END_CXX
 
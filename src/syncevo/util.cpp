@@ -49,6 +49,9 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <math.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #ifdef HAVE_GLIB
 # include <glib.h>
@@ -418,6 +421,34 @@ bool ReadFile(const string &filename, string &content)
     return ReadFile(in, content);
 }
 
+bool ReadFileMaybeCompressed(const string &filename, string &content)
+{
+    if (!boost::ends_with(filename, ".gz")) {
+        return ReadFile(filename, content);
+    }
+
+#ifdef HAVE_ZLIB
+    gzFile file = gzopen(filename.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    ostringstream out;
+    char buf[8192];
+    int len;
+    while ((len = gzread(file, buf, sizeof(buf))) > 0) {
+        out.write(buf, len);
+    }
+    if (gzclose(file) != Z_OK || len < 0) {
+        return false;
+    }
+    content = out.str();
+    return true;
+#else
+    // cannot be decompressed
+    return false;
+#endif
+}
+
 bool ReadFile(istream &in, string &content)
 {
     ostringstream out;
@@ -431,6 +462,237 @@ bool ReadFile(istream &in, string &content)
     return in.eof();
 }
 
+void WriteFileCompressed(const string &filename, const string &content, int level)
+{
+#ifdef HAVE_ZLIB
+    gzFile file = gzopen(filename.c_str(),
+                         StringPrintf("wb%d", level < 1 ? 1 : level > 9 ? 9 : level).c_str());
+    if (!file) {
+        SE_THROW(string("error creating ") + filename + ": " + strerror(errno));
+    }
+    if ((!content.empty() &&
+         gzwrite(file, content.c_str(), content.size()) != (int)content.size()) ||
+        gzclose(file) != Z_OK) {
+        SE_THROW(string("error writing ") + filename);
+    }
+#else
+    SE_THROW(string("cannot create ") + filename + ": compiled without zlib");
+#endif
+}
+
+int LogCompressionLevel()
+{
+#ifdef HAVE_ZLIB
+    const char *level = getenv("SYNCEVOLUTION_LOG_COMPRESSION");
+    if (!level || !*level) {
+        return 0;
+    }
+    int value = atoi(level);
+    return value < 0 ? 0 :
+        value > 9 ? 9 :
+        value;
+#else
+    // files could not be read again
+    return 0;
+#endif
+}
+
+#ifdef HAVE_ZLIB
+
+/**
+ * zlib window bits for the HTTP Content-Encoding,
+ * 0 if not supported
+ */
+static int HTTPWindowBits(const string &encoding)
+{
+    if (boost::iequals(encoding, "gzip") ||
+        boost::iequals(encoding, "x-gzip")) {
+        return MAX_WBITS + 16;
+    } else if (boost::iequals(encoding, "deflate")) {
+        return MAX_WBITS;
+    } else {
+        return 0;
+    }
+}
+
+string CompressHTTPBody(const char *data, size_t len, const string &encoding)
+{
+    int windowBits = HTTPWindowBits(encoding);
+    if (!windowBits) {
+        SE_THROW(string("unsupported Content-Encoding: ") + encoding);
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        SE_THROW("deflateInit2() failed");
+    }
+    string result;
+    result.resize(deflateBound(&stream, len));
+    stream.next_in = (Bytef *)data;
+    stream.avail_in = len;
+    stream.next_out = (Bytef *)&result[0];
+    stream.avail_out = result.size();
+    int res = deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (res != Z_STREAM_END) {
+        SE_THROW("compressing HTTP message failed");
+    }
+    return result;
+}
+
+bool DecompressHTTPBody(const char *data, size_t len, const string &encoding, string &result)
+{
+    int windowBits = HTTPWindowBits(encoding);
+    if (!windowBits) {
+        return false;
+    }
+
+    // second attempt for "deflate" is for raw deflate data
+    for (int attempt = 0; attempt < 2; attempt++) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, windowBits) != Z_OK) {
+            return false;
+        }
+        stream.next_in = (Bytef *)data;
+        stream.avail_in = len;
+        result.clear();
+        char buf[16 * 1024];
+        int res;
+        do {
+            stream.next_out = (Bytef *)buf;
+            stream.avail_out = sizeof(buf);
+            res = inflate(&stream, Z_NO_FLUSH);
+            result.append(buf, sizeof(buf) - stream.avail_out);
+        } while (res == Z_OK);
+        inflateEnd(&stream);
+        if (res == Z_STREAM_END) {
+            return true;
+        }
+        if (windowBits != MAX_WBITS) {
+            break;
+        }
+        windowBits = -MAX_WBITS;
+    }
+    result.clear();
+    return false;
+}
+
+#else // HAVE_ZLIB
+
+string CompressHTTPBody(const char *data, size_t len, const string &encoding)
+{
+    SE_THROW(string("unsupported Content-Encoding, compiled without zlib: ") + encoding);
+    return "";
+}
+
+bool DecompressHTTPBody(const char *data, size_t len, const string &encoding, string &result)
+{
+    return false;
+}
+
+#endif // HAVE_ZLIB
+
+#if defined(ENABLE_UNIT_TESTS) && defined(HAVE_ZLIB)
+
+class CompressionTest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(CompressionTest);
+    CPPUNIT_TEST(readWrite);
+    CPPUNIT_TEST(level);
+    CPPUNIT_TEST(http);
+    CPPUNIT_TEST_SUITE_END();
+
+    void readWrite()
+    {
+        const string dir = "CompressionTest.dir";
+        rm_r(dir);
+        mkdir_p(dir);
+        string data;
+        for (int i = 0; i < 1000; i++) {
+            data += StringPrintf("BEGIN:VCARD\nFN:John Doe %d\nEND:VCARD\n", i);
+        }
+        WriteFileCompressed(dir + "/1.gz", data, 6);
+        WriteFileCompressed(dir + "/2.gz", "", 6);
+        string content;
+        CPPUNIT_ASSERT(ReadFileMaybeCompressed(dir + "/1.gz", content));
+        CPPUNIT_ASSERT_EQUAL(data, content);
+        CPPUNIT_ASSERT(ReadFileMaybeCompressed(dir + "/2.gz", content));
+        CPPUNIT_ASSERT_EQUAL(string(""), content);
+        CPPUNIT_ASSERT(!ReadFileMaybeCompressed(dir + "/3.gz", content));
+        // plain ReadFile() returns the compressed bytes
+        CPPUNIT_ASSERT(ReadFile(dir + "/1.gz", content));
+        CPPUNIT_ASSERT(content.size() < data.size());
+        CPPUNIT_ASSERT_EQUAL(string("\x1f\x8b"), content.substr(0, 2));
+        // uncompressed files are read as they are
+        WriteFileCompressed(dir + "/4", data, 6);
+        string compressed;
+        CPPUNIT_ASSERT(ReadFile(dir + "/4", compressed));
+        CPPUNIT_ASSERT(ReadFileMaybeCompressed(dir + "/4", content));
+        CPPUNIT_ASSERT_EQUAL(compressed, content);
+        rm_r(dir);
+    }
+
+    void level()
+    {
+        {
+            ScopedEnvChange env("SYNCEVOLUTION_LOG_COMPRESSION", "");
+            CPPUNIT_ASSERT_EQUAL(0, LogCompressionLevel());
+        }
+        {
+            ScopedEnvChange env("SYNCEVOLUTION_LOG_COMPRESSION", "6");
+            CPPUNIT_ASSERT_EQUAL(6, LogCompressionLevel());
+        }
+        {
+            ScopedEnvChange env("SYNCEVOLUTION_LOG_COMPRESSION", "100");
+            CPPUNIT_ASSERT_EQUAL(9, LogCompressionLevel());
+        }
+    }
+
+    void http()
+    {
+        string data;
+        for (int i = 0; i < 1000; i++) {
+            data += StringPrintf("<Item><Data>BEGIN:VCARD\nFN:John Doe %d\nEND:VCARD\n</Data></Item>", i);
+        }
+        string content;
+        static const char * const encodings[] = { "gzip", "deflate", "x-gzip" };
+        BOOST_FOREACH(const char *encoding, encodings) {
+            string compressed = CompressHTTPBody(data.c_str(), data.size(), encoding);
+            CPPUNIT_ASSERT(compressed.size() < data.size() / 5);
+            CPPUNIT_ASSERT(DecompressHTTPBody(compressed.c_str(), compressed.size(), encoding, content));
+            CPPUNIT_ASSERT_EQUAL(data, content);
+        }
+
+        // raw deflate instead of zlib format
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        CPPUNIT_ASSERT_EQUAL(Z_OK, deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY));
+        string raw;
+        raw.resize(deflateBound(&stream, data.size()));
+        stream.next_in = (Bytef *)data.c_str();
+        stream.avail_in = data.size();
+        stream.next_out = (Bytef *)&raw[0];
+        stream.avail_out = raw.size();
+        CPPUNIT_ASSERT_EQUAL(Z_STREAM_END, deflate(&stream, Z_FINISH));
+        raw.resize(stream.total_out);
+        deflateEnd(&stream);
+        CPPUNIT_ASSERT(DecompressHTTPBody(raw.c_str(), raw.size(), "deflate", content));
+        CPPUNIT_ASSERT_EQUAL(data, content);
+        CPPUNIT_ASSERT(!DecompressHTTPBody(raw.c_str(), raw.size(), "gzip", content));
+
+        CPPUNIT_ASSERT(!DecompressHTTPBody(data.c_str(), data.size(), "gzip", content));
+        CPPUNIT_ASSERT(!DecompressHTTPBody(data.c_str(), data.size(), "compress", content));
+        CPPUNIT_ASSERT_THROW(CompressHTTPBody(data.c_str(), data.size(), "compress"), Exception);
+    }
+};
+
+SYNCEVOLUTION_TEST_SUITE_REGISTRATION(CompressionTest);
+
+#endif // ENABLE_UNIT_TESTS && HAVE_ZLIB
+
 unsigned long Hash(const char *str)
 {
     unsigned long hashval = 5381;
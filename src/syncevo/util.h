@@ -136,6 +136,47 @@ bool isDir(const std::string &path);
 bool ReadFile(const std::string &filename, std::string &content);
 bool ReadFile(std::istream &in, std::string &content);
 
+/**
+ * same as ReadFile(), except that files whose name ends in .gz
+ * (as written by WriteFileCompressed()) are decompressed; without
+ * zlib (HAVE_ZLIB) such files cannot be read
+ */
+bool ReadFileMaybeCompressed(const std::string &filename, std::string &content);
+
+/**
+ * create file with gzip compressed content, throw exception if fails
+ * or if compiled without zlib
+ *
+ * @param filename     file name, should end in .gz
+ * @param content      uncompressed data
+ * @param level        zlib compression level, 1 (fastest) till 9 (best)
+ */
+void WriteFileCompressed(const std::string &filename, const std::string &content, int level);
+
+/**
+ * Compression level for log files and database dumps in session
+ * directories, from SYNCEVOLUTION_LOG_COMPRESSION. 0 (the default)
+ * disables compression. Always 0 without zlib.
+ */
+int LogCompressionLevel();
+
+/**
+ * Compress a message body for HTTP. Supported Content-Encodings are
+ * "gzip" and "deflate" (zlib format). Throws an exception for
+ * anything else and when compiled without zlib.
+ */
+std::string CompressHTTPBody(const char *data, size_t len, const std::string &encoding);
+
+/**
+ * Reverse of CompressHTTPBody(). For "deflate", raw deflate data
+ * without zlib header is also accepted because some servers send
+ * that.
+ *
+ * @retval result     uncompressed data
+ * @return false if encoding unknown, data invalid or compiled without zlib
+ */
+bool DecompressHTTPBody(const char *data, size_t len, const std::string &encoding, std::string &result);
+
 enum ExecuteFlags {
     EXECUTE_NO_STDERR = 1<<0,       /**< suppress stderr of command */
     EXECUTE_NO_STDOUT = 1<<1        /**< suppress stdout of command */
@@ -37,6 +37,7 @@
 #include <Logging.h>
 #include <syncevo/util.h>
 #include <syncevo/SyncContext.h>
+#include <syncevo/Timespec.h>
 #include <VolatileConfigNode.h>
 
 #include <synthesis/dataconversion.h>
@@ -58,6 +59,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/resource.h>
 
 #include <boost/bind.hpp>
 #include <boost/tokenizer.hpp>
@@ -5993,6 +5995,255 @@ void SyncTests::allSourcesRemoveMany(int numItems,
 }
 
 
+PerformanceTests::PerformanceTests(const std::string &name, ClientTest &cl, std::vector<int> sourceIndices) :
+    SyncTests(name, cl, sourceIndices)
+{
+    const char *sizes = getenv("CLIENT_TEST_PERFORMANCE");
+    std::string sizesStr = sizes ? sizes : "";
+    BOOST_FOREACH(const std::string &size,
+                  boost::tokenizer< boost::char_separator<char> >(sizesStr,
+                                                                  boost::char_separator<char>(", "))) {
+        int value = atoi(size.c_str());
+        if (value > 0) {
+            m_sizes.push_back(value);
+        }
+    }
+}
+
+void PerformanceTests::addTests(bool isFirstSource)
+{
+    if (sources.size() && !m_sizes.empty()) {
+        const ClientTest::Config &config(sources[0].second->config);
+        if (config.m_createSourceA && !config.m_templateItem.empty()) {
+            ADD_TEST(PerformanceTests, testLocalOperations);
+            ADD_TEST(PerformanceTests, testSyncs);
+        }
+    }
+}
+
+PerformanceTests::Measure::Measure() :
+    m_start(Timespec::monotonic().duration()),
+    m_cpuStart(cpuTime())
+{
+}
+
+void PerformanceTests::Measure::done(double &seconds, double &cpuSeconds) const
+{
+    seconds = Timespec::monotonic().duration() - m_start;
+    cpuSeconds = cpuTime() - m_cpuStart;
+}
+
+double PerformanceTests::Measure::cpuTime()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+        usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+void PerformanceTests::record(const Measure &measure,
+                              const std::string &source,
+                              const std::string &operation,
+                              int items)
+{
+    Result result;
+    measure.done(result.m_seconds, result.m_cpuSeconds);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.m_peakRSSKB = usage.ru_maxrss;
+    result.m_source = source;
+    result.m_operation = operation;
+    result.m_items = items;
+    m_results.push_back(result);
+    CLIENT_TEST_LOG("%s %s: %d items in %.3fs, %.3fs CPU",
+                    source.c_str(), operation.c_str(), items,
+                    result.m_seconds, result.m_cpuSeconds);
+}
+
+/** string as JSON string literal */
+static std::string jsonString(const std::string &str)
+{
+    std::string res = "\"";
+    BOOST_FOREACH(char c, str) {
+        switch (c) {
+        case '"':
+            res += "\\\"";
+            break;
+        case '\\':
+            res += "\\\\";
+            break;
+        default:
+            if ((unsigned char)c < 0x20) {
+                res += StringPrintf("\\u%04x", (unsigned char)c);
+            } else {
+                res += c;
+            }
+            break;
+        }
+    }
+    res += "\"";
+    return res;
+}
+
+void PerformanceTests::writeResults()
+{
+    std::string filename = getCurrentTest() + ".perf.json";
+    simplifyFilename(filename);
+    std::ofstream out(filename.c_str());
+    out << "{\n"
+        << "  \"test\": " << jsonString(getCurrentTest()) << ",\n"
+        << "  \"server\": " << jsonString(currentServer()) << ",\n"
+        << "  \"results\": [";
+    bool first = true;
+    BOOST_FOREACH(const Result &result, m_results) {
+        out << (first ? "\n" : ",\n")
+            << "    { \"source\": " << jsonString(result.m_source)
+            << ", \"operation\": " << jsonString(result.m_operation)
+            << ", \"items\": " << result.m_items
+            << StringPrintf(", \"seconds\": %.6f, \"itemsPerSecond\": %.3f, \"cpuSeconds\": %.6f",
+                            result.m_seconds,
+                            result.m_seconds > 0 ? result.m_items / result.m_seconds : 0.0,
+                            result.m_cpuSeconds)
+            << ", \"peakRSSKB\": " << result.m_peakRSSKB
+            << " }";
+        first = false;
+    }
+    out << "\n  ]\n}\n";
+    out.close();
+    CT_ASSERT(!out.fail());
+    m_results.clear();
+}
+
+void PerformanceTests::testLocalOperations()
+{
+    BOOST_FOREACH(source_array_t::value_type &source_pair, sources) {
+        LocalTests &local = *source_pair.second;
+        const ClientTest::Config &config = local.config;
+        const std::string &name = local.getSourceName();
+
+        BOOST_FOREACH(int numItems, m_sizes) {
+            CT_ASSERT_NO_THROW(local.deleteAll(local.createSourceA));
+            std::list<std::string> luids;
+            TestingSyncSourcePtr source;
+
+            // generating items from the template is included,
+            // but negligible compared to storing them
+            SOURCE_ASSERT_NO_FAILURE(source.get(), source.reset(local.createSourceA()));
+            {
+                Measure measure;
+                for (int item = 1; item <= numItems; item++) {
+                    std::string data = local.createItem(item, "", 0);
+                    luids.push_back(importItem(source.get(), config, data));
+                }
+                CT_ASSERT_NO_THROW(source.reset());
+                record(measure, name, "insert", numItems);
+            }
+
+            // open with change tracking
+            {
+                Measure measure;
+                SOURCE_ASSERT_NO_FAILURE(source.get(), source.reset(local.createSourceA()));
+                record(measure, name, "open", numItems);
+            }
+            CT_ASSERT_NO_THROW(source.reset());
+
+            // open without previous state, must list all items
+            {
+                Measure measure;
+                SOURCE_ASSERT_NO_FAILURE(source.get(), source.reset(local.createSourceA(), TestingSyncSourcePtr::SLOW));
+                SOURCE_ASSERT_EQUAL(source.get(), numItems, countItems(source.get()));
+                record(measure, name, "listAll", numItems);
+            }
+
+            {
+                Measure measure;
+                BOOST_FOREACH(const std::string &luid, luids) {
+                    std::string item;
+                    SOURCE_ASSERT_NO_FAILURE(source.get(), source->readItemRaw(luid, item));
+                }
+                record(measure, name, "readItem", numItems);
+            }
+
+            {
+                Measure measure;
+                int item = 1;
+                BOOST_FOREACH(const std::string &luid, luids) {
+                    std::string data = local.createItem(item++, "REVISION #2", 0);
+                    updateItem(source.get(), data, luid);
+                }
+                CT_ASSERT_NO_THROW(source.reset());
+                record(measure, name, "update", numItems);
+            }
+
+            SOURCE_ASSERT_NO_FAILURE(source.get(), source.reset(local.createSourceA()));
+            {
+                Measure measure;
+                BOOST_FOREACH(const std::string &luid, luids) {
+                    removeItem(source.get(), luid);
+                }
+                CT_ASSERT_NO_THROW(source.reset());
+                record(measure, name, "delete", numItems);
+            }
+        }
+    }
+    writeResults();
+}
+
+void PerformanceTests::testSyncs()
+{
+    std::string name;
+    BOOST_FOREACH(source_array_t::value_type &source_pair, sources) {
+        if (!name.empty()) {
+            name += "_";
+        }
+        name += source_pair.second->getSourceName();
+    }
+
+    BOOST_FOREACH(int numItems, m_sizes) {
+        CT_ASSERT_NO_THROW(deleteAll());
+        BOOST_FOREACH(source_array_t::value_type &source_pair, sources) {
+            CT_ASSERT_NO_THROW(source_pair.second->insertManyItems(source_pair.second->createSourceA, 1, numItems, 0));
+        }
+        int total = numItems * (int)sources.size();
+
+        {
+            Measure measure;
+            doSync(__FILE__, __LINE__,
+                   "send",
+                   SyncOptions(SYNC_TWO_WAY,
+                               CheckSyncReport(0,0,0, numItems,0,0, true, SYNC_TWO_WAY),
+                               SyncOptions::DEFAULT_MAX_MSG_SIZE,
+                               SyncOptions::DEFAULT_MAX_OBJ_SIZE,
+                               true));
+            record(measure, name, "twoWay", total);
+        }
+        {
+            Measure measure;
+            doSync(__FILE__, __LINE__,
+                   "slow",
+                   SyncOptions(SYNC_SLOW,
+                               CheckSyncReport(-1,-1,-1, -1,-1,-1, true, SYNC_SLOW),
+                               SyncOptions::DEFAULT_MAX_MSG_SIZE,
+                               SyncOptions::DEFAULT_MAX_OBJ_SIZE,
+                               true));
+            record(measure, name, "slow", total);
+        }
+        {
+            Measure measure;
+            doSync(__FILE__, __LINE__,
+                   "refresh",
+                   SyncOptions(RefreshFromPeerMode(),
+                               CheckSyncReport(-1,-1,-1, -1,-1,-1, true, SYNC_REFRESH_FROM_REMOTE),
+                               SyncOptions::DEFAULT_MAX_MSG_SIZE,
+                               SyncOptions::DEFAULT_MAX_OBJ_SIZE,
+                               true));
+            record(measure, name, "refreshFromPeer", total);
+        }
+    }
+    CT_ASSERT_NO_THROW(deleteAll());
+    writeResults();
+}
+
 /** generates tests on demand based on what the client supports */
 class ClientTestFactory : public CppUnit::TestFactory {
 public:
@@ -6088,6 +6339,26 @@ public:
         alltests->addTest(FilterTest(tests));
         tests = 0;
 
+        // performance tests take a long time, only added
+        // when explicitly asked for
+        if (getenv("CLIENT_TEST_PERFORMANCE")) {
+            tests = new CppUnit::TestSuite(alltests->getName() + "::Performance");
+            for (source=0; source < client.getNumSyncSources(); source++) {
+                ClientTest::Config config;
+                client.getSyncSourceConfig(source, config);
+                if (!config.m_sourceName.empty()) {
+                    std::vector<int> sources;
+                    sources.push_back(source);
+                    PerformanceTests *perftests =
+                        client.createPerformanceTests(tests->getName() + "::" + config.m_sourceName, sources);
+                    perftests->addTests();
+                    tests->addTest(FilterTest(perftests));
+                }
+            }
+            alltests->addTest(FilterTest(tests));
+            tests = 0;
+        }
+
         return alltests;
     }
 
@@ -6139,6 +6410,11 @@ SyncTests *ClientTest::createSyncTests(const std::string &name, std::vector<int>
     return new SyncTests(name, *this, sourceIndices, isClientA);
 }
 
+PerformanceTests *ClientTest::createPerformanceTests(const std::string &name, std::vector<int> sourceIndices)
+{
+    return new PerformanceTests(name, *this, sourceIndices);
+}
+
 int ClientTest::dump(ClientTest &client, TestingSyncSource &source, const std::string &file)
 {
     BackupReport report;
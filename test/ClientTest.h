@@ -202,6 +202,7 @@ struct SyncOptions {
 
 class LocalTests;
 class SyncTests;
+class PerformanceTests;
 
 /**
  * This is the interface expected by the testing framework for sync
@@ -295,6 +296,13 @@ class ClientTest {
      */
     virtual SyncTests *createSyncTests(const std::string &name, std::vector<int> sourceIndices, bool isClientA = true);
 
+    /**
+     * Creates an instance of PerformanceTests (default) or a class
+     * derived from it. Only called when CLIENT_TEST_PERFORMANCE is
+     * set.
+     */
+    virtual PerformanceTests *createPerformanceTests(const std::string &name, std::vector<int> sourceIndices);
+
     /**
      * utility function for dumping items which are C strings with blank lines as separator
      */
@@ -916,6 +924,76 @@ protected:
                               int offset);
 };
 
+/**
+ * Measures how long local operations and syncs take with many items.
+ * Enabled by setting CLIENT_TEST_PERFORMANCE to a comma-separated list
+ * of item counts, for example "1000,10000,100000". The items are
+ * generated from ClientTestConfig::m_templateItem, like in
+ * testManyItems.
+ *
+ * Each test writes its results as JSON into <test name>.perf.json in
+ * the current directory: one record per operation and item count,
+ * with wall clock time, items per second, CPU time and peak RSS of
+ * the client-test process. CPU time and RSS of other processes
+ * (server, EDS) are not included. test/runtests.py collects these
+ * files and compares them against the previous run.
+ */
+class PerformanceTests : public SyncTests {
+public:
+    PerformanceTests(const std::string &name, ClientTest &cl, std::vector<int> sourceIndices);
+
+    virtual void addTests(bool isFirstSource = false);
+
+protected:
+    /** item counts from CLIENT_TEST_PERFORMANCE */
+    std::vector<int> m_sizes;
+
+    /** one measurement, see record() */
+    struct Result {
+        std::string m_source;
+        std::string m_operation;
+        int m_items;
+        double m_seconds;
+        double m_cpuSeconds;
+        long m_peakRSSKB;
+    };
+    std::vector<Result> m_results;
+
+    /** takes time stamps for a Result */
+    class Measure {
+    public:
+        Measure();
+        /** elapsed wall clock time and CPU time since construction */
+        void done(double &seconds, double &cpuSeconds) const;
+
+    private:
+        double m_start;
+        double m_cpuStart;
+        static double cpuTime();
+    };
+
+    /** add result of an operation that was started when measure was created */
+    void record(const Measure &measure,
+                const std::string &source,
+                const std::string &operation,
+                int items);
+
+    /** write m_results into <test name>.perf.json, then clear it */
+    void writeResults();
+
+    /**
+     * Per source: insert, re-open (incremental and slow),
+     * read, update and delete all items.
+     */
+    virtual void testLocalOperations();
+
+    /**
+     * All sources: send items to the peer with a two-way sync, then
+     * run a slow sync and a refresh from the peer.
+     */
+    virtual void testSyncs();
+};
+
 /*
  * A transport wraper wraps a real transport impl and gives user 
  * possibility to do additional work before/after transport operation.
@@ -19,6 +19,7 @@ import shlex
 import subprocess
 import fnmatch
 import copy
+import json
 
 try:
     import gzip
@@ -118,6 +119,52 @@ def ShutdownSubprocess(popen, timeout):
         return False
     return True
 
+def comparePerformance(resultdir, lastresultdir, summary, threshold=0.1):
+    """Merges the *.perf.json files written by Client::Performance
+    tests into performance.json in the result dir. Results are
+    identified by action (without step number), test, source, operation
+    and number of items. If the previous run also has a performance.json,
+    then a comparison is written into performance.txt and operations
+    which became slower than the threshold (10% by default) are
+    added to the summary."""
+    results = {}
+    for dirpath, dirnames, filenames in os.walk(resultdir):
+        for filename in fnmatch.filter(filenames, '*.perf.json'):
+            action = re.sub(r'^\d+-', '', os.path.basename(dirpath))
+            try:
+                data = json.load(open(os.path.join(dirpath, filename)))
+            except Exception, ex:
+                summary.append("%s/%s: invalid performance results: %s" % (dirpath, filename, ex))
+                continue
+            for result in data["results"]:
+                key = "%s %s %s %s %d" % (action, data["test"], result["source"], result["operation"], result["items"])
+                results[key] = result
+    if not results:
+        return
+    json.dump(results, open(os.path.join(resultdir, "performance.json"), "w"),
+              indent=2, sort_keys=True)
+
+    previousfile = os.path.join(lastresultdir, "performance.json")
+    if not lastresultdir or not os.path.exists(previousfile):
+        return
+    previous = json.load(open(previousfile))
+    out = open(os.path.join(resultdir, "performance.txt"), "w")
+    slower = 0
+    for key in sorted(results.keys()):
+        current = results[key]["itemsPerSecond"]
+        if key in previous and previous[key]["itemsPerSecond"] > 0:
+            last = previous[key]["itemsPerSecond"]
+            change = (current - last) / last
+            out.write("%s: %.1f -> %.1f items/s (%+.1f%%)\n" % (key, last, current, change * 100))
+            if change < -threshold:
+                slower = slower + 1
+        else:
+            out.write("%s: %.1f items/s (new)\n" % (key, current))
+    out.close()
+    if slower:
+        summary.append("performance: %d operations more than %d%% slower than in previous run, see performance.txt" %
+                       (slower, threshold * 100))
+
 class Action:
     """Base class for all actions to be performed."""
 
@@ -319,6 +366,9 @@ class Context:
                 traceback.print_exc()
                 self.summary.append("%s failed: %s" % (action.name, inst))
 
+        # merge performance measurements, compare against previous run
+        comparePerformance(self.resultdir, self.lastresultdir, self.summary)
+
         # append all parameters to summary
         self.summary.append("")
         self.summary.extend(sys.argv)
@@ -675,7 +725,7 @@ class SyncEvolutionTest(Action):
             else:
                 context.runCommand(basecmd)
         finally:
-            tocopy = re.compile(r'.*\.log|.*\.client.[AB]|.*\.(cpp|h|c)\.html|.*\.log\.html')
+            tocopy = re.compile(r'.*\.log|.*\.client.[AB]|.*\.(cpp|h|c)\.html|.*\.log\.html|.*\.perf\.json')
             toconvert = re.compile(r'Client_.*\.log')
             htaccess = file(os.path.join(resdir, ".htaccess"), "a")
             for f in os.listdir(self.srcdir):
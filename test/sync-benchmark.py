@@ -0,0 +1,260 @@
+#!/usr/bin/python
+#
+# Copyright (C) 2012 Intel Corporation
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) version 3.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+# 02110-1301  USA
+
+'''
+Measures the whole sync stack (backend, engine, SyncML encoding,
+transport) without external servers: two contexts with file
+backends are populated with generated contacts and events and
+synchronized via local sync in different modes. For each sync, the
+wall clock time, the per-phase timing of both sides and the number
+and size of the messages sent by each side (see
+SYNCEVOLUTION_SYNC_TIMING in README.rst) are printed, followed by
+the number of item and field objects created by the sync engine and
+how many of them needed a heap allocation (from the session logs).
+
+All configuration and data is kept in a temporary directory,
+the normal SyncEvolution configuration is not touched.
+'''
+
+import sys, optparse, os, time, tempfile
+import shutil
+import subprocess
+import re
+
+parser = optparse.OptionParser()
+parser.add_option("-n", "--items", action = "store", type = "int",
+                  dest = "items", default = 1000,
+                  help = "number of contacts and of events, default %default")
+parser.add_option("-c", "--changes", action = "store", type = "float",
+                  dest = "changes", default = 0.1,
+                  help = "fraction of items modified before the incremental sync, default %default")
+parser.add_option("-m", "--msgsize", action = "store", type = "int",
+                  dest = "msgsize", default = 0,
+                  help = "maxMsgSize for both sides; large values put thousands of commands and statuses into one message, default is the normal maxMsgSize")
+parser.add_option("-i", "--items-per-command", action = "store", type = "int",
+                  dest = "itemspercommand", default = 0,
+                  help = "maximum number of items per Add/Replace/Delete command (SYNCEVOLUTION_MAX_ITEMS_PER_COMMAND), default is the normal value for local sync")
+parser.add_option("-p", "--no-prefetch", action = "store_true",
+                  dest = "noprefetch", default = False,
+                  help = "do not list items in the background while the first messages are exchanged (SYNCEVOLUTION_PREFETCH=0)")
+parser.add_option("-s", "--syncevolution", action = "store", type = "string",
+                  dest = "syncevolution", default = "syncevolution",
+                  help = "command line tool to use, default %default")
+parser.add_option("-d", "--workdir", action = "store", type = "string",
+                  dest = "workdir", default = "",
+                  help = "directory for configs and data, default is a new temporary directory")
+parser.add_option("-k", "--keep", action = "store_true",
+                  dest = "keep", default = False,
+                  help = "do not remove the working directory at the end")
+parser.add_option("-v", "--verbose", action = "store_true",
+                  dest = "verbose", default = False,
+                  help = "show output of syncevolution")
+(options, args) = parser.parse_args()
+
+# item generators: (number, revision) -> item text
+def contact(i, revision):
+    return '''BEGIN:VCARD
+VERSION:3.0
+UID:sync-benchmark-contact-%(i)d
+FN:John Doe %(i)d
+N:Doe %(i)d;John;;;
+EMAIL;TYPE=INTERNET:john.doe.%(i)d@example.com
+TEL;TYPE=WORK:+1-555-%(i)07d
+ADR;TYPE=WORK:;;Main Street %(i)d;Some City;;12345;Some Country
+NOTE:benchmark contact %(i)d revision %(revision)d
+END:VCARD
+''' % { 'i': i, 'revision': revision }
+
+def event(i, revision):
+    day = i % 28 + 1
+    month = i // 28 % 12 + 1
+    return '''BEGIN:VCALENDAR
+VERSION:2.0
+PRODID:-//SyncEvolution//sync-benchmark//EN
+BEGIN:VEVENT
+UID:sync-benchmark-event-%(i)d
+DTSTAMP:20120101T000000Z
+LAST-MODIFIED:20120101T000000Z
+DTSTART:2012%(month)02d%(day)02dT100000Z
+DTEND:2012%(month)02d%(day)02dT110000Z
+SUMMARY:benchmark event %(i)d
+LOCATION:room %(i)d
+DESCRIPTION:revision %(revision)d
+END:VEVENT
+END:VCALENDAR
+''' % { 'i': i, 'revision': revision, 'day': day, 'month': month }
+
+# (source name, data format, item generator)
+sources = [ ('addressbook', 'text/vcard', contact),
+            ('calendar', 'text/calendar', event) ]
+
+# same order as SyncTiming::Phase
+phases = [ 'engine', 'transport', 'changes', 'items', 'maps', 'backup', 'other' ]
+
+if options.workdir:
+    workdir = os.path.abspath(options.workdir)
+    if not os.path.isdir(workdir):
+        os.makedirs(workdir)
+else:
+    workdir = tempfile.mkdtemp(prefix='sync-benchmark-')
+timingfile = os.path.join(workdir, 'timing.txt')
+
+env = os.environ.copy()
+env['XDG_CONFIG_HOME'] = os.path.join(workdir, 'config')
+env['XDG_DATA_HOME'] = os.path.join(workdir, 'data')
+env['XDG_CACHE_HOME'] = os.path.join(workdir, 'cache')
+env['SYNCEVOLUTION_SYNC_TIMING'] = timingfile
+if options.itemspercommand:
+    env['SYNCEVOLUTION_MAX_ITEMS_PER_COMMAND'] = str(options.itemspercommand)
+if options.noprefetch:
+    env['SYNCEVOLUTION_PREFETCH'] = '0'
+
+def run(cmdargs):
+    '''run syncevolution, fail if it fails'''
+    cmd = [options.syncevolution] + cmdargs
+    if options.verbose:
+        print(' '.join(cmd))
+        out = None
+    else:
+        out = open(os.devnull, 'w')
+    res = subprocess.call(cmd, env=env, stdout=out, stderr=out)
+    if res:
+        sys.exit('%s failed with return code %d' % (' '.join(cmd), res))
+
+def database(side, source):
+    return os.path.join(workdir, side, source)
+
+def writeItems(side, source, generator, items, revision):
+    '''create or overwrite items 1 to n (file names = IDs)'''
+    dir = database(side, source)
+    if not os.path.isdir(dir):
+        os.makedirs(dir)
+    for i in items:
+        f = open(os.path.join(dir, str(i)), 'w')
+        f.write(generator(i, revision))
+        f.close()
+
+def configure():
+    syncprops = []
+    if options.msgsize:
+        syncprops.append('maxMsgSize=%d' % options.msgsize)
+    # target side, accessed via local://@bench-server
+    for source, format, generator in sources:
+        run(['--configure', '--template', 'none'] + syncprops + [
+             'backend=file',
+             'database=file://' + database('server', source),
+             'databaseFormat=' + format,
+             'preventSlowSync=0',
+             'target-config@bench-server', source])
+    # side which starts the sync
+    run(['--configure', '--template', 'SyncEvolution_Client'] + syncprops + [
+         'syncURL=local://@bench-server',
+         'username=', 'password=',
+         'preventSlowSync=0',
+         'bench@bench-client'] + [source for source, format, generator in sources])
+    for source, format, generator in sources:
+        run(['--configure',
+             'backend=file',
+             'database=file://' + database('client', source),
+             'databaseFormat=' + format,
+             'uri=' + source,
+             'bench@bench-client', source])
+
+objectstats = re.compile(r'Item/field object statistics: (\d+) allocated, (\d+) of them reused')
+
+def objects(since):
+    '''sum up (allocated, heap allocated) item/field objects of all session logs written since the given time'''
+    allocated = 0
+    heap = 0
+    for dirpath, dirnames, filenames in os.walk(env['XDG_CACHE_HOME']):
+        for filename in filenames:
+            log = os.path.join(dirpath, filename)
+            if filename == 'syncevolution-log.html' and \
+                    os.path.getmtime(log) >= since:
+                for match in objectstats.finditer(open(log).read()):
+                    allocated += int(match.group(1))
+                    heap += int(match.group(1)) - int(match.group(2))
+    return (allocated, heap)
+
+def sync(name, mode):
+    '''run one sync, return (name, seconds, timing per side, objects)'''
+    if os.path.exists(timingfile):
+        os.unlink(timingfile)
+    start = time.time()
+    run(['--sync', mode, 'bench@bench-client'])
+    duration = time.time() - start
+    timing = {}
+    for line in open(timingfile):
+        # <client|server> <config> <phase>=<seconds>s/<count> ... other=<seconds>s total=<seconds>s messages=<count> bytes=<count> overlapped=<seconds>s
+        words = line.split()
+        side = words[0]
+        values = {}
+        for word in words[2:]:
+            key, value = word.split('=', 1)
+            values[key] = float(value.split('s', 1)[0])
+        timing[side] = values
+    return (name, duration, timing, objects(start))
+
+results = []
+try:
+    configure()
+    items = range(1, options.items + 1)
+    for source, format, generator in sources:
+        writeItems('client', source, generator, items, 0)
+        writeItems('server', source, generator, [], 0)
+
+    # initial sync: copies everything to the server side
+    results.append(sync('slow', 'slow'))
+    # nothing changed: only change detection
+    results.append(sync('two-way (unchanged)', 'two-way'))
+    # file backend uses the modification time in seconds as revision
+    time.sleep(1.1)
+    modified = items[:int(options.items * options.changes)]
+    for source, format, generator in sources:
+        writeItems('client', source, generator, modified, 1)
+    results.append(sync('two-way (%d modified)' % len(modified), 'two-way'))
+    results.append(sync('refresh-from-remote', 'refresh-from-remote'))
+    results.append(sync('refresh-from-local', 'refresh-from-local'))
+finally:
+    if not options.keep:
+        shutil.rmtree(workdir, True)
+    else:
+        print('data kept in %s' % workdir)
+
+total = options.items * len(sources)
+print('%d items (%s), times in seconds' %
+      (total, ', '.join([source for source, format, generator in sources])))
+print('%-24s %8s %10s %-6s ' % ('sync', 'wall', 'items/s', 'side') +
+      ' '.join(['%9s' % phase for phase in phases]) +
+      ' %8s %10s %10s' % ('messages', 'bytes', 'overlapped'))
+for name, duration, timing, allocations in results:
+    first = True
+    for side in sorted(timing.keys()):
+        if first:
+            line = '%-24s %8.2f %10.1f ' % (name, duration, total / duration)
+            first = False
+        else:
+            line = '%-24s %8s %10s ' % ('', '', '')
+        line += '%-6s ' % side
+        line += ' '.join(['%9.3f' % timing[side].get(phase, 0) for phase in phases])
+        line += ' %8d %10d %10.3f' % (timing[side].get('messages', 0), timing[side].get('bytes', 0),
+                                      timing[side].get('overlapped', 0))
+        print(line)
+    if allocations[0]:
+        print('%-24s %d item/field objects, %d heap allocations' % ('', allocations[0], allocations[1]))
@@ -729,6 +729,18 @@ sub NormalizeItem {
     return ${$formatted[0]}[0];
 }
 
+# parameters: file name
+# opens IN for reading the file, decompresses .gz files
+# (see SYNCEVOLUTION_LOG_COMPRESSION)
+sub OpenItem {
+    my $fullname = shift;
+    if ($fullname =~ /\.gz$/) {
+        open(IN, "-|:utf8", "gzip", "-dc", $fullname) || die "$fullname: $!";
+    } else {
+        open(IN, "<:utf8", "$fullname") || die "$fullname: $!";
+    }
+}
+
 # parameters: text, width to use for reformatted lines
 # returns list of lines without line breaks
 sub Normalize {
@@ -815,7 +827,7 @@ if($#ARGV > 1) {
               # randomly match against the last file
               pop @{$files1{$inode}};
           } else {
-              open(IN, "<:utf8", "$fullname") || die "$fullname: $!";
+              OpenItem($fullname);
               push @content2, <IN>;
           }
       }
@@ -823,7 +835,7 @@ if($#ARGV > 1) {
       foreach my $array (values %files1) {
           foreach $entry (@{$array}) {
               $fullname = "$file1/$entry";
-              open(IN, "<:utf8", "$fullname") || die "$fullname: $!";
+              OpenItem($fullname);
               push @content1, <IN>;
           }
       }
@@ -833,12 +845,12 @@ if($#ARGV > 1) {
       @normal2 = Normalize($content2, $singlewidth);
   } else {
       if (-d $file1) {
-          open(IN1, "-|:utf8", "find $file1 -type f -print0 | xargs -0 cat") || die "$file1: $!";
+          open(IN1, "-|:utf8", "find $file1 -type f -print0 | xargs -0 gzip -dcf") || die "$file1: $!";
       } else {
           open(IN1, "<:utf8", $file1) || die "$file1: $!";
       }
       if (-d $file2) {
-          open(IN2, "-|:utf8", "find $file2 -type f -print0 | xargs -0 cat") || die "$file2: $!";
+          open(IN2, "-|:utf8", "find $file2 -type f -print0 | xargs -0 gzip -dcf") || die "$file2: $!";
       } else {
           open(IN2, "<:utf8", $file2) || die "$file2: $!";
       }
@@ -981,7 +993,7 @@ if($#ARGV > 1) {
   if( $#ARGV >= 0 ) {
     my $file1 = $ARGV[0];
     if (-d $file1) {
-        open(IN, "-|:utf8", "find $file1 -type f -print0 | xargs -0 cat") || die "$file1: $!";
+        open(IN, "-|:utf8", "find $file1 -type f -print0 | xargs -0 gzip -dcf") || die "$file1: $!";
     } else {
         open(IN, "<:utf8", $file1) || die "$file1: $!";
     }
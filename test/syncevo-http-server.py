@@ -21,6 +21,7 @@ import time
 import subprocess
 import logging
 import logging.config
+import zlib
 
 import twisted.web
 import twisted.python.log
@@ -172,11 +173,7 @@ class SyncMLSession:
             OldRequest.reply = data
             OldRequest.type = type
             if request:
-                request.setHeader('Content-Type', type)
-                request.setHeader('Content-Length', len(data))
-                request.setResponseCode(http.OK)
-                request.write(data)
-                request.finish()
+                writeReply(request, data, type)
                 self.sessionid = session
             else:
                 # syncevo-dbus-server does not need to know about lost connection
@@ -196,9 +193,8 @@ class SyncMLSession:
         # retry the request
         self.request = None
 
-    def start(self, request, config, url):
+    def start(self, request, config, url, data):
         '''start a new session based on the incoming message'''
-        data = request.content.read()
         type = request.getHeader('content-type')
         self.logMessage("incoming", request, data, type)
         logger.debug("requesting new session")
@@ -269,6 +265,41 @@ class SyncMLSession:
         else:
             logger.debug("processing %s message of type %s and length %d, binary data" % (direction, type, len(data)))
 
+def decodeRequest(request):
+    '''body of the request, None if its Content-Encoding is not supported'''
+    data = request.content.read()
+    encoding = request.getHeader('content-encoding')
+    if encoding:
+        encoding = encoding.strip().lower()
+    try:
+        if encoding in ('gzip', 'x-gzip'):
+            data = zlib.decompress(data, 16 + zlib.MAX_WBITS)
+        elif encoding == 'deflate':
+            try:
+                data = zlib.decompress(data)
+            except zlib.error:
+                # some clients send raw deflate data without zlib header
+                data = zlib.decompress(data, -zlib.MAX_WBITS)
+        elif encoding and encoding != 'identity':
+            return None
+    except zlib.error as ex:
+        logger.error("decoding %s request failed: %s", encoding, ex)
+        return None
+    return data
+
+def writeReply(request, data, type):
+    '''send reply, gzip-compressed if the client accepts that'''
+    accept = request.getHeader('accept-encoding')
+    if accept and 'gzip' in [e.split(';')[0].strip().lower() for e in accept.split(',')]:
+        compressor = zlib.compressobj(zlib.Z_DEFAULT_COMPRESSION, zlib.DEFLATED, 16 + zlib.MAX_WBITS)
+        data = compressor.compress(data) + compressor.flush()
+        request.setHeader('Content-Encoding', 'gzip')
+    request.setHeader('Content-Type', type)
+    request.setHeader('Content-Length', len(data))
+    request.setResponseCode(http.OK)
+    request.write(data)
+    request.finish()
+
 class SyncMLPost(resource.Resource):
     isLeaf = True
 
@@ -292,14 +323,21 @@ class SyncMLPost(resource.Resource):
             sessionid = sessionid[0]
         logger.debug("POST from %s config %s type %s session %s args %s length %s",
                      request.getClientIP(), config, type, sessionid, request.args, len)
+        data = decodeRequest(request)
+        if data is None:
+            # tells the client to retry without compression
+            logger.error("unsupported Content-Encoding %s => 415 error",
+                         request.getHeader('content-encoding'))
+            request.setResponseCode(http.UNSUPPORTED_MEDIA_TYPE)
+            return ""
         if not sessionid:
             logger.info("new SyncML session for %s", request.getClientIP())
             session = SyncMLSession()
             session.start(request, config,
-                          urlparse.urljoin(self.url.geturl(), request.path))
+                          urlparse.urljoin(self.url.geturl(), request.path),
+                          data)
             return server.NOT_DONE_YET
         else:
-            data = request.content.read()
             # Detect resent message. We support that for
             # independently from the session, because it
             # might already be gone (server sends last reply
@@ -309,10 +347,7 @@ class SyncMLPost(resource.Resource):
                     OldRequest.data == data and \
                     OldRequest.reply:
                 logger.debug("resend reply session %s", sessionid)
-                request.setHeader('Content-Type', OldRequest.type)
-                request.setResponseCode(http.OK)
-                request.write(OldRequest.reply)
-                request.finish()
+                writeReply(request, OldRequest.reply, OldRequest.type)
                 return server.NOT_DONE_YET
             else:
                 # prepare resending, will be completed in
@@ -27,6 +27,7 @@ import signal
 import shutil
 import copy
 import heapq
+import glob
 import string
 import difflib
 import traceback
@@ -42,6 +43,8 @@ import traceback
 import re
 import atexit
 import base64
+import httplib
+import socket
 
 # introduced in python-gobject 2.16, not available
 # on all Linux distros => make it optional
@@ -1209,7 +1212,7 @@ class TestDBusServer(DBusUtil, unittest.TestCase):
         """TestDBusServer.testCapabilities - Server.Capabilities()"""
         capabilities = self.server.GetCapabilities()
         capabilities.sort()
-        self.assertEqual(capabilities, ['ConfigChanged', 'DatabaseProperties', 'GetConfigName', 'NamedConfig', 'Notifications', 'SessionAttach', 'SessionFlags', 'Version'])
+        self.assertEqual(capabilities, ['CacheStatistics', 'ConfigChanged', 'DatabaseProperties', 'GetConfigName', 'HTTPStatistics', 'NamedConfig', 'Notifications', 'SessionAttach', 'SessionFlags', 'Version'])
 
     def testVersions(self):
         """TestDBusServer.testVersions - Server.GetVersions()"""
@@ -1218,6 +1221,20 @@ class TestDBusServer(DBusUtil, unittest.TestCase):
         self.assertNotEqual(versions["system"], None)
         self.assertNotEqual(versions["backends"], None)
 
+    def testCacheStatistics(self):
+        """TestDBusServer.testCacheStatistics - Server.GetCacheStatistics()"""
+        self.server.GetConfigs(False, utf8_strings=True)
+        before = self.server.GetCacheStatistics(utf8_strings=True)
+        configs = self.server.GetConfigs(False, utf8_strings=True)
+        self.assertEqual(configs, [])
+        after = self.server.GetCacheStatistics(utf8_strings=True)
+        self.assertEqual(int(after["hits"]), int(before["hits"]) + 1)
+        self.assertEqual(after["misses"], before["misses"])
+
+    def testHTTPStatisticsDisabled(self):
+        """TestDBusServer.testHTTPStatisticsDisabled - Server.GetHTTPStatistics() without --http-port"""
+        self.assertEqual(self.server.GetHTTPStatistics(utf8_strings=True), {})
+
     def testGetConfigsEmpty(self):
         """TestDBusServer.testGetConfigsEmpty - Server.GetConfigsEmpty()"""
         configs = self.server.GetConfigs(False, utf8_strings=True)
@@ -2103,6 +2120,45 @@ class TestSessionAPIsDummy(DBusUtil, unittest.TestCase):
         self.assertEqual(config[""]["username"], "doe")
         self.assertEqual(config["source/addressbook"]["sync"], "slow")
 
+    def testUpdateConfigCached(self):
+        """TestSessionAPIsDummy.testUpdateConfigCached -  test that reading right after writing returns the new config and cached passwords. """
+        self.config[""]["password"] = "112233445566778"
+        self.setupConfig()
+        # fill the cache, then read from it; the cache does not store
+        # passwords, they must still be returned (inotify events for
+        # setupConfig() may flush the cache in between, so repeat)
+        for i in range(0, 3):
+            config = self.session.GetConfig(False, utf8_strings=True)
+            self.assertEqual(config, self.config)
+        # must not wait for inotify
+        self.session.SetConfig(True, False, self.updateConfig, utf8_strings=True)
+        config = self.session.GetConfig(False, utf8_strings=True)
+        self.assertEqual(config[""]["username"], "doe")
+        self.assertEqual(config[""]["password"], "112233445566778")
+
+    def testCacheInotify(self):
+        """TestSessionAPIsDummy.testCacheInotify -  test that only changes of config.ini files flush the config cache. """
+        self.setupConfig()
+        peer = xdg_root + "/config/syncevolution/default/peers/dummy-test"
+        # let pending events from writing the config arrive
+        time.sleep(1)
+        self.session.GetConfig(False, utf8_strings=True)
+        before = self.server.GetCacheStatistics(utf8_strings=True)
+        # written by every sync
+        with open(peer + "/.internal.ini", "a") as f:
+            f.write("# testCacheInotify\n")
+        time.sleep(1)
+        self.session.GetConfig(False, utf8_strings=True)
+        after = self.server.GetCacheStatistics(utf8_strings=True)
+        self.assertEqual(after["invalidations"], before["invalidations"])
+        # edited by the user or a command line
+        with open(peer + "/config.ini", "a") as f:
+            f.write("# testCacheInotify\n")
+        time.sleep(1)
+        self.session.GetConfig(False, utf8_strings=True)
+        after = self.server.GetCacheStatistics(utf8_strings=True)
+        self.assertEqual(int(after["invalidations"]), int(before["invalidations"]) + 1)
+
     def testUpdateConfigTemp(self):
         """TestSessionAPIsDummy.testUpdateConfigTemp -  test the config is just temporary updated but no effect in storage. """
         self.setupConfig()
@@ -3047,8 +3103,11 @@ class TestConnection(DBusUtil, unittest.TestCase):
     def setUp(self):
         self.setUpServer()
         self.setUpListeners(None)
-        # default config
-        self.config = { 
+        self.config = TestConnection.defaultConfig()
+
+    @staticmethod
+    def defaultConfig():
+        return { 
                          "" : { "remoteDeviceId" : "sc-api-nat",
                                 "password" : "test",
                                 "username" : "test",
@@ -3359,6 +3418,75 @@ class TestConnection(DBusUtil, unittest.TestCase):
         self.assertEqual(DBusUtil.quit_events, ["connection " + conpath + " aborted",
                                                     "session done"])
 
+class TestHTTPServer(DBusUtil, unittest.TestCase):
+    """Tests the built-in SyncML HTTP server of syncevo-dbus-server (--http-port)."""
+
+    def setUp(self):
+        self.setUpServer()
+        self.setUpListeners(None)
+        self.setUpSession("dummy-test")
+        self.session.SetConfig(False, False, TestConnection.defaultConfig(), utf8_strings=True)
+        self.session.Detach()
+        loop.run()
+        self.assertEqual(DBusUtil.quit_events, ["session done"])
+        DBusUtil.quit_events = []
+
+    def run(self, result):
+        # pick some free port
+        s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        s.bind(("127.0.0.1", 0))
+        self.port = s.getsockname()[1]
+        s.close()
+        self.runTest(result, own_xdg=True, serverArgs=["--http-port", str(self.port)])
+
+    def post(self, message):
+        """POST a message which starts a new session for the "dummy-test" config,
+        returns status, content type and body of the reply"""
+        conn = httplib.HTTPConnection("127.0.0.1", self.port)
+        conn.request("POST", "/dummy-test", message,
+                     { "Content-Type": "application/vnd.syncml+xml" })
+        response = conn.getresponse()
+        res = (response.status, response.getheader("Content-Type"), response.read())
+        conn.close()
+        return res
+
+    @timeout(60)
+    def testStatistics(self):
+        """TestHTTPServer.testStatistics - Server.GetHTTPStatistics() before and after a message"""
+        stats = self.server.GetHTTPStatistics(utf8_strings=True)
+        self.assertEqual(stats["port"], str(self.port))
+        self.assertEqual(stats["requests"], "0")
+        self.assertEqual(stats["latencyTotal"], "0")
+        self.assertEqual(stats["latencyMax"], "0")
+
+        # Credentials are checked and rejected (wrong nonce), as in
+        # TestConnection.testCredentialsWrong.
+        status, type, reply = self.post(TestConnection.message1)
+        self.assertEqual(status, 200)
+        self.assertEqual(type, "application/vnd.syncml+xml")
+        self.assertIn("<Chal>", reply)
+
+        stats = self.server.GetHTTPStatistics(utf8_strings=True)
+        self.assertEqual(stats["requests"], "1")
+        self.assertTrue(int(stats["latencyMax"]) <= int(stats["latencyTotal"]))
+        self.assertTrue(int(stats["sessions"]) <= 1)
+
+    @timeout(300)
+    def testLoad(self):
+        """TestHTTPServer.testLoad - send the same initial message repeatedly, measure messages/s"""
+        count = 20
+        start = time.time()
+        for i in range(0, count):
+            status, type, reply = self.post(TestConnection.message1)
+            self.assertEqual(status, 200)
+            self.assertIn("<Chal>", reply)
+        duration = time.time() - start
+        stats = self.server.GetHTTPStatistics(utf8_strings=True)
+        logging.printf("%d messages in %.1fs = %.1f messages/s, server side latency %sms average, %sms max",
+                       count, duration, count / duration,
+                       int(stats["latencyTotal"]) / count, stats["latencyMax"])
+        self.assertEqual(stats["requests"], str(count))
+
 class TestMultipleConfigs(unittest.TestCase, DBusUtil):
     """ sharing of properties between configs
 
@@ -3671,6 +3799,67 @@ END:VCARD''')
         input = open(xdg_root + "/server/0", "r")
         self.assertIn("FN:John Doe", input.read())
 
+    def getSessionLog(self):
+        """return content of the Synthesis session log of the "server" config"""
+        logs = glob.glob(xdg_root + "/cache/syncevolution/server-*/syncevolution-log.html")
+        self.assertEqual(1, len(logs))
+        return open(logs[0]).read()
+
+    @property("ENV", "SYNCEVOLUTION_LOG_FLUSH_MODE=async")
+    @timeout(100)
+    def testAsyncLogExit(self):
+        """TestLocalSync.testAsyncLogExit - async log flushing writes everything when the session ends"""
+        self.setUpConfigs()
+        self.setUpListeners(self.sessionpath)
+        self.session.Sync("slow", {})
+        loop.run()
+        self.assertEqual(DBusUtil.quit_events, ["session " + self.sessionpath + " done"])
+        self.checkSync()
+        log = self.getSessionLog()
+        self.assertIn("Created command 'Alert'", log)
+        self.assertTrue(log.rstrip().endswith("<h2>End of log</h2></html>"))
+
+    # The abort handler is only installed without SYNCEVOLUTION_DEBUG.
+    # SYNCEVOLUTION_LOCAL_CHILD_DELAY2 keeps the parent waiting for the
+    # reply to its first message, so its session log is open and has
+    # content when the signal arrives.
+    @property("debug", False)
+    @property("ENV", "SYNCEVOLUTION_LOG_FLUSH_MODE=async SYNCEVOLUTION_LOCAL_CHILD_DELAY2=60")
+    @timeout(100)
+    def testAsyncLogAbort(self):
+        """TestLocalSync.testAsyncLogAbort - async log flushing writes buffered lines when the helper aborts"""
+        self.setUpConfigs()
+        self.setUpListeners(self.sessionpath)
+        self.session.Sync("slow", {})
+
+        self.aborted = False
+        def output(path, level, text, procname):
+            if self.running and not self.aborted and procname == '@client':
+                for pid, (name, cmdline) in self.getChildren().iteritems():
+                    if 'syncevo-dbus-helper' in cmdline:
+                        logging.printf('aborting syncevo-dbus-helper with pid %d', pid)
+                        os.kill(pid, signal.SIGABRT)
+                        self.aborted = True
+                        break
+
+        receiver = bus.add_signal_receiver(output,
+                                           'LogOutput',
+                                           'org.syncevolution.Server',
+                                           self.server.bus_name,
+                                           byte_arrays=True,
+                                           utf8_strings=True)
+        try:
+            loop.run()
+        finally:
+            receiver.remove()
+        self.assertTrue(self.aborted)
+        self.assertEqual(DBusUtil.quit_events, ["session " + self.sessionpath + " done"])
+        # written by the background thread or the signal handler, but
+        # not closed normally
+        log = self.getSessionLog()
+        self.assertIn("Created command 'Alert'", log)
+        self.assertNotIn("End of log", log)
+
     def setUpInfoRequest(self, response={"password" : "123456"}):
         self.lastState = "unknown"
         def infoRequest(id, session, state, handler, type, params):
@@ -4726,6 +4915,7 @@ config.ini:deviceId = fixed-devid
 peers/scheduleworld/config.ini:# remoteDeviceId = 
 peers/scheduleworld/config.ini:# enableWBXML = 1
 peers/scheduleworld/config.ini:# enableRefreshSync = 0
+peers/scheduleworld/config.ini:# enableCompression = 0
 peers/scheduleworld/config.ini:# maxMsgSize = 150000
 peers/scheduleworld/config.ini:# maxObjSize = 4000000
 peers/scheduleworld/config.ini:# SSLServerCertificates = {4}
@@ -4932,6 +5122,7 @@ spds/syncml/config.txt:deviceId = fixed-devid
 spds/syncml/config.txt:# remoteDeviceId = 
 spds/syncml/config.txt:# enableWBXML = 1
 spds/syncml/config.txt:# enableRefreshSync = 0
+spds/syncml/config.txt:# enableCompression = 0
 spds/syncml/config.txt:# maxMsgSize = 150000
 spds/syncml/config.txt:# maxObjSize = 4000000
 spds/syncml/config.txt:# SSLServerCertificates = {0}
@@ -5932,6 +6123,8 @@ enableWBXML (TRUE, unshared)
 
 enableRefreshSync (FALSE, unshared)
 
+enableCompression (FALSE, unshared)
+
 maxMsgSize (150000, unshared), maxObjSize (4000000, unshared)
 
 SSLServerCertificates ({0}, unshared)